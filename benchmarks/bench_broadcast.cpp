@@ -0,0 +1,96 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../common/snapshot.hpp"
+#include <EASTL/vector.h>
+#include <cstdlib>
+#include <string>
+
+// Per-tick snapshot encoding cost of the two broadcast modes, for a full room
+// of players sent to a growing number of recipients. PER_CLIENT fills and
+// serializes one full WorldStateMessage per client (deltas and interest
+// filtering off, so both modes carry the same bytes); SHARED serializes once
+// and copies the bytes into one block per client, as AllocateBlock would.
+// Recipients past yojimbo::MaxClients stand for clients spread over rooms.
+
+struct BroadcastBenchWorld
+{
+    yojimbo::DefaultAllocator allocator;
+    GameMessageFactory factory;
+    SnapshotState state;
+    WorldStateMessage *message;
+    eastl::vector<uint8_t> buffer;
+
+    BroadcastBenchWorld()
+        : factory(allocator),
+          message(static_cast<WorldStateMessage *>(factory.CreateMessage((int)GameMessageType::WORLD_STATE))),
+          buffer((EstimateWorldStateBytes(MAX_PLAYER_CAPACITY) + 3) & ~3, 0)
+    {
+        srand(1234);
+        state.serverTick = 100;
+        for (int i = 0; i < MAX_PLAYER_CAPACITY; ++i)
+        {
+            int slot = state.players.Add(i);
+            state.players.x[slot] = POSITION_X_QUANTIZATION.Snap(static_cast<float>(rand() % WORLD_WIDTH));
+            state.players.y[slot] = POSITION_Y_QUANTIZATION.Snap(static_cast<float>(rand() % WORLD_HEIGHT));
+            state.players.velX[slot] = PLAYER_MOVE_SPEED;
+            state.players.size[slot] = SIZE_QUANTIZATION.Snap(10.0f + rand() % 200);
+            state.players.color[slot] = 0xFF0000FF;
+        }
+    }
+
+    ~BroadcastBenchWorld() { factory.ReleaseMessage(message); }
+
+    int EncodeSnapshot(uint32_t inputAck)
+    {
+        message->AllocatePlayers(state.players.Count());
+        WriteSnapshot(*message, state, nullptr);
+        message->lastProcessedInputSeq = inputAck;
+        message->quantized = true;
+        return WriteMessageBytes(*message, buffer.data(), static_cast<int>(buffer.size()));
+    }
+};
+
+static int BroadcastPerClient(BroadcastBenchWorld &world, int clients)
+{
+    int total = 0;
+    for (int client = 0; client < clients; ++client)
+    {
+        total += world.EncodeSnapshot(client);
+    }
+    return total;
+}
+
+static int BroadcastShared(BroadcastBenchWorld &world, int clients)
+{
+    int bytes = world.EncodeSnapshot(0);
+    int total = 0;
+    for (int client = 0; client < clients; ++client)
+    {
+        uint8_t *block = (uint8_t *)YOJIMBO_ALLOCATE(world.allocator, bytes);
+        memcpy(block, world.buffer.data(), bytes);
+        total += block[bytes - 1] + bytes;
+        YOJIMBO_FREE(world.allocator, block);
+    }
+    return total;
+}
+
+TEST_CASE("Snapshot broadcast by client count", "[benchmark][broadcast]")
+{
+    const int clientCounts[] = {16, 64, 256};
+
+    BroadcastBenchWorld world;
+    REQUIRE(world.EncodeSnapshot(0) > 0);
+
+    for (int clients : clientCounts)
+    {
+        BENCHMARK("per-client serialize, " + std::to_string(clients) + " clients")
+        {
+            return BroadcastPerClient(world, clients);
+        };
+
+        BENCHMARK("shared serialize + copy, " + std::to_string(clients) + " clients")
+        {
+            return BroadcastShared(world, clients);
+        };
+    }
+}
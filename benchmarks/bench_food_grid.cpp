@@ -0,0 +1,122 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../server/spatial_grid.hpp"
+#include <EASTL/vector.h>
+#include <cstdlib>
+#include <string>
+
+// Brute-force scan (the old HandleGameFood) vs. grid query over the same food
+// layout. The grid cost follows the number of cells under each player, the
+// brute-force cost follows total food, so the crossover moves with both food
+// density and player size; each case sweeps one of them.
+
+static const int BENCH_PLAYERS = 16;
+static const float FOOD_SIZE = 5.0f;
+
+struct FoodBenchWorld
+{
+    eastl::vector<Position> food;
+    eastl::vector<Position> players;
+    eastl::vector<float> playerSizes;
+    SpatialGrid grid;
+
+    FoodBenchWorld(int foodCount, float playerSize)
+        : grid(static_cast<float>(WORLD_WIDTH), static_cast<float>(WORLD_HEIGHT), SPATIAL_CELL_SIZE, foodCount)
+    {
+        srand(1234);
+        for (int i = 0; i < foodCount; ++i)
+        {
+            Position position(rand() % WORLD_WIDTH, rand() % WORLD_HEIGHT);
+            food.push_back(position);
+            grid.Insert(i, position.x, position.y);
+        }
+        for (int i = 0; i < BENCH_PLAYERS; ++i)
+        {
+            players.push_back(Position(rand() % WORLD_WIDTH, rand() % WORLD_HEIGHT));
+            playerSizes.push_back(playerSize > 0.0f ? playerSize : 10.0f + static_cast<float>(rand() % 90));
+        }
+    }
+};
+
+static int CountEatenBruteForce(const FoodBenchWorld& world)
+{
+    int eaten = 0;
+    for (int p = 0; p < BENCH_PLAYERS; ++p)
+    {
+        float radius = world.playerSizes[p] / 2.0f + FOOD_SIZE / 2.0f;
+        float radiusSquared = radius * radius;
+        for (const Position& food : world.food)
+        {
+            if (food.distanceSquared(world.players[p]) < radiusSquared)
+                eaten++;
+        }
+    }
+    return eaten;
+}
+
+static int CountEatenGrid(const FoodBenchWorld& world, eastl::vector<uint32_t>& candidates)
+{
+    int eaten = 0;
+    for (int p = 0; p < BENCH_PLAYERS; ++p)
+    {
+        float radius = world.playerSizes[p] / 2.0f + FOOD_SIZE / 2.0f;
+        float radiusSquared = radius * radius;
+
+        candidates.clear();
+        world.grid.QueryRadius(world.players[p].x, world.players[p].y, radius, candidates);
+        for (uint32_t j : candidates)
+        {
+            if (world.food[j].distanceSquared(world.players[p]) < radiusSquared)
+                eaten++;
+        }
+    }
+    return eaten;
+}
+
+TEST_CASE("Food collision broad-phase by food count", "[benchmark][food]")
+{
+    const int foodCounts[] = {32, 128, 512, 2048, 8192, 32768};
+
+    for (int foodCount : foodCounts)
+    {
+        FoodBenchWorld world(foodCount, 0.0f);
+        eastl::vector<uint32_t> candidates;
+        candidates.reserve(foodCount);
+
+        REQUIRE(CountEatenBruteForce(world) == CountEatenGrid(world, candidates));
+
+        BENCHMARK("brute force, " + std::to_string(foodCount) + " food")
+        {
+            return CountEatenBruteForce(world);
+        };
+
+        BENCHMARK("grid, " + std::to_string(foodCount) + " food")
+        {
+            return CountEatenGrid(world, candidates);
+        };
+    }
+}
+
+TEST_CASE("Food collision broad-phase by player size", "[benchmark][food]")
+{
+    const float playerSizes[] = {20.0f, 200.0f, 800.0f, 2400.0f, 6400.0f};
+
+    for (float playerSize : playerSizes)
+    {
+        FoodBenchWorld world(MAX_FOOD, playerSize);
+        eastl::vector<uint32_t> candidates;
+        candidates.reserve(MAX_FOOD);
+
+        REQUIRE(CountEatenBruteForce(world) == CountEatenGrid(world, candidates));
+
+        BENCHMARK("brute force, size " + std::to_string(static_cast<int>(playerSize)))
+        {
+            return CountEatenBruteForce(world);
+        };
+
+        BENCHMARK("grid, size " + std::to_string(static_cast<int>(playerSize)))
+        {
+            return CountEatenGrid(world, candidates);
+        };
+    }
+}
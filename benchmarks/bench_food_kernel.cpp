@@ -0,0 +1,129 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../server/food_kernel.hpp"
+#include "../server/spatial_grid.hpp"
+#include <EASTL/vector.h>
+#include <cstdlib>
+#include <string>
+
+// Vectorised food-overlap kernels vs. the scalar FoodItem loop HandleGameFood
+// used to run, plus the kernel vs. grid comparison behind FOOD_KERNEL_MIN_CELLS.
+
+struct FoodKernelBenchWorld
+{
+    eastl::vector<FoodItem> items;
+    eastl::vector<float> x;
+    eastl::vector<float> y;
+    eastl::vector<uint64_t> mask;
+
+    explicit FoodKernelBenchWorld(int foodCount)
+        : mask(FoodMaskWords(foodCount), 0)
+    {
+        srand(4321);
+        for (int i = 0; i < foodCount; ++i)
+        {
+            FoodItem item = CreateFoodItemFromTier(static_cast<float>(rand() % WORLD_WIDTH),
+                                                   static_cast<float>(rand() % WORLD_HEIGHT), FoodTier::SMALL);
+            items.push_back(item);
+            x.push_back(item.position.x);
+            y.push_back(item.position.y);
+        }
+    }
+};
+
+static int CountEatenItemLoop(const FoodKernelBenchWorld& world, Position player, float radiusSquared)
+{
+    int eaten = 0;
+    for (const FoodItem& item : world.items)
+    {
+        if (item.position.distanceSquared(player) < radiusSquared)
+            eaten++;
+    }
+    return eaten;
+}
+
+TEST_CASE("Food overlap kernels", "[benchmark][kernel]")
+{
+    const int foodCounts[] = {128, 4096, 65536};
+    const Position player(1600.0f, 1200.0f);
+    const float radiusSquared = 200.0f * 200.0f;
+
+    INFO("Dispatched kernel: " << GetFoodOverlapKernelName());
+
+    for (int foodCount : foodCounts)
+    {
+        FoodKernelBenchWorld world(foodCount);
+        std::string suffix = ", " + std::to_string(foodCount) + " food";
+
+        REQUIRE(CountEatenItemLoop(world, player, radiusSquared) ==
+                FindFoodOverlaps(world.x.data(), world.y.data(), foodCount, player.x, player.y, radiusSquared, world.mask.data()));
+
+        BENCHMARK("FoodItem loop" + suffix)
+        {
+            return CountEatenItemLoop(world, player, radiusSquared);
+        };
+
+        BENCHMARK("scalar kernel" + suffix)
+        {
+            return FindFoodOverlapsScalar(world.x.data(), world.y.data(), foodCount, player.x, player.y, radiusSquared, world.mask.data());
+        };
+
+#ifdef CIRC_FOOD_KERNEL_X86
+        BENCHMARK("sse kernel" + suffix)
+        {
+            return FindFoodOverlapsSSE(world.x.data(), world.y.data(), foodCount, player.x, player.y, radiusSquared, world.mask.data());
+        };
+
+        if (__builtin_cpu_supports("avx2"))
+        {
+            BENCHMARK("avx2 kernel" + suffix)
+            {
+                return FindFoodOverlapsAVX2(world.x.data(), world.y.data(), foodCount, player.x, player.y, radiusSquared, world.mask.data());
+            };
+        }
+#endif
+    }
+}
+
+TEST_CASE("Food overlap kernel vs. grid", "[benchmark][kernel]")
+{
+    // Collision radii from a single grid cell up to a 9x9 block of cells
+    const float radii[] = {20.0f, 80.0f, 180.0f, 280.0f, 380.0f};
+    const Position player(1650.0f, 1250.0f);
+
+    FoodKernelBenchWorld world(MAX_FOOD);
+    SpatialGrid grid(static_cast<float>(WORLD_WIDTH), static_cast<float>(WORLD_HEIGHT), SPATIAL_CELL_SIZE, MAX_FOOD);
+    for (int i = 0; i < MAX_FOOD; ++i)
+    {
+        grid.Insert(i, world.x[i], world.y[i]);
+    }
+
+    eastl::vector<uint32_t> candidates;
+    candidates.reserve(MAX_FOOD);
+
+    for (float radius : radii)
+    {
+        float radiusSquared = radius * radius;
+        int cells = grid.CountCellsInRect(player.x - radius, player.y - radius, player.x + radius, player.y + radius);
+        std::string suffix = ", " + std::to_string(cells) + " cells";
+
+        BENCHMARK("kernel" + suffix)
+        {
+            return FindFoodOverlaps(world.x.data(), world.y.data(), MAX_FOOD, player.x, player.y, radiusSquared, world.mask.data());
+        };
+
+        BENCHMARK("grid" + suffix)
+        {
+            candidates.clear();
+            grid.QueryRadius(player.x, player.y, radius, candidates);
+
+            int eaten = 0;
+            for (uint32_t j : candidates)
+            {
+                if (Position(world.x[j], world.y[j]).distanceSquared(player) < radiusSquared)
+                    eaten++;
+            }
+            return eaten;
+        };
+    }
+}
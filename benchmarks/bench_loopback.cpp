@@ -0,0 +1,88 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../common/loopback.hpp"
+#include "../server/game_server.hpp"
+#include "loopback_server.hpp"
+#include <yojimbo.h>
+#include <EASTL/vector.h>
+#include <memory>
+#include <string>
+
+// Whole server ticks with yojimbo clients attached over LoopbackNetwork: the
+// full receive/simulate/broadcast/send path, with no sockets and no waiting on
+// the wall clock. The clients only drain what they receive and send acks.
+
+struct LoopbackBenchClient
+{
+    ClientAdapter adapter;
+    GameConnectionConfig config;
+    yojimbo::Client client;
+
+    LoopbackBenchClient(LoopbackNetwork &network, uint64_t clientId)
+        : adapter(),
+          config(MAX_PLAYER_CAPACITY),
+          client(yojimbo::GetDefaultAllocator(), yojimbo::Address("0.0.0.0"), config, adapter, 0.0)
+    {
+        adapter.SetLoopback(&network);
+        network.Connect(client, clientId);
+    }
+
+    void Update(float dt)
+    {
+        client.AdvanceTime(client.GetTime() + dt);
+        client.ReceivePackets();
+        for (int channel = 0; channel < (int)GameChannel::COUNT; ++channel)
+        {
+            yojimbo::Message *message;
+            while ((message = client.ReceiveMessage(channel)) != nullptr)
+                client.ReleaseMessage(message);
+        }
+        client.SendPackets();
+    }
+};
+
+struct LoopbackBenchWorld
+{
+    LoopbackNetwork network;
+    LoopbackServer server;
+    eastl::vector<std::unique_ptr<LoopbackBenchClient>> clients;
+
+    explicit LoopbackBenchWorld(int numClients)
+        : network(),
+          server(network, numClients)
+    {
+        for (int i = 0; i < numClients; ++i)
+            clients.push_back(std::make_unique<LoopbackBenchClient>(network, i + 1));
+    }
+
+    ~LoopbackBenchWorld()
+    {
+        for (auto &client : clients)
+            network.Disconnect(client->client);
+    }
+
+    int Tick()
+    {
+        PumpLoopback(network, server, clients);
+        return network.GetPacketsInFlight();
+    }
+};
+
+TEST_CASE("Server tick over loopback by client count", "[benchmark][loopback]")
+{
+    REQUIRE(InitializeYojimbo());
+
+    const int clientCounts[] = {1, 16, MAX_PLAYER_CAPACITY};
+    for (int clients : clientCounts)
+    {
+        LoopbackBenchWorld world(clients);
+        REQUIRE(world.server.GetConnectedClientCount() == clients);
+
+        BENCHMARK("server tick, " + std::to_string(clients) + " loopback clients")
+        {
+            return world.Tick();
+        };
+    }
+
+    ShutdownYojimbo();
+}
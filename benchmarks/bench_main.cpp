@@ -0,0 +1,6 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+// This file provides the main() function for the Catch2 benchmark runner
+// CATCH_CONFIG_ENABLE_BENCHMARKING is set for every file by CMakeLists.txt
+// All other benchmark files should NOT define CATCH_CONFIG_MAIN
@@ -0,0 +1,107 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../common/snapshot.hpp"
+#include "../server/interest.hpp"
+#include "../server/priority.hpp"
+#include "../server/job_pool.hpp"
+#include "../server/spatial_grid.hpp"
+#include <EASTL/algorithm.h>
+#include <EASTL/vector.h>
+#include <cstdlib>
+#include <string>
+
+// Scaling of the PER_CLIENT snapshot build over JobPool workers: for every
+// client of a full room, interest filtering, priority trimming to the byte
+// budget, filling its WorldStateMessage and bit-packing it, as
+// GameServer::BuildSnapshot does plus the serialization SendPackets would do.
+// Worker counts run from 1 up to the machine's hardware threads; compare each
+// line against the 1 worker one for the speedup.
+
+struct SnapshotJobBenchWorld
+{
+    yojimbo::DefaultAllocator allocator;
+    GameMessageFactory factory;
+    WorldState world;
+    SpatialGrid playerGrid;
+    float maxPlayerRadius;
+    eastl::vector<SnapshotState> states;
+    eastl::vector<WorldStateMessage *> messages;
+    eastl::vector<eastl::vector<uint8_t>> buffers;
+
+    SnapshotJobBenchWorld()
+        : factory(allocator),
+          playerGrid(static_cast<float>(WORLD_WIDTH), static_cast<float>(WORLD_HEIGHT), SPATIAL_CELL_SIZE,
+                     MAX_PLAYER_CAPACITY),
+          maxPlayerRadius(0.0f),
+          states(MAX_PLAYER_CAPACITY),
+          messages(),
+          buffers(MAX_PLAYER_CAPACITY)
+    {
+        srand(1234);
+        world.serverTick = 100;
+        for (int i = 0; i < MAX_PLAYER_CAPACITY; ++i)
+        {
+            PlayerTable &players = world.players;
+            int slot = players.Add(i);
+            players.x[slot] = POSITION_X_QUANTIZATION.Snap(static_cast<float>(rand() % WORLD_WIDTH));
+            players.y[slot] = POSITION_Y_QUANTIZATION.Snap(static_cast<float>(rand() % WORLD_HEIGHT));
+            players.velX[slot] = PLAYER_MOVE_SPEED;
+            players.size[slot] = SIZE_QUANTIZATION.Snap(10.0f + rand() % 200);
+            players.color[slot] = 0xFF0000FF;
+            playerGrid.Insert(slot, players.x[slot], players.y[slot]);
+            maxPlayerRadius = eastl::max(maxPlayerRadius, players.size[slot] / 2.0f);
+
+            // Sized up front, as GameServer does on the tick thread: the factory is not thread-safe
+            messages.push_back(static_cast<WorldStateMessage *>(factory.CreateMessage((int)GameMessageType::WORLD_STATE)));
+            messages.back()->AllocatePlayers(MAX_PLAYER_CAPACITY);
+            buffers[i].resize((EstimateWorldStateBytes(MAX_PLAYER_CAPACITY) + 3) & ~3, 0);
+        }
+    }
+
+    ~SnapshotJobBenchWorld()
+    {
+        for (WorldStateMessage *message : messages)
+            factory.ReleaseMessage(message);
+    }
+
+    int BuildSnapshot(int client, InterestFilter &interest, PriorityAccumulator &priority, int worker)
+    {
+        SnapshotState &state = states[client];
+        interest.Build(client, world, playerGrid, maxPlayerRadius, state, MAX_PLAYER_CAPACITY, worker);
+        priority.Apply(client, state, nullptr, true, SNAPSHOT_BYTE_BUDGET, 1.0f / DEFAULT_SNAPSHOT_RATE, worker);
+
+        WorldStateMessage &message = *messages[client];
+        message.SetPlayerCount(state.players.Count());
+        WriteSnapshot(message, state, nullptr);
+        message.quantized = true;
+        return WriteMessageBytes(message, buffers[client].data(), static_cast<int>(buffers[client].size()));
+    }
+};
+
+TEST_CASE("Per-client snapshot build by worker count", "[benchmark][snapshotjobs]")
+{
+    SnapshotJobBenchWorld world;
+
+    eastl::vector<int> workerCounts;
+    const int hardwareThreads = JobPool::ResolveWorkerCount(0);
+    for (int workers = 1; workers < hardwareThreads; workers *= 2)
+        workerCounts.push_back(workers);
+    workerCounts.push_back(hardwareThreads);
+
+    for (int workers : workerCounts)
+    {
+        JobPool pool(workers);
+        InterestFilter interest(MAX_PLAYER_CAPACITY, workers);
+        PriorityAccumulator priority(MAX_PLAYER_CAPACITY, workers);
+        eastl::vector<int> bytes(MAX_PLAYER_CAPACITY, 0);
+        REQUIRE(world.BuildSnapshot(0, interest, priority, 0) > 0);
+
+        BENCHMARK(std::to_string(MAX_PLAYER_CAPACITY) + " clients, " + std::to_string(workers) + " workers")
+        {
+            pool.ParallelFor(MAX_PLAYER_CAPACITY, [&](int client, int worker) {
+                bytes[client] = world.BuildSnapshot(client, interest, priority, worker);
+            });
+            return bytes[MAX_PLAYER_CAPACITY - 1];
+        };
+    }
+}
@@ -0,0 +1,120 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../server/game_server.hpp"
+#include <yojimbo.h>
+#include <EASTL/vector.h>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#if CIRC_TICK_PROFILER
+
+// Tick jitter of GameServer::Run on each socket transport, with real UDP
+// clients on this machine. TICK_LATENESS is how far past its slot each tick
+// starts, so it is what a transport's receive and send work costs the tick
+// schedule. Runs on the wall clock for JITTER_SECONDS per transport; only
+// compare numbers taken on the same machine.
+
+static const int JITTER_CLIENTS = 32;
+static const double JITTER_SECONDS = 10.0;
+static const uint16_t JITTER_BASE_PORT = 40100;
+
+struct UdpBenchClient
+{
+    ClientAdapter adapter;
+    GameConnectionConfig config;
+    yojimbo::Client client;
+
+    UdpBenchClient(const yojimbo::Address &serverAddress, uint64_t clientId, double time)
+        : adapter(),
+          config(MAX_PLAYER_CAPACITY),
+          client(yojimbo::GetDefaultAllocator(), yojimbo::Address("0.0.0.0"), config, adapter, time)
+    {
+        client.InsecureConnect(DEFAULT_PRIVATE_KEY, clientId, serverAddress);
+    }
+
+    ~UdpBenchClient() { client.Disconnect(); }
+
+    void Update(double time)
+    {
+        client.AdvanceTime(time);
+        client.ReceivePackets();
+        for (int channel = 0; channel < (int)GameChannel::COUNT; ++channel)
+        {
+            yojimbo::Message *message;
+            while ((message = client.ReceiveMessage(channel)) != nullptr)
+                client.ReleaseMessage(message);
+        }
+        client.SendPackets();
+    }
+};
+
+TEST_CASE("Tick lateness by transport", "[benchmark][jitter]")
+{
+    REQUIRE(InitializeYojimbo());
+
+    struct TransportCase
+    {
+        ServerTransport transport;
+        const char *name;
+    };
+    const TransportCase cases[] = {
+        {ServerTransport::SOCKET, "socket"},
+#if CIRC_BATCHED_TRANSPORT
+        {ServerTransport::BATCHED, "batched"},
+        {ServerTransport::THREADED, "threaded"},
+#endif
+    };
+
+    std::cout << "Tick lateness, " << JITTER_CLIENTS << " UDP clients, " << JITTER_SECONDS
+              << " s per transport (microseconds):" << std::endl;
+    std::cout << "  " << std::left << std::setw(10) << "transport" << std::right << std::setw(8) << "ticks"
+              << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(10)
+              << "max" << std::endl;
+
+    uint16_t port = JITTER_BASE_PORT;
+    for (const TransportCase &transportCase : cases)
+    {
+        const yojimbo::Address address("127.0.0.1", port++);
+        GameServer server(address, JITTER_CLIENTS, InputQueueConfig(), transportCase.transport);
+        server.GetProfiler().SetDumpInterval(0.0);
+        std::thread serverThread([&server]() {
+            server.Run();
+        });
+
+        int connected = 0;
+        {
+            eastl::vector<std::unique_ptr<UdpBenchClient>> clients;
+            for (int i = 0; i < JITTER_CLIENTS; ++i)
+                clients.push_back(std::make_unique<UdpBenchClient>(address, i + 1, yojimbo_time()));
+
+            const double end = yojimbo_time() + JITTER_SECONDS;
+            while (yojimbo_time() < end)
+            {
+                const double now = yojimbo_time();
+                for (auto &client : clients)
+                    client->Update(now);
+                yojimbo_sleep(1.0 / TICK_RATE);
+            }
+            for (auto &client : clients)
+                connected += client->client.IsConnected() ? 1 : 0;
+        }
+        server.RequestStop();
+        serverThread.join();
+
+        const LatencyHistogram &lateness = server.GetProfiler().GetHistogram(TickPhase::TICK_LATENESS);
+        std::cout << "  " << std::left << std::setw(10) << transportCase.name << std::right << std::setw(8)
+                  << lateness.GetCount() << std::fixed << std::setprecision(1) << std::setw(10)
+                  << lateness.GetPercentile(50.0) / 1000.0 << std::setw(10) << lateness.GetPercentile(99.0) / 1000.0
+                  << std::setw(10) << lateness.GetPercentile(99.9) / 1000.0 << std::setw(10)
+                  << lateness.GetMax() / 1000.0 << std::defaultfloat << std::endl;
+
+        CHECK(connected == JITTER_CLIENTS);
+        REQUIRE(lateness.GetCount() > 0);
+    }
+
+    ShutdownYojimbo();
+}
+
+#endif
@@ -2,20 +2,40 @@
 #include "game_client.hpp"
 #include <cmath>
 
-GameClient::GameClient(const yojimbo::Address &address)
+GameClient::GameClient()
     : m_localPlayer(),
       m_predictedPlayer(),
       m_isLocalPlayerCreated(false),
       m_otherPlayers(),
-      m_foodItems(),
+      m_food(),
       m_camera(),
       m_inputSequence(0),
       m_inputHistory(),
+      m_inputBatchSize(DEFAULT_INPUT_BATCH),
+      m_scriptedInput(false),
+      m_scriptedMoveX(0.0f),
+      m_scriptedMoveY(0.0f),
       m_clientTime(0.0),
       m_snapshotBuffer(),
       m_interpolationTime(0.0),
+      m_serverClock(),
+      m_snapshotSpacing(),
+      m_receivedSnapshots(),
+      m_lastSnapshotTick(0),
+      m_quantizedSnapshots(false),
       m_adapter(),
-      m_client(yojimbo::GetDefaultAllocator(), yojimbo::Address("0.0.0.0"), m_connectionConfig, m_adapter, 0.0)
+      m_connectionConfig(MAX_PLAYER_CAPACITY),
+      m_client(yojimbo::GetDefaultAllocator(), yojimbo::Address("0.0.0.0"), m_connectionConfig, m_adapter, 0.0),
+      m_loopback(nullptr)
+{
+    m_camera.target = {WORLD_WIDTH / 2.0f, WORLD_HEIGHT / 2.0f};
+    m_camera.offset = {VIEW_WIDTH / 2.0f, VIEW_HEIGHT / 2.0f}; 
+    m_camera.rotation = 0.0f;
+    m_camera.zoom = 1.0f;
+}
+
+GameClient::GameClient(const yojimbo::Address &address)
+    : GameClient()
 {
     uint64_t clientId;
     yojimbo_random_bytes((uint8_t *)&clientId, 8);
@@ -25,16 +45,28 @@ GameClient::GameClient(const yojimbo::Address &address)
     std::cout << "Connecting to server at " << buffer << "..." << std::endl;
 
     m_client.InsecureConnect(DEFAULT_PRIVATE_KEY, clientId, address);
+}
 
-    m_camera.target = {WORLD_WIDTH / 2.0f, WORLD_HEIGHT / 2.0f};
-    m_camera.offset = {1280 / 2.0f, 720 / 2.0f}; 
-    m_camera.rotation = 0.0f;
-    m_camera.zoom = 1.0f;
+GameClient::GameClient(LoopbackNetwork &network)
+    : GameClient()
+{
+    uint64_t clientId;
+    yojimbo_random_bytes((uint8_t *)&clientId, 8);
+
+    m_loopback = &network;
+    m_adapter.SetLoopback(&network);
+    if (network.Connect(m_client, clientId) < 0)
+    {
+        std::cerr << "Loopback server is full or not attached" << std::endl;
+    }
 }
 
 GameClient::~GameClient()
 {
-    m_client.Disconnect();
+    if (m_loopback)
+        m_loopback->Disconnect(m_client);
+    else
+        m_client.Disconnect();
 
     if (IsWindowReady())
     {
@@ -44,7 +76,7 @@ GameClient::~GameClient()
 
 void GameClient::ProcessServerMessages()
 {
-    for (int i = 0; i < (int)GameMessageType::COUNT; ++i)
+    for (int i = 0; i < (int)GameChannel::COUNT; ++i)
     {
         yojimbo::Message *message = m_client.ReceiveMessage(i);
         while (message != NULL)
@@ -56,6 +88,26 @@ void GameClient::ProcessServerMessages()
                 ReceiveWorldState(static_cast<WorldStateMessage *>(message));
                 break;
             }
+            case (int)GameMessageType::SHARED_SNAPSHOT:
+            {
+                ReceiveSharedSnapshot(static_cast<SharedSnapshotMessage *>(message));
+                break;
+            }
+            case (int)GameMessageType::FOOD_SYNC:
+            {
+                ReceiveFoodSync(static_cast<FoodSyncMessage *>(message));
+                break;
+            }
+            case (int)GameMessageType::FOOD_SPAWNED:
+            {
+                ReceiveFoodSpawned(static_cast<FoodSpawnedMessage *>(message));
+                break;
+            }
+            case (int)GameMessageType::FOOD_EATEN:
+            {
+                ReceiveFoodEaten(static_cast<FoodEatenMessage *>(message));
+                break;
+            }
             default:
                 std::cout << "Unknown message type from server" << std::endl;
                 break;
@@ -75,20 +127,13 @@ void GameClient::Update(float dt)
     if(m_client.IsConnected()) {
         ProcessServerMessages();
 
-        if (IsWindowReady())
+        if (IsWindowReady() || m_scriptedInput)
         {
             SendInput();
         }
 
-        if (!m_snapshotBuffer.empty())
-        {
-            const Snapshot& latestSnapshot = m_snapshotBuffer.back();
-            m_otherPlayers.clear();
-            for (const auto& [id, player] : latestSnapshot.players)
-            {
-                m_otherPlayers[id] = player;
-            }
-        }
+        // Snapshots arrive at the server's snapshot rate, not every frame
+        InterpolatePlayerStates(dt);
 
         if (IsWindowReady())
         {
@@ -101,24 +146,42 @@ void GameClient::Update(float dt)
     m_client.SendPackets();
 }
 
+void GameClient::SetScriptedInput(float moveX, float moveY)
+{
+    m_scriptedInput = true;
+    m_scriptedMoveX = moveX;
+    m_scriptedMoveY = moveY;
+}
+
 void GameClient::ReceiveWorldState(WorldStateMessage *message)
 {
+    // Unordered channel: anything at or before the newest decoded snapshot is stale
+    if (message->serverTick <= m_lastSnapshotTick)
+        return;
+
+    const SnapshotState *baseline = m_receivedSnapshots.Find(message->baselineTick);
+    SnapshotState &state = m_receivedSnapshots.Insert(message->serverTick);
+    if (!ReadSnapshot(*message, baseline, state))
+    {
+        // The baseline is gone; skip this one and keep acking the last good tick
+        state.serverTick = 0;
+        return;
+    }
+    m_lastSnapshotTick = state.serverTick;
+    m_quantizedSnapshots = message->quantized;
+    m_serverClock.AddSample(state.timestamp, m_clientTime);
+    m_snapshotSpacing.AddSnapshot(state.serverTick);
+    SendSnapshotAck(state.serverTick);
+
     Snapshot snapshot;
-    snapshot.serverTick = message->serverTick;
-    snapshot.timestamp = message->timestamp;
+    snapshot.serverTick = state.serverTick;
+    snapshot.timestamp = state.timestamp;
 
-    for (int i = 0; i < message->numPlayers; ++i)
+    for (int slot = 0; slot < state.players.Count(); ++slot)
     {
-        Player player;
-        player.id = message->playerIds[i];
-        player.position.x = message->playerX[i];
-        player.position.y = message->playerY[i];
-        player.velocity.x = message->playerVelX[i];
-        player.velocity.y = message->playerVelY[i];
-        player.size = message->playerSize[i];
-        player.color = message->playerColor[i];
-
-        if (message->playerIds[i] == m_client.GetClientIndex())
+        Player player = state.players.Get(slot);
+
+        if (player.id == static_cast<uint32_t>(m_client.GetClientIndex()))
         {
             if (!m_isLocalPlayerCreated)
             {
@@ -144,16 +207,49 @@ void GameClient::ReceiveWorldState(WorldStateMessage *message)
     {
         m_snapshotBuffer.pop_front();
     }
+}
+
+void GameClient::ReceiveSharedSnapshot(SharedSnapshotMessage *message)
+{
+    WorldStateMessage *body = (WorldStateMessage *)m_client.CreateMessage((int)GameMessageType::WORLD_STATE);
+    if (!body)
+        return;
+
+    if (ReadSharedSnapshot(*message, *body))
+    {
+        ReceiveWorldState(body);
+    }
+    m_client.ReleaseMessage(body);
+}
 
-    m_foodItems.clear();
+void GameClient::ReceiveFoodSync(FoodSyncMessage *message)
+{
+    m_food.Clear();
     for (int i = 0; i < message->numFoodItems; ++i)
     {
-        float x = message->foodX[i];
-        float y = message->foodY[i];
         FoodTier tier = static_cast<FoodTier>(message->foodTier[i]);
+        m_food.Spawn(i, CreateFoodItemFromTier(message->foodX[i], message->foodY[i], tier));
+    }
+}
 
-        FoodItem food = CreateFoodItemFromTier(x, y, tier);
-        m_foodItems.push_back(food);
+void GameClient::ReceiveFoodSpawned(FoodSpawnedMessage *message)
+{
+    FoodTier tier = static_cast<FoodTier>(message->tier);
+    m_food.Spawn(message->foodId, CreateFoodItemFromTier(message->x, message->y, tier));
+}
+
+void GameClient::ReceiveFoodEaten(FoodEatenMessage *message)
+{
+    m_food.Remove(message->foodId);
+}
+
+void GameClient::SendSnapshotAck(uint32_t serverTick)
+{
+    SnapshotAckMessage *ackMessage = (SnapshotAckMessage *)m_client.CreateMessage((int)GameMessageType::SNAPSHOT_ACK);
+    if (ackMessage)
+    {
+        ackMessage->serverTick = serverTick;
+        m_client.SendMessage((int)GameChannel::UNRELIABLE, ackMessage);
     }
 }
 
@@ -164,10 +260,18 @@ void GameClient::SendInput()
 
     float moveX = 0.0f;
     float moveY = 0.0f;
-    if (IsKeyDown(KEY_W)) moveY -= 1.0f;
-    if (IsKeyDown(KEY_S)) moveY += 1.0f;
-    if (IsKeyDown(KEY_A)) moveX -= 1.0f;
-    if (IsKeyDown(KEY_D)) moveX += 1.0f;
+    if (m_scriptedInput)
+    {
+        moveX = m_scriptedMoveX;
+        moveY = m_scriptedMoveY;
+    }
+    else
+    {
+        if (IsKeyDown(KEY_W)) moveY -= 1.0f;
+        if (IsKeyDown(KEY_S)) moveY += 1.0f;
+        if (IsKeyDown(KEY_A)) moveX -= 1.0f;
+        if (IsKeyDown(KEY_D)) moveX += 1.0f;
+    }
 
     bool hasInput = (moveX != 0.0f || moveY != 0.0f);
 
@@ -175,6 +279,10 @@ void GameClient::SendInput()
     {
         m_inputSequence++;
 
+        // Snapped to the wire precision so the server replays exactly this input
+        moveX = MOVE_AXIS_QUANTIZATION.Snap(moveX);
+        moveY = MOVE_AXIS_QUANTIZATION.Snap(moveY);
+
         StoredInput storedInput(m_inputSequence, m_clientTime, moveX, moveY);
         m_inputHistory.push_back(storedInput);
 
@@ -183,45 +291,26 @@ void GameClient::SendInput()
             m_inputHistory.pop_front();
         }
 
-        const float dt = 1.0f / 60.0f;
-        PredictMovement(m_predictedPlayer, moveX, moveY, dt);
+        PredictMovement(m_predictedPlayer, moveX, moveY, INPUT_STEP_DT);
 
-        PlayerInputMessage *inputMessage = (PlayerInputMessage *)m_client.CreateMessage((int)GameMessageType::PLAYER_INPUT);
-        if (inputMessage)
+        // Resend the newest inputs with every packet; the server drops what it already has
+        PlayerInputBatchMessage *batchMessage = (PlayerInputBatchMessage *)m_client.CreateMessage((int)GameMessageType::PLAYER_INPUT_BATCH);
+        if (batchMessage)
         {
-            inputMessage->sequenceNumber = m_inputSequence;
-            inputMessage->timestamp = m_clientTime;
-            inputMessage->moveX = moveX;
-            inputMessage->moveY = moveY;
-            m_client.SendMessage((int)GameChannel::UNRELIABLE, inputMessage);
+            FillInputBatch(*batchMessage, m_inputHistory, m_inputBatchSize);
+            m_client.SendMessage((int)GameChannel::UNRELIABLE, batchMessage);
         }
         else
         {
-            std::cerr << "ERROR: Failed to create PlayerInputMessage - message allocator may be out of memory" << std::endl;
+            std::cerr << "ERROR: Failed to create PlayerInputBatchMessage - message allocator may be out of memory" << std::endl;
         }
     }
 }
 
 void GameClient::PredictMovement(Player& player, float moveX, float moveY, float dt)
 {
-    float length = std::sqrt(moveX * moveX + moveY * moveY);
-    if (length > 0.0f)
-    {
-        moveX /= length;
-        moveY /= length;
-    }
-
-    const float moveSpeed = 200.0f;
-    player.velocity.x = moveX * moveSpeed;
-    player.velocity.y = moveY * moveSpeed;
-
-    player.position.x += player.velocity.x * dt;
-    player.position.y += player.velocity.y * dt;
-
-    if (player.position.x < 0.0f) player.position.x = 0.0f;
-    if (player.position.x > WORLD_WIDTH) player.position.x = WORLD_WIDTH;
-    if (player.position.y < 0.0f) player.position.y = 0.0f;
-    if (player.position.y > WORLD_HEIGHT) player.position.y = WORLD_HEIGHT;
+    StepPlayerMovement(player.position.x, player.position.y, player.velocity.x, player.velocity.y, moveX, moveY, dt,
+                       m_quantizedSnapshots);
 }
 
 void GameClient::ReconcileWithServer(const Player& serverPlayer, uint32_t lastProcessedInput)
@@ -233,10 +322,9 @@ void GameClient::ReconcileWithServer(const Player& serverPlayer, uint32_t lastPr
 
     m_predictedPlayer = serverPlayer;
 
-    const float dt = 1.0f / 60.0f;
     for (const auto& input : m_inputHistory)
     {
-        PredictMovement(m_predictedPlayer, input.moveX, input.moveY, dt);
+        PredictMovement(m_predictedPlayer, input.moveX, input.moveY, INPUT_STEP_DT);
     }
 }
 
@@ -255,7 +343,8 @@ void GameClient::InterpolatePlayerStates(float dt)
         return;
     }
 
-    m_interpolationTime = m_clientTime - INTERPOLATION_DELAY;
+    // Follows the measured snapshot spacing, so low rates and congestion never outrun the buffer
+    m_interpolationTime = m_serverClock.GetServerTime(m_clientTime) - m_snapshotSpacing.GetInterpolationDelay();
 
     Snapshot* from = nullptr;
     Snapshot* to = nullptr;
@@ -323,13 +412,8 @@ void GameClient::UpdateCamera(float dt)
     m_camera.target.x += (targetPos.x - m_camera.target.x) * CAMERA_SMOOTHNESS;
     m_camera.target.y += (targetPos.y - m_camera.target.y) * CAMERA_SMOOTHNESS;
 
-    const float BASE_ZOOM = 1.0f;
-    const float ZOOM_FACTOR = 0.015f;
-    const float MIN_ZOOM = 0.3f;
-    const float MAX_ZOOM = 1.5f;
-
-    float targetZoom = BASE_ZOOM / (1.0f + m_predictedPlayer.size * ZOOM_FACTOR);
-    targetZoom = std::max(MIN_ZOOM, std::min(MAX_ZOOM, targetZoom));
+    // Shared with the server, which filters snapshots down to this view
+    float targetZoom = GetViewZoom(m_predictedPlayer.size);
 
     m_camera.zoom += (targetZoom - m_camera.zoom) * CAMERA_SMOOTHNESS;
 }
@@ -340,7 +424,7 @@ void GameClient::RenderGrid()
     const Color GRID_COLOR = {200, 200, 200, 100};
 
     Vector2 topLeft = GetScreenToWorld2D({0, 0}, m_camera);
-    Vector2 bottomRight = GetScreenToWorld2D({1280, 720}, m_camera);
+    Vector2 bottomRight = GetScreenToWorld2D({(float)VIEW_WIDTH, (float)VIEW_HEIGHT}, m_camera);
 
     int startX = (int)(topLeft.x / GRID_SPACING) * GRID_SPACING;
     int startY = (int)(topLeft.y / GRID_SPACING) * GRID_SPACING;
@@ -384,8 +468,12 @@ void GameClient::Render()
     
     RenderGrid();
 
-    for (const auto& food : m_foodItems)
+    for (int id = 0; id < MAX_FOOD; ++id)
     {
+        if (!m_food.Has(id))
+            continue;
+
+        const FoodItem& food = m_food.items[id];
         Color foodColor = GetColor(food.color);
         Vector2 foodPos = {food.position.x, food.position.y};
 
@@ -2,6 +2,7 @@
 #include <memory>
 #include <yojimbo.h>
 #include "../common/protocol.hpp"
+#include "../common/snapshot.hpp"
 #include "raylib.h"
 #include <EASTL/deque.h>
 #include <EASTL/unordered_map.h>
@@ -11,6 +12,8 @@ class GameClient
 {
 public:
     GameClient(const yojimbo::Address &address);
+    // Connects in-process through `network` instead of over UDP
+    explicit GameClient(LoopbackNetwork &network);
     ~GameClient();
     void ProcessServerMessages();
     void Update(float dt);
@@ -19,14 +22,28 @@ public:
     bool IsConnected() const { return m_client.IsConnected(); }
     bool IsLocalPlayerCreated() const { return m_isLocalPlayerCreated; }
     int GetOtherPlayerCount() const { return m_otherPlayers.size(); }
+    const eastl::unordered_map<int, Player> &GetOtherPlayers() const { return m_otherPlayers; }
+    const FoodTable &GetFood() const { return m_food; }
+
+    // How many of the newest inputs each input packet carries
+    void SetInputBatchSize(int batchSize) { m_inputBatchSize = batchSize; }
+    int GetInputBatchSize() const { return m_inputBatchSize; }
+
+    // Moves as if these axes were held, in place of the keyboard; sent even without a window
+    void SetScriptedInput(float moveX, float moveY);
+
+    // How far behind the server clock other players are rendered
+    double GetInterpolationDelay() const { return m_snapshotSpacing.GetInterpolationDelay(); }
 
 private:
+    GameClient();
+
     Player m_localPlayer;
     Player m_predictedPlayer;
     bool m_isLocalPlayerCreated = false;
 
     eastl::unordered_map<int, Player> m_otherPlayers;
-    eastl::vector<FoodItem> m_foodItems;
+    FoodTable m_food;  // Persistent, updated by reliable food events
 
     // Camera
     Camera2D m_camera;
@@ -35,16 +52,33 @@ private:
 
     uint32_t m_inputSequence;
     eastl::deque<StoredInput> m_inputHistory;
+    int m_inputBatchSize;
+    bool m_scriptedInput;
+    float m_scriptedMoveX;
+    float m_scriptedMoveY;
     double m_clientTime;
 
     eastl::deque<Snapshot> m_snapshotBuffer;
-    double m_interpolationTime;
+    double m_interpolationTime;  // Server time other players are rendered at, the interpolation delay behind
+    ServerClock m_serverClock;
+    SnapshotSpacing m_snapshotSpacing;
+
+    // Decoded snapshots kept as delta baselines, and the newest one acked
+    SnapshotHistory m_receivedSnapshots;
+    uint32_t m_lastSnapshotTick;
+    bool m_quantizedSnapshots;  // Prediction snaps like the server when its snapshots are quantized
 
     ClientAdapter m_adapter;
     GameConnectionConfig m_connectionConfig;
     yojimbo::Client m_client;
+    LoopbackNetwork *m_loopback;
 
     void ReceiveWorldState(WorldStateMessage *message);
+    void ReceiveSharedSnapshot(SharedSnapshotMessage *message);
+    void ReceiveFoodSync(FoodSyncMessage *message);
+    void ReceiveFoodSpawned(FoodSpawnedMessage *message);
+    void ReceiveFoodEaten(FoodEatenMessage *message);
+    void SendSnapshotAck(uint32_t serverTick);
     void SendInput();
     void PredictMovement(Player& player, float moveX, float moveY, float dt);
     void ReconcileWithServer(const Player& serverPlayer, uint32_t lastProcessedInput);
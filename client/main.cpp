@@ -32,7 +32,7 @@ int main(void)
             return 1;
         }
 
-        InitWindow(1280, 720, "Circ.io Client");
+        InitWindow(VIEW_WIDTH, VIEW_HEIGHT, "Circ.io Client");
         SetTargetFPS(60);
         std::cout << "[DEBUG] Starting Server updates" << std::endl;
         while (!WindowShouldClose())
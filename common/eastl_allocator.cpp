@@ -1,19 +1,462 @@
 #include <EASTL/internal/config.h>
 #include <new>
 #include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include "eastl_allocator.hpp"
+#include "heap_counter.hpp"
 
-// EASTL requires you to define your own operator new/delete overloads
-// These are used for EASTL containers
+#if CIRC_TICK_ALLOC_CHECK
+// Process-wide, so allocations on JobPool workers during a tick count too
+static std::atomic<uint64_t> s_heapAllocations(0);
 
-void* operator new[](size_t size, const char* /*name*/, int /*flags*/,
+uint64_t GetHeapAllocationCount()
+{
+    return s_heapAllocations.load(std::memory_order_relaxed);
+}
+
+void CountHeapAllocation()
+{
+    s_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* operator new(size_t size)
+{
+    CountHeapAllocation();
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t /*size*/) noexcept
+{
+    free(p);
+}
+#endif
+
+// Sits right in front of every block, so delete[] can tell where the block
+// came from and whose bytes to give back
+struct BlockHeader
+{
+    uint64_t bytes;   // As requested
+    uint32_t offset;  // From the start of the backing allocation to this header
+    uint16_t tag;
+    uint8_t source;   // Size class, SOURCE_SYSTEM, SOURCE_ALLOCATOR + allocator index, or SOURCE_PLAIN
+    uint8_t reserved;
+};
+
+static const size_t HEADER_BYTES = sizeof(BlockHeader);
+static_assert(HEADER_BYTES == 16, "Blocks are handed out 16-byte aligned after the header");
+
+static const size_t SIZE_CLASS_BYTES[CONTAINER_MEMORY_SIZE_CLASSES] = {32, 64, 128, 256, 512, 1024, 2048};
+static const uint8_t SOURCE_SYSTEM = 32;
+static const uint8_t SOURCE_ALLOCATOR = 33;
+static const uint8_t SOURCE_PLAIN = SOURCE_ALLOCATOR + CONTAINER_MEMORY_MAX_ALLOCATORS; // Plain new[], untracked
+
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+// Each thread allocates from and frees to its own free lists, so the common
+// path takes no lock. Lists that grow past CONTAINER_MEMORY_CACHE_CHUNKS
+// chunks (a thread freeing what another allocated) hand a chunk's worth of
+// blocks to the shared depot, where other threads refill from.
+struct SizeClassCache
+{
+    FreeBlock* free[CONTAINER_MEMORY_SIZE_CLASSES];
+    size_t count[CONTAINER_MEMORY_SIZE_CLASSES];
+};
+
+static thread_local SizeClassCache t_cache = {};
+
+// Hands a finishing thread's blocks to the depot. t_cache itself has no
+// destructor, so frees that come after this one still have a list to go to.
+struct SizeClassCacheFlusher
+{
+    ~SizeClassCacheFlusher();
+};
+
+static thread_local SizeClassCacheFlusher t_flusher;
+
+// The depot, tag registration, the allocator list and calls into the
+// installed allocators are the only shared state under the lock; counters are atomics
+static std::mutex s_mutex;
+static FreeBlock* s_depot[CONTAINER_MEMORY_SIZE_CLASSES];
+static size_t s_depotCount[CONTAINER_MEMORY_SIZE_CLASSES];
+static yojimbo::Allocator* s_allocators[CONTAINER_MEMORY_MAX_ALLOCATORS];
+static int s_allocatorCount = 0;
+static std::atomic<int> s_currentAllocator(-1);
+
+struct TagCounters
+{
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> bytesInUse;
+    std::atomic<uint64_t> highWater;
+};
+
+static TagCounters s_tags[CONTAINER_MEMORY_MAX_TAGS];
+static std::atomic<int> s_tagCount(0);
+static std::atomic<uint64_t> s_allocations(0);
+static std::atomic<uint64_t> s_frees(0);
+static std::atomic<uint64_t> s_pooled(0);
+static std::atomic<uint64_t> s_overflow(0);
+static std::atomic<uint64_t> s_poolBytes(0);
+static std::atomic<uint64_t> s_bytesInUse(0);
+static std::atomic<uint64_t> s_highWater(0);
+
+static uintptr_t AlignUp(uintptr_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(uintptr_t)(alignment - 1);
+}
+
+static BlockHeader ReadHeader(const void* p)
+{
+    BlockHeader header;
+    memcpy(&header, static_cast<const uint8_t*>(p) - HEADER_BYTES, HEADER_BYTES);
+    return header;
+}
+
+static void WriteHeader(void* p, const BlockHeader& header)
+{
+    memcpy(static_cast<uint8_t*>(p) - HEADER_BYTES, &header, HEADER_BYTES);
+}
+
+static void RaiseHighWater(std::atomic<uint64_t>& highWater, uint64_t value)
+{
+    uint64_t current = highWater.load(std::memory_order_relaxed);
+    while (value > current && !highWater.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+// Names are kept by pointer, as EASTL names are string literals: a known
+// pointer is found without a lock, and only new pointers are compared by
+// content, under it
+static uint16_t FindTag(const char* name)
+{
+    if (!name)
+        name = "EASTL";
+    int count = s_tagCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i)
+    {
+        if (s_tags[i].name.load(std::memory_order_relaxed) == name)
+            return static_cast<uint16_t>(i);
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    count = s_tagCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i)
+    {
+        if (strcmp(s_tags[i].name.load(std::memory_order_relaxed), name) == 0)
+            return static_cast<uint16_t>(i);
+    }
+    if (count < CONTAINER_MEMORY_MAX_TAGS - 1)
+    {
+        s_tags[count].name.store(name, std::memory_order_relaxed);
+        s_tagCount.store(count + 1, std::memory_order_release);
+        return static_cast<uint16_t>(count);
+    }
+    if (count < CONTAINER_MEMORY_MAX_TAGS)
+    {
+        s_tags[CONTAINER_MEMORY_MAX_TAGS - 1].name.store("other", std::memory_order_relaxed);
+        s_tagCount.store(CONTAINER_MEMORY_MAX_TAGS, std::memory_order_release);
+    }
+    return CONTAINER_MEMORY_MAX_TAGS - 1;
+}
+
+static int FindSizeClass(size_t blockBytes)
+{
+    for (int i = 0; i < CONTAINER_MEMORY_SIZE_CLASSES; ++i)
+    {
+        if (blockBytes <= SIZE_CLASS_BYTES[i])
+            return i;
+    }
+    return -1;
+}
+
+static size_t BlocksPerChunk(int sizeClass)
+{
+    return CONTAINER_MEMORY_POOL_CHUNK / SIZE_CLASS_BYTES[sizeClass];
+}
+
+// Refills the calling thread's list from the depot, or else carves a new
+// chunk into it. Chunks come from the system heap whatever the container
+// allocator is, so they can be kept for good.
+static bool RefillSizeClass(int sizeClass)
+{
+    (void)&t_flusher; // Constructs it, so this thread's blocks go back when it exits
+    SizeClassCache& cache = t_cache;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_depot[sizeClass])
+        {
+            cache.free[sizeClass] = s_depot[sizeClass];
+            cache.count[sizeClass] = s_depotCount[sizeClass];
+            s_depot[sizeClass] = nullptr;
+            s_depotCount[sizeClass] = 0;
+            return true;
+        }
+    }
+
+    uint8_t* chunk = static_cast<uint8_t*>(malloc(CONTAINER_MEMORY_POOL_CHUNK));
+    if (!chunk)
+        return false;
+    const size_t blockBytes = SIZE_CLASS_BYTES[sizeClass];
+    for (size_t i = BlocksPerChunk(sizeClass); i-- > 0;)
+    {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * blockBytes);
+        block->next = cache.free[sizeClass];
+        cache.free[sizeClass] = block;
+    }
+    cache.count[sizeClass] += BlocksPerChunk(sizeClass);
+    s_poolBytes.fetch_add(CONTAINER_MEMORY_POOL_CHUNK, std::memory_order_relaxed);
+    return true;
+}
+
+// Moves a chunk's worth of blocks from the front of the calling thread's list to the depot
+static void SpillSizeClass(int sizeClass)
+{
+    SizeClassCache& cache = t_cache;
+    const size_t spill = BlocksPerChunk(sizeClass);
+    FreeBlock* first = cache.free[sizeClass];
+    FreeBlock* last = first;
+    for (size_t i = 1; i < spill; ++i)
+        last = last->next;
+    cache.free[sizeClass] = last->next;
+    cache.count[sizeClass] -= spill;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    last->next = s_depot[sizeClass];
+    s_depot[sizeClass] = first;
+    s_depotCount[sizeClass] += spill;
+}
+
+SizeClassCacheFlusher::~SizeClassCacheFlusher()
+{
+    SizeClassCache& cache = t_cache;
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (int sizeClass = 0; sizeClass < CONTAINER_MEMORY_SIZE_CLASSES; ++sizeClass)
+    {
+        FreeBlock* first = cache.free[sizeClass];
+        if (!first)
+            continue;
+        FreeBlock* last = first;
+        while (last->next)
+            last = last->next;
+        last->next = s_depot[sizeClass];
+        s_depot[sizeClass] = first;
+        s_depotCount[sizeClass] += cache.count[sizeClass];
+        cache.free[sizeClass] = nullptr;
+        cache.count[sizeClass] = 0;
+    }
+}
+
+// TLSF is not thread-safe, so calls into the installed allocator are made
+// under the lock; the system heap path needs none
+static void* AllocateBacking(size_t bytes, uint8_t& source)
+{
+    const int current = s_currentAllocator.load(std::memory_order_acquire);
+    if (current >= 0)
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (void* p = YOJIMBO_ALLOCATE(*s_allocators[current], bytes))
+        {
+            source = static_cast<uint8_t>(SOURCE_ALLOCATOR + current);
+            return p;
+        }
+        s_overflow.fetch_add(1, std::memory_order_relaxed);
+    }
+    source = SOURCE_SYSTEM;
+    return malloc(bytes);
+}
+
+static void FreeBacking(void* p, uint8_t source)
+{
+    if (source == SOURCE_SYSTEM || source == SOURCE_PLAIN)
+    {
+        free(p);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(s_mutex);
+    YOJIMBO_FREE(*s_allocators[source - SOURCE_ALLOCATOR], p);
+}
+
+static void* AllocateBlock(size_t bytes, size_t alignment, size_t alignmentOffset, const char* name)
+{
+#if CIRC_TICK_ALLOC_CHECK
+    // Counted on entry, so blocks from the pool, the installed allocator and
+    // the system heap (including new pool chunks) all count
+    CountHeapAllocation();
+#endif
+    BlockHeader header = {};
+    header.bytes = bytes;
+    header.tag = FindTag(name);
+
+    // Pooled blocks start 16-byte aligned, which covers EASTL's default alignment
+    uint8_t* p = nullptr;
+    const bool poolable = alignment <= HEADER_BYTES && alignmentOffset % alignment == 0;
+    const int sizeClass = poolable ? FindSizeClass(bytes + HEADER_BYTES) : -1;
+    SizeClassCache& cache = t_cache;
+    if (sizeClass >= 0 && (cache.free[sizeClass] || RefillSizeClass(sizeClass)))
+    {
+        FreeBlock* block = cache.free[sizeClass];
+        cache.free[sizeClass] = block->next;
+        cache.count[sizeClass]--;
+        p = reinterpret_cast<uint8_t*>(block) + HEADER_BYTES;
+        header.source = static_cast<uint8_t>(sizeClass);
+        s_pooled.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        // TLSF only guarantees 8-byte alignment, so every backing block is padded and aligned here
+        if (alignment < HEADER_BYTES)
+            alignment = HEADER_BYTES;
+        uint8_t* raw = static_cast<uint8_t*>(AllocateBacking(bytes + HEADER_BYTES + alignment, header.source));
+        if (!raw)
+            return nullptr;
+        const uintptr_t start = reinterpret_cast<uintptr_t>(raw) + HEADER_BYTES + alignmentOffset;
+        p = reinterpret_cast<uint8_t*>(AlignUp(start, alignment) - alignmentOffset);
+        header.offset = static_cast<uint32_t>(p - HEADER_BYTES - raw);
+    }
+    WriteHeader(p, header);
+
+    TagCounters& tag = s_tags[header.tag];
+    tag.allocations.fetch_add(1, std::memory_order_relaxed);
+    RaiseHighWater(tag.highWater, tag.bytesInUse.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    RaiseHighWater(s_highWater, s_bytesInUse.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    return p;
+}
+
+static void ReleaseBlock(void* p)
+{
+    if (!p)
+        return;
+    const BlockHeader header = ReadHeader(p);
+    uint8_t* block = static_cast<uint8_t*>(p) - HEADER_BYTES;
+    if (header.source == SOURCE_PLAIN)
+    {
+        free(block);
+        return;
+    }
+
+    s_tags[header.tag].bytesInUse.fetch_sub(header.bytes, std::memory_order_relaxed);
+    s_bytesInUse.fetch_sub(header.bytes, std::memory_order_relaxed);
+    s_frees.fetch_add(1, std::memory_order_relaxed);
+
+    if (header.source < CONTAINER_MEMORY_SIZE_CLASSES)
+    {
+        SizeClassCache& cache = t_cache;
+        FreeBlock* slot = reinterpret_cast<FreeBlock*>(block);
+        slot->next = cache.free[header.source];
+        cache.free[header.source] = slot;
+        if (++cache.count[header.source] > CONTAINER_MEMORY_CACHE_CHUNKS * BlocksPerChunk(header.source))
+            SpillSizeClass(header.source);
+    }
+    else
+    {
+        FreeBacking(block - header.offset, header.source);
+    }
+}
+
+ContainerMemoryStats GetContainerMemoryStats()
+{
+    ContainerMemoryStats stats;
+    stats.allocations = s_allocations.load(std::memory_order_relaxed);
+    stats.frees = s_frees.load(std::memory_order_relaxed);
+    stats.pooled = s_pooled.load(std::memory_order_relaxed);
+    stats.overflow = s_overflow.load(std::memory_order_relaxed);
+    stats.poolBytes = s_poolBytes.load(std::memory_order_relaxed);
+    stats.bytesInUse = s_bytesInUse.load(std::memory_order_relaxed);
+    stats.highWater = s_highWater.load(std::memory_order_relaxed);
+    stats.bounded = s_currentAllocator.load(std::memory_order_relaxed) >= 0;
+    stats.tagCount = s_tagCount.load(std::memory_order_acquire);
+    for (int i = 0; i < stats.tagCount; ++i)
+    {
+        stats.tags[i].name = s_tags[i].name.load(std::memory_order_relaxed);
+        stats.tags[i].allocations = s_tags[i].allocations.load(std::memory_order_relaxed);
+        stats.tags[i].bytesInUse = s_tags[i].bytesInUse.load(std::memory_order_relaxed);
+        stats.tags[i].highWater = s_tags[i].highWater.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+bool SetContainerAllocator(yojimbo::Allocator* allocator)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!allocator)
+    {
+        s_currentAllocator.store(-1, std::memory_order_release);
+        return true;
+    }
+    for (int i = 0; i < s_allocatorCount; ++i)
+    {
+        if (s_allocators[i] == allocator)
+        {
+            s_currentAllocator.store(i, std::memory_order_release);
+            return true;
+        }
+    }
+    if (s_allocatorCount == CONTAINER_MEMORY_MAX_ALLOCATORS)
+        return false;
+    s_allocators[s_allocatorCount] = allocator;
+    s_currentAllocator.store(s_allocatorCount++, std::memory_order_release);
+    return true;
+}
+
+yojimbo::Allocator* GetContainerAllocator()
+{
+    const int current = s_currentAllocator.load(std::memory_order_acquire);
+    return current >= 0 ? s_allocators[current] : nullptr;
+}
+
+// EASTL requires you to define your own operator new/delete overloads.
+// Only these two are pooled and tracked.
+
+void* operator new[](size_t size, const char* name, int /*flags*/,
     unsigned /*debugFlags*/, const char* /*file*/, int /*line*/)
 {
-    return malloc(size);
+    return AllocateBlock(size, HEADER_BYTES, 0, name);
+}
+
+void* operator new[](size_t size, size_t alignment, size_t alignmentOffset,
+    const char* name, int /*flags*/, unsigned /*debugFlags*/, const char* /*file*/, int /*line*/)
+{
+    return AllocateBlock(size, alignment, alignmentOffset, name);
+}
+
+// EASTL's default allocator frees with plain delete[], so delete[] has to
+// read the header, and plain new[] has to write one. It stays a bare malloc
+// otherwise: no lock, tag lookup or counters.
+void* operator new[](size_t size)
+{
+#if CIRC_TICK_ALLOC_CHECK
+    CountHeapAllocation();
+#endif
+    uint8_t* block = static_cast<uint8_t*>(malloc(size + HEADER_BYTES));
+    if (!block)
+        throw std::bad_alloc();
+    BlockHeader header = {};
+    header.bytes = size;
+    header.source = SOURCE_PLAIN;
+    WriteHeader(block + HEADER_BYTES, header);
+    return block + HEADER_BYTES;
+}
+
+void operator delete[](void* p) noexcept
+{
+    ReleaseBlock(p);
 }
 
-void* operator new[](size_t size, size_t /*alignment*/, size_t /*alignmentOffset*/,
-    const char* /*name*/, int /*flags*/, unsigned /*debugFlags*/, const char* /*file*/, int /*line*/)
+void operator delete[](void* p, size_t /*size*/) noexcept
 {
-    // For simplicity, ignoring alignment for now
-    return malloc(size);
+    ReleaseBlock(p);
 }
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <yojimbo.h>
+
+// Memory behind EASTL containers comes from common/eastl_allocator.cpp:
+// blocks up to the largest size class are served from per-thread, per-class
+// free lists, larger or over-aligned ones from the container
+// allocator, which is the system heap unless SetContainerAllocator installed
+// a yojimbo allocator (e.g. a TLSF_Allocator over a fixed block) to bound it.
+
+static const int CONTAINER_MEMORY_MAX_TAGS = 32;        // The last tag collects names past the limit as "other"
+static const int CONTAINER_MEMORY_MAX_ALLOCATORS = 8;   // Distinct allocators SetContainerAllocator accepts
+static const int CONTAINER_MEMORY_SIZE_CLASSES = 7;     // 32 to 2048 bytes, header included
+static const size_t CONTAINER_MEMORY_POOL_CHUNK = 64 * 1024;
+static const size_t CONTAINER_MEMORY_CACHE_CHUNKS = 2;  // Free blocks a thread keeps per size class, in chunks
+
+// Bytes by the name EASTL passes with each allocation. EASTL only passes names
+// when built with EASTL_DEBUGPARAMS_LEVEL > 0 or EASTL_NAME_ENABLED; anything
+// unnamed is counted as "EASTL". Plain new[] is not counted.
+struct ContainerTagStats {
+    const char* name = nullptr;
+    uint64_t allocations = 0;
+    uint64_t bytesInUse = 0;
+    uint64_t highWater = 0;
+};
+
+struct ContainerMemoryStats {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t pooled = 0;      // Served from a size-class free list
+    uint64_t overflow = 0;    // The container allocator was full, so the block came from the system heap
+    uint64_t poolBytes = 0;   // Reserved for the size classes; chunks are kept for reuse, never freed
+    uint64_t bytesInUse = 0;  // As requested, across all tags
+    uint64_t highWater = 0;
+    bool bounded = false;     // A container allocator is installed
+    int tagCount = 0;
+    ContainerTagStats tags[CONTAINER_MEMORY_MAX_TAGS];
+};
+
+ContainerMemoryStats GetContainerMemoryStats();
+
+// Blocks too large or too aligned for the size classes come from `allocator`
+// from now on; nullptr goes back to the system heap. Blocks remember where
+// they came from, so switching is safe, but `allocator` must outlive every
+// block taken from it. Returns false (and changes nothing) once
+// CONTAINER_MEMORY_MAX_ALLOCATORS distinct allocators have been installed.
+bool SetContainerAllocator(yojimbo::Allocator* allocator);
+yojimbo::Allocator* GetContainerAllocator();
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <yojimbo.h>
+
+// Build with -DCIRC_TICK_ALLOC_CHECK=1 (CMake option CIRC_TICK_ALLOC_CHECK) to
+// count heap allocations: global operator new and operator new[], container
+// blocks, frame arena overflow and the server's yojimbo allocator bump a
+// process-wide counter, which the server reads around every tick, so
+// allocations on snapshot workers and other threads during a tick count too.
+#ifndef CIRC_TICK_ALLOC_CHECK
+#define CIRC_TICK_ALLOC_CHECK 0
+#endif
+
+#if CIRC_TICK_ALLOC_CHECK
+// Heap allocations made by every thread so far
+uint64_t GetHeapAllocationCount();
+void CountHeapAllocation();
+
+// yojimbo's DefaultAllocator calls malloc directly, past the operator new
+// hooks; the server hands yojimbo this instead, so those allocations count
+class CountingAllocator : public yojimbo::Allocator {
+public:
+    void* Allocate(size_t size, const char* file, int line) override {
+        CountHeapAllocation();
+        return yojimbo::GetDefaultAllocator().Allocate(size, file, line);
+    }
+
+    void Free(void* p, const char* file, int line) override {
+        yojimbo::GetDefaultAllocator().Free(p, file, line);
+    }
+};
+#endif
@@ -0,0 +1,213 @@
+#pragma once
+#include <cstring>
+#include <yojimbo.h>
+#include <EASTL/vector.h>
+#include <EASTL/sort.h>
+
+// Time that only moves when told to, so runs over LoopbackNetwork are
+// repeatable and never wait on the wall clock
+class VirtualClock {
+public:
+    explicit VirtualClock(double time = 0.0) : m_time(time) {}
+
+    double Advance(double dt) {
+        m_time += dt;
+        return m_time;
+    }
+    double GetTime() const { return m_time; }
+
+private:
+    double m_time;
+};
+
+struct LoopbackConfig {
+    double latency = 0.0;     // One-way delay in seconds
+    double jitter = 0.0;      // Up to this much extra delay per packet, so packets may reorder
+    float packetLoss = 0.0f;  // Fraction of packets dropped, 0 to 1
+    uint32_t seed = 1;        // Same seed, same drops and delays
+};
+
+// A packet in flight between the server and one of its loopback clients
+struct LoopbackPacket {
+    int clientIndex;
+    bool toServer;
+    uint64_t sequence;
+    double deliveryTime;
+    eastl::vector<uint8_t> data;
+};
+
+// Connects one server and any number of clients in the same process through
+// yojimbo's loopback path: no sockets carry traffic, no connect handshake, and
+// packets are handed over in Update according to a VirtualClock. The adapters
+// on both sides forward their loopback packets to SendToClient/SendToServer.
+class LoopbackNetwork {
+public:
+    explicit LoopbackNetwork(const LoopbackConfig& config = LoopbackConfig())
+        : m_server(nullptr), m_sent(0), m_dropped(0), m_delivered(0) {
+        SetConfig(config);
+    }
+
+    void SetConfig(const LoopbackConfig& config) {
+        m_config = config;
+        m_random = config.seed ? config.seed : 1;
+    }
+    const LoopbackConfig& GetConfig() const { return m_config; }
+    double GetTime() const { return m_clock.GetTime(); }
+
+    // `server` must be started; its slots are handed out to clients by Connect
+    void AttachServer(yojimbo::ServerInterface* server, int maxClients) {
+        m_server = server;
+        m_clients.assign(maxClients, nullptr);
+    }
+
+    // Disconnects every client from the server, which must still be running
+    void DetachServer() {
+        for (int i = 0; i < static_cast<int>(m_clients.size()); ++i) {
+            if (!m_clients[i])
+                continue;
+            if (m_server && m_server->IsLoopbackClient(i))
+                m_server->DisconnectLoopbackClient(i);
+            m_clients[i]->DisconnectLoopback();
+            m_clients[i] = nullptr;
+        }
+        m_server = nullptr;
+        m_inFlight.clear();
+    }
+
+    // Connects `client` to the first free server slot. Both sides are connected
+    // on return. Returns the client index, or -1 when the server is full.
+    int Connect(yojimbo::ClientInterface& client, uint64_t clientId) {
+        if (!m_server)
+            return -1;
+        const int maxClients = static_cast<int>(m_clients.size());
+        for (int i = 0; i < maxClients; ++i) {
+            if (m_clients[i] || m_server->IsClientConnected(i))
+                continue;
+            m_clients[i] = &client;
+            client.ConnectLoopback(i, clientId, maxClients);
+            m_server->ConnectLoopbackClient(i, clientId, nullptr);
+            return i;
+        }
+        return -1;
+    }
+
+    void Disconnect(yojimbo::ClientInterface& client) {
+        for (int i = 0; i < static_cast<int>(m_clients.size()); ++i) {
+            if (m_clients[i] != &client)
+                continue;
+            if (m_server && m_server->IsLoopbackClient(i))
+                m_server->DisconnectLoopbackClient(i);
+            m_clients[i] = nullptr;
+            DropPackets(i);
+        }
+        if (client.IsLoopback())
+            client.DisconnectLoopback();
+    }
+
+    void SendToClient(int clientIndex, const uint8_t* packetData, int packetBytes, uint64_t packetSequence) {
+        Queue(clientIndex, false, packetData, packetBytes, packetSequence);
+    }
+
+    void SendToServer(int clientIndex, const uint8_t* packetData, int packetBytes, uint64_t packetSequence) {
+        Queue(clientIndex, true, packetData, packetBytes, packetSequence);
+    }
+
+    // Moves the clock forward and delivers every packet due by then, oldest first
+    void Update(double dt) {
+        const double now = m_clock.Advance(dt);
+
+        m_due.clear();
+        int kept = 0;
+        for (int i = 0; i < static_cast<int>(m_inFlight.size()); ++i) {
+            if (m_inFlight[i].deliveryTime <= now)
+                m_due.push_back(eastl::move(m_inFlight[i]));
+            else if (kept++ != i)
+                m_inFlight[kept - 1] = eastl::move(m_inFlight[i]);
+        }
+        m_inFlight.resize(kept);
+
+        eastl::stable_sort(m_due.begin(), m_due.end(), [](const LoopbackPacket& a, const LoopbackPacket& b) {
+            return a.deliveryTime < b.deliveryTime;
+        });
+        for (LoopbackPacket& packet : m_due) {
+            Deliver(packet);
+            // Delivered packets keep their buffers for reuse, so a steady stream allocates nothing
+            m_spare.push_back(eastl::move(packet));
+        }
+        m_due.clear();
+    }
+
+    int GetPacketsInFlight() const { return static_cast<int>(m_inFlight.size()); }
+    uint64_t GetPacketsSent() const { return m_sent; }
+    uint64_t GetPacketsDropped() const { return m_dropped; }
+    uint64_t GetPacketsDelivered() const { return m_delivered; }
+
+private:
+    void Queue(int clientIndex, bool toServer, const uint8_t* packetData, int packetBytes, uint64_t packetSequence) {
+        m_sent++;
+        if (m_config.packetLoss > 0.0f && Random() < m_config.packetLoss) {
+            m_dropped++;
+            return;
+        }
+
+        LoopbackPacket packet;
+        if (!m_spare.empty()) {
+            packet = eastl::move(m_spare.back());
+            m_spare.pop_back();
+        }
+        packet.clientIndex = clientIndex;
+        packet.toServer = toServer;
+        packet.sequence = packetSequence;
+        packet.deliveryTime = m_clock.GetTime() + m_config.latency;
+        if (m_config.jitter > 0.0)
+            packet.deliveryTime += m_config.jitter * Random();
+        packet.data.assign(packetData, packetData + packetBytes);
+        m_inFlight.push_back(eastl::move(packet));
+    }
+
+    void Deliver(const LoopbackPacket& packet) {
+        const int bytes = static_cast<int>(packet.data.size());
+        if (packet.toServer) {
+            if (!m_server || !m_server->IsLoopbackClient(packet.clientIndex))
+                return;
+            m_server->ProcessLoopbackPacket(packet.clientIndex, packet.data.data(), bytes, packet.sequence);
+        } else {
+            yojimbo::ClientInterface* client = m_clients[packet.clientIndex];
+            if (!client || !client->IsLoopback())
+                return;
+            client->ProcessLoopbackPacket(packet.data.data(), bytes, packet.sequence);
+        }
+        m_delivered++;
+    }
+
+    void DropPackets(int clientIndex) {
+        int kept = 0;
+        for (int i = 0; i < static_cast<int>(m_inFlight.size()); ++i) {
+            if (m_inFlight[i].clientIndex != clientIndex && kept++ != i)
+                m_inFlight[kept - 1] = eastl::move(m_inFlight[i]);
+        }
+        m_inFlight.resize(kept);
+    }
+
+    // xorshift32, in [0, 1)
+    float Random() {
+        m_random ^= m_random << 13;
+        m_random ^= m_random >> 17;
+        m_random ^= m_random << 5;
+        return (m_random >> 8) * (1.0f / 16777216.0f);
+    }
+
+    LoopbackConfig m_config;
+    VirtualClock m_clock;
+    uint32_t m_random;
+
+    yojimbo::ServerInterface* m_server;
+    eastl::vector<yojimbo::ClientInterface*> m_clients;
+    eastl::vector<LoopbackPacket> m_inFlight;
+    eastl::vector<LoopbackPacket> m_due;
+    eastl::vector<LoopbackPacket> m_spare;
+
+    uint64_t m_sent;
+    uint64_t m_dropped;
+    uint64_t m_delivered;
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <yojimbo.h>
+
+// Connection memory is carved into one TLSF block per client slot up front,
+// so the block size sets the server's RSS. These pick it from measurement:
+// run a room, read the peak, then size the blocks with headroom.
+static const float CONNECTION_MEMORY_HEADROOM = 0.5f;           // Spare over the observed peak, for fragmentation and bursts
+static const size_t CONNECTION_MEMORY_GRANULARITY = 64 * 1024;
+static const size_t CONNECTION_MEMORY_MINIMUM = 256 * 1024;     // Never recommend less, however quiet the measured run
+
+struct ConnectionMemoryStats {
+    uint64_t budget = 0;       // Size of the connection's block
+    uint64_t inUse = 0;        // As requested, plus a small header per allocation
+    uint64_t highWater = 0;    // Peak of inUse over the slot's lifetime, across the clients it served
+    uint64_t allocations = 0;
+    uint64_t failures = 0;     // Allocations the block could not satisfy; yojimbo drops the client on these
+};
+
+// TLSF allocator over one connection's block that keeps live byte counts.
+// TLSF does not report block sizes, so each allocation carries its size in
+// a header of TLSF's own 8-byte alignment.
+class BudgetedAllocator : public yojimbo::Allocator {
+public:
+    static const size_t HEADER_BYTES = 8;
+
+    // Counters go to `stats`, which must outlive the allocator
+    BudgetedAllocator(void* memory, size_t bytes, ConnectionMemoryStats& stats)
+        : m_tlsf(memory, bytes), m_stats(&stats) {
+        m_stats->budget = bytes;
+    }
+
+    BudgetedAllocator(const BudgetedAllocator&) = delete;
+    BudgetedAllocator& operator=(const BudgetedAllocator&) = delete;
+
+    void* Allocate(size_t size, const char* file, int line) override {
+        uint8_t* block = (uint8_t*)m_tlsf.Allocate(size + HEADER_BYTES, file, line);
+        if (!block) {
+            // BaseServer watches this allocator's error level, not the TLSF one inside it
+            m_stats->failures++;
+            SetErrorLevel(yojimbo::ALLOCATOR_ERROR_OUT_OF_MEMORY);
+            return nullptr;
+        }
+
+        const uint64_t bytes = size + HEADER_BYTES;
+        memcpy(block, &bytes, sizeof(bytes));
+        m_stats->allocations++;
+        m_stats->inUse += bytes;
+        if (m_stats->inUse > m_stats->highWater)
+            m_stats->highWater = m_stats->inUse;
+        return block + HEADER_BYTES;
+    }
+
+    void Free(void* p, const char* file, int line) override {
+        if (!p)
+            return;
+        uint8_t* block = (uint8_t*)p - HEADER_BYTES;
+        uint64_t bytes;
+        memcpy(&bytes, block, sizeof(bytes));
+        m_stats->inUse -= bytes;
+        m_tlsf.Free(block, file, line);
+    }
+
+private:
+    yojimbo::TLSF_Allocator m_tlsf;
+    ConnectionMemoryStats* m_stats;
+};
+
+// Block size that holds `peak` bytes with `headroom` to spare
+inline int RecommendConnectionMemory(uint64_t peak, float headroom = CONNECTION_MEMORY_HEADROOM) {
+    size_t bytes = static_cast<size_t>(peak * (1.0f + headroom));
+    bytes = (bytes + CONNECTION_MEMORY_GRANULARITY - 1) / CONNECTION_MEMORY_GRANULARITY * CONNECTION_MEMORY_GRANULARITY;
+    if (bytes < CONNECTION_MEMORY_MINIMUM)
+        bytes = CONNECTION_MEMORY_MINIMUM;
+    return static_cast<int>(bytes);
+}
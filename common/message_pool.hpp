@@ -0,0 +1,156 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <yojimbo.h>
+
+// Slots are handed out at this alignment. The slab start is aligned by hand:
+// BudgetedAllocator's size header leaves its blocks only 8-byte aligned.
+// Misses are as aligned as the backing allocator makes them.
+static const size_t MESSAGE_POOL_ALIGNMENT = 16;
+
+struct MessagePoolStats {
+    uint64_t hits = 0;    // Served from a free list
+    uint64_t misses = 0;  // Went to the backing allocator: larger than any slot, or its size class was empty
+    int inUse = 0;        // Slots currently handed out
+    int highWater = 0;    // Most slots ever handed out at once
+};
+
+// `count` slots of `slotBytes` carved out of one backing allocation and
+// threaded onto a free list through their first word
+class FixedSlotPool {
+public:
+    FixedSlotPool()
+        : m_block(nullptr), m_memory(nullptr), m_end(nullptr), m_free(nullptr), m_slotBytes(0), m_count(0) {}
+
+    // Leaves the pool empty (every request a miss) if the backing allocation fails
+    void Create(yojimbo::Allocator& backing, size_t slotBytes, int count) {
+        m_slotBytes = (slotBytes + MESSAGE_POOL_ALIGNMENT - 1) & ~(MESSAGE_POOL_ALIGNMENT - 1);
+        m_block = count > 0
+            ? (uint8_t*)YOJIMBO_ALLOCATE(backing, m_slotBytes * count + MESSAGE_POOL_ALIGNMENT - 1)
+            : nullptr;
+        m_memory = m_block
+            ? (uint8_t*)(((uintptr_t)m_block + MESSAGE_POOL_ALIGNMENT - 1) & ~(uintptr_t)(MESSAGE_POOL_ALIGNMENT - 1))
+            : nullptr;
+        m_count = m_memory ? count : 0;
+        m_end = m_memory + m_slotBytes * m_count;
+        m_free = nullptr;
+        for (int i = m_count - 1; i >= 0; --i)
+            Push(m_memory + m_slotBytes * i);
+    }
+
+    void Destroy(yojimbo::Allocator& backing) {
+        YOJIMBO_FREE(backing, m_block);
+        m_memory = nullptr;
+        m_end = nullptr;
+        m_free = nullptr;
+        m_count = 0;
+    }
+
+    size_t GetSlotBytes() const { return m_slotBytes; }
+    int GetCount() const { return m_count; }
+    bool Owns(const void* p) const { return p >= m_memory && p < m_end; }
+
+    void* Pop() {
+        FreeSlot* slot = m_free;
+        if (slot)
+            m_free = slot->next;
+        return slot;
+    }
+
+    void Push(void* p) {
+        FreeSlot* slot = static_cast<FreeSlot*>(p);
+        slot->next = m_free;
+        m_free = slot;
+    }
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    uint8_t* m_block;   // As the backing allocator returned it
+    uint8_t* m_memory;  // m_block rounded up to MESSAGE_POOL_ALIGNMENT
+    uint8_t* m_end;
+    FreeSlot* m_free;
+    size_t m_slotBytes;
+    int m_count;
+};
+
+// Allocator for a message factory: requests that fit a size class are a
+// free-list pop and push, anything else goes to the backing allocator. Frees
+// are routed by address, so blocks yojimbo allocates through the factory's
+// allocator (received block data) still go back where they came from.
+class MessagePoolAllocator : public yojimbo::Allocator {
+public:
+    static const int SIZE_CLASSES = 2;
+
+    // `shared`, if given, also receives every counter update, to total several pools
+    MessagePoolAllocator(yojimbo::Allocator& backing, size_t smallBytes, int smallSlots, size_t largeBytes,
+                         int largeSlots, MessagePoolStats* shared = nullptr)
+        : m_backing(&backing), m_shared(shared) {
+        m_pools[0].Create(backing, smallBytes, smallSlots);
+        m_pools[1].Create(backing, largeBytes, largeSlots);
+    }
+
+    ~MessagePoolAllocator() {
+        for (FixedSlotPool& pool : m_pools)
+            pool.Destroy(*m_backing);
+    }
+
+    MessagePoolAllocator(const MessagePoolAllocator&) = delete;
+    MessagePoolAllocator& operator=(const MessagePoolAllocator&) = delete;
+
+    void* Allocate(size_t size, const char* file, int line) override {
+        for (FixedSlotPool& pool : m_pools) {
+            if (size > pool.GetSlotBytes())
+                continue;
+            void* p = pool.Pop();
+            if (!p)
+                break;
+            CountHit(m_stats);
+            if (m_shared)
+                CountHit(*m_shared);
+            TrackAlloc(p, size, file, line);
+            return p;
+        }
+
+        m_stats.misses++;
+        if (m_shared)
+            m_shared->misses++;
+        void* p = m_backing->Allocate(size, file, line);
+        if (!p)
+            SetErrorLevel(yojimbo::ALLOCATOR_ERROR_OUT_OF_MEMORY);
+        return p;
+    }
+
+    void Free(void* p, const char* file, int line) override {
+        if (!p)
+            return;
+        for (FixedSlotPool& pool : m_pools) {
+            if (!pool.Owns(p))
+                continue;
+            TrackFree(p, file, line);
+            pool.Push(p);
+            m_stats.inUse--;
+            if (m_shared)
+                m_shared->inUse--;
+            return;
+        }
+        m_backing->Free(p, file, line);
+    }
+
+    const MessagePoolStats& GetStats() const { return m_stats; }
+    const FixedSlotPool& GetPool(int sizeClass) const { return m_pools[sizeClass]; }
+
+private:
+    static void CountHit(MessagePoolStats& stats) {
+        stats.hits++;
+        if (++stats.inUse > stats.highWater)
+            stats.highWater = stats.inUse;
+    }
+
+    yojimbo::Allocator* m_backing;
+    MessagePoolStats* m_shared;
+    FixedSlotPool m_pools[SIZE_CLASSES];
+    MessagePoolStats m_stats;
+};
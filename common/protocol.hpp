@@ -1,25 +1,58 @@
 #pragma once
 #include <cstdint>
 #include <cmath>
+#include <cstring>
 #include <yojimbo.h>
 #include <yojimbo_adapter.h>
 #include <EASTL/unordered_map.h>
 #include <EASTL/fixed_vector.h>
+#include <EASTL/vector.h>
 #include <EASTL/deque.h>
+#include "loopback.hpp"
+#include "message_pool.hpp"
+#include "memory_budget.hpp"
 
 // Forward declaration
 class GameServer;
 
-static const int MAX_PLAYERS = 16;
+static const int DEFAULT_MAX_PLAYERS = 16;                  // Server capacity when none is given at startup
+static const int MAX_PLAYER_CAPACITY = yojimbo::MaxClients; // Hard ceiling of the linked yojimbo build
 static const int MAX_FOOD = 128;
 static const int WORLD_WIDTH = 3200;
 static const int WORLD_HEIGHT = 2400;
+static const float SPATIAL_CELL_SIZE = 100.0f;  // Cell edge of the server's uniform broad-phase grid
+static const float PLAYER_MOVE_SPEED = 200.0f;
+static const float MAX_PLAYER_SIZE = 2048.0f;   // Upper bound of the quantized size range
 static const uint8_t DEFAULT_PRIVATE_KEY[yojimbo::KeyBytes] = {0};
 
 // Networking constants
+static const int TICK_RATE = 60;
+static const float INPUT_STEP_DT = 1.0f / TICK_RATE;  // Simulated time covered by one input
 static const int MAX_INPUT_HISTORY = 128;  // How many inputs to keep for reconciliation
+static const int MAX_INPUT_BATCH = 16;     // Most inputs one PlayerInputBatchMessage can carry
+static const int DEFAULT_INPUT_BATCH = 8;  // Newest inputs each batch resends, so losses are covered
 static const int MAX_SNAPSHOTS = 64;       // How many snapshots to keep for interpolation
-static const float INTERPOLATION_DELAY = 0.1f;  // 100ms delay for smooth interpolation
+static const int DEFAULT_SNAPSHOT_RATE = 20;    // Snapshots per second each client receives
+// Snapshot bytes per client per packet. Below yojimbo's 1024-byte fragmentPacketsAbove
+// with room left for packet and message headers and the reliable food events.
+static const int SNAPSHOT_BYTE_BUDGET = 896;
+static const float INTERPOLATION_DELAY = 0.1f;  // Minimum render delay, two snapshot intervals at 20 Hz
+static const double INTERPOLATION_INTERVALS = 2.0;  // Render delay in measured snapshot intervals
+
+// Client view. The server derives each client's area of interest from the same
+// numbers, so it never filters out something the camera can show.
+static const int VIEW_WIDTH = 1280;
+static const int VIEW_HEIGHT = 720;
+static const float VIEW_BASE_ZOOM = 1.0f;
+static const float VIEW_ZOOM_FACTOR = 0.015f;
+static const float VIEW_MIN_ZOOM = 0.3f;
+static const float VIEW_MAX_ZOOM = 1.5f;
+
+// Camera zoom the client settles on for a player of `size`
+inline float GetViewZoom(float size) {
+    float zoom = VIEW_BASE_ZOOM / (1.0f + size * VIEW_ZOOM_FACTOR);
+    return zoom < VIEW_MIN_ZOOM ? VIEW_MIN_ZOOM : (zoom > VIEW_MAX_ZOOM ? VIEW_MAX_ZOOM : zoom);
+}
 
 struct Position {
     float x;
@@ -102,18 +135,154 @@ struct Player {
     Player() : id(0), position{0, 0}, velocity{0, 0}, size(0), color(0) {}
 };
 
+// Dense structure-of-arrays player storage. Live players occupy slots
+// [0, Count()) with no holes; slotOfClient maps a client index to its slot
+// (-1 when the client has no player). Removal swaps the last slot into the
+// hole, so slots are only stable until the next Remove.
+struct PlayerTable {
+    eastl::vector<uint32_t> ids;
+    eastl::vector<float> x;
+    eastl::vector<float> y;
+    eastl::vector<float> velX;
+    eastl::vector<float> velY;
+    eastl::vector<float> size;
+    eastl::vector<uint32_t> color;
+    eastl::vector<int32_t> slotOfClient;
+
+    int Count() const { return static_cast<int>(ids.size()); }
+
+    int Find(uint32_t clientIndex) const {
+        return clientIndex < slotOfClient.size() ? slotOfClient[clientIndex] : -1;
+    }
+
+    // Returns the slot for clientIndex, appending a zeroed player if it has none
+    int Add(uint32_t clientIndex) {
+        int slot = Find(clientIndex);
+        if (slot >= 0)
+            return slot;
+
+        if (clientIndex >= slotOfClient.size())
+            slotOfClient.resize(clientIndex + 1, -1);
+
+        slot = Count();
+        slotOfClient[clientIndex] = slot;
+        ids.push_back(clientIndex);
+        x.push_back(0.0f);
+        y.push_back(0.0f);
+        velX.push_back(0.0f);
+        velY.push_back(0.0f);
+        size.push_back(0.0f);
+        color.push_back(0);
+        return slot;
+    }
+
+    bool Remove(uint32_t clientIndex) {
+        int slot = Find(clientIndex);
+        if (slot < 0)
+            return false;
+
+        int last = Count() - 1;
+        if (slot != last) {
+            ids[slot] = ids[last];
+            x[slot] = x[last];
+            y[slot] = y[last];
+            velX[slot] = velX[last];
+            velY[slot] = velY[last];
+            size[slot] = size[last];
+            color[slot] = color[last];
+            slotOfClient[ids[slot]] = slot;
+        }
+
+        ids.pop_back();
+        x.pop_back();
+        y.pop_back();
+        velX.pop_back();
+        velY.pop_back();
+        size.pop_back();
+        color.pop_back();
+        slotOfClient[clientIndex] = -1;
+        return true;
+    }
+
+    void Clear() {
+        for (uint32_t clientIndex : ids)
+            slotOfClient[clientIndex] = -1;
+        ids.clear();
+        x.clear();
+        y.clear();
+        velX.clear();
+        velY.clear();
+        size.clear();
+        color.clear();
+    }
+
+    Position GetPosition(int slot) const { return Position(x[slot], y[slot]); }
+
+    Player Get(int slot) const {
+        Player player;
+        player.id = ids[slot];
+        player.position = GetPosition(slot);
+        player.velocity = {velX[slot], velY[slot]};
+        player.size = size[slot];
+        player.color = color[slot];
+        return player;
+    }
+
+    void Set(int slot, const Player& player) {
+        ids[slot] = player.id;
+        x[slot] = player.position.x;
+        y[slot] = player.position.y;
+        velX[slot] = player.velocity.x;
+        velY[slot] = player.velocity.y;
+        size[slot] = player.size;
+        color[slot] = player.color;
+    }
+};
+
 struct WorldState {
-    eastl::unordered_map<uint32_t, Player> players;
-    eastl::fixed_vector<FoodItem, 128> foodItems;
+    PlayerTable players;
+    eastl::fixed_vector<FoodItem, MAX_FOOD> foodItems;
+    // Food positions mirrored as flat arrays for the server's SIMD overlap kernel
+    eastl::fixed_vector<float, MAX_FOOD> foodX;
+    eastl::fixed_vector<float, MAX_FOOD> foodY;
     uint32_t serverTick;
     double timestamp;
 
     WorldState() : serverTick(0), timestamp(0.0) {}
 };
 
+// Client copy of the server's food, indexed by food id (the server's slot) and
+// kept current by the FOOD_SYNC, FOOD_SPAWNED and FOOD_EATEN messages
+struct FoodTable {
+    eastl::fixed_vector<FoodItem, MAX_FOOD> items;
+    eastl::fixed_vector<uint8_t, MAX_FOOD> present;
+
+    FoodTable() { Clear(); }
+
+    void Clear() {
+        items.assign(MAX_FOOD, FoodItem());
+        present.assign(MAX_FOOD, 0);
+    }
+
+    bool Has(uint32_t id) const { return id < static_cast<uint32_t>(MAX_FOOD) && present[id] != 0; }
+
+    void Spawn(uint32_t id, const FoodItem& food) {
+        items[id] = food;
+        present[id] = 1;
+    }
+
+    void Remove(uint32_t id) { present[id] = 0; }
+};
+
 enum class GameMessageType {
     WORLD_STATE,
     PLAYER_INPUT,
+    SNAPSHOT_ACK,
+    FOOD_SYNC,
+    FOOD_SPAWNED,
+    FOOD_EATEN,
+    SHARED_SNAPSHOT,
+    PLAYER_INPUT_BATCH,
     COUNT
 };
 
@@ -123,30 +292,148 @@ enum class GameChannel {
     COUNT
 };
 
+// Fixed-point encoding of a bounded float: (value - min) * scale, rounded and
+// clamped to the range. Scales are powers of two so every snapped value is an
+// exact float and Snap(Snap(v)) == Snap(v).
+struct Quantization {
+    float min;
+    float max;
+    float scale;  // Steps per unit, e.g. 8 for 1/8-unit precision
+
+    int32_t MaxIndex() const { return static_cast<int32_t>((max - min) * scale); }
+
+    // Clamped before the cast: out of range values, infinities included, go
+    // to the nearest end and NaN goes to min
+    int32_t Quantize(float value) const {
+        float steps = (value - min) * scale + 0.5f;
+        if (!(steps >= 0.0f)) return 0;
+        if (steps >= static_cast<float>(MaxIndex())) return MaxIndex();
+        return static_cast<int32_t>(std::floor(steps));
+    }
+
+    float Dequantize(int32_t index) const { return min + index / scale; }
+    float Snap(float value) const { return Dequantize(Quantize(value)); }
+};
+
+// Per-field precision of quantized snapshots. Bits on the wire follow from the
+// range: positions 1/8 unit in 15 bits, velocities 1/16 in 13, size 1/16 in 16.
+static const Quantization POSITION_X_QUANTIZATION = {0.0f, static_cast<float>(WORLD_WIDTH), 8.0f};
+static const Quantization POSITION_Y_QUANTIZATION = {0.0f, static_cast<float>(WORLD_HEIGHT), 8.0f};
+static const Quantization VELOCITY_QUANTIZATION = {-PLAYER_MOVE_SPEED, PLAYER_MOVE_SPEED, 16.0f};
+static const Quantization SIZE_QUANTIZATION = {0.0f, MAX_PLAYER_SIZE, 16.0f};
+
+// Move axes of batched inputs, 1/64 in 8 bits. Clients snap their input with it
+// before predicting, so the server replays exactly what the client did.
+static const Quantization MOVE_AXIS_QUANTIZATION = {-1.0f, 1.0f, 64.0f};
+
+template <typename Stream>
+bool SerializeQuantized(Stream& stream, float& value, const Quantization& quantization) {
+    int32_t index = 0;
+    if (Stream::IsWriting)
+        index = quantization.Quantize(value);
+    serialize_int(stream, index, 0, quantization.MaxIndex());
+    if (Stream::IsReading)
+        value = quantization.Dequantize(index);
+    return true;
+}
+
+#define serialize_quantized(stream, value, quantization) \
+    do { if (!SerializeQuantized(stream, value, quantization)) return false; } while (0)
+
+// Quantized when `quantize` is set, a raw 32-bit float otherwise
+#define serialize_snapshot_float(stream, value, quantization, quantize) \
+    do { \
+        if (quantize) serialize_quantized(stream, value, quantization); \
+        else serialize_float(stream, value); \
+    } while (0)
+
+// Bits of WorldStateMessage::playerChanged, one per field sent in a delta
+static const uint8_t PLAYER_CHANGED_X = 1 << 0;
+static const uint8_t PLAYER_CHANGED_Y = 1 << 1;
+static const uint8_t PLAYER_CHANGED_VEL_X = 1 << 2;
+static const uint8_t PLAYER_CHANGED_VEL_Y = 1 << 3;
+static const uint8_t PLAYER_CHANGED_SIZE = 1 << 4;
+static const uint8_t PLAYER_CHANGED_COLOR = 1 << 5;
+static const int PLAYER_CHANGED_BITS = 6;
+static const uint8_t PLAYER_CHANGED_ALL = (1 << PLAYER_CHANGED_BITS) - 1;
+
+// A full snapshot (baselineTick == 0) carries every field. A delta snapshot
+// only carries the player fields flagged in playerChanged; everything else is
+// copied from the snapshot with tick baselineTick, which the client has
+// acknowledged. Server ticks start at 1, so 0 never names a real baseline.
+// Either way a snapshot lists exactly the players inside the client's area of
+// interest, and anything absent is gone from its view. Food is not part of
+// snapshots; it is replicated by the reliable FOOD_* messages below.
+// See common/snapshot.hpp.
 struct WorldStateMessage : public yojimbo::Message {
 
     // Server tick and timestamp for interpolation/prediction
     uint32_t serverTick;
     double timestamp;
     uint32_t lastProcessedInputSeq;  // Last input sequence server processed for this client
+    uint32_t baselineTick;           // Snapshot this one is a delta against, 0 for a full snapshot
+    bool quantized;                  // Fields use the *_QUANTIZATION encodings instead of raw floats
 
-    // Fixed arrays (better for games)
+    // Player arrays are sized per snapshot and carved out of one block from the
+    // connection's allocator, so message memory follows the live player count
     uint16_t numPlayers;
-    uint32_t playerIds[MAX_PLAYERS];
-    float playerX[MAX_PLAYERS];
-    float playerY[MAX_PLAYERS];
-    float playerVelX[MAX_PLAYERS];
-    float playerVelY[MAX_PLAYERS];
-    float playerSize[MAX_PLAYERS];
-    uint32_t playerColor[MAX_PLAYERS];
+    uint32_t* playerIds;
+    float* playerX;
+    float* playerY;
+    float* playerVelX;
+    float* playerVelY;
+    float* playerSize;
+    uint32_t* playerColor;
+    uint8_t* playerChanged;  // PLAYER_CHANGED_* bits, all set in a full snapshot
+
+    explicit WorldStateMessage(yojimbo::Allocator& allocator)
+        : serverTick(0), timestamp(0.0), lastProcessedInputSeq(0), baselineTick(0), quantized(false), numPlayers(0),
+          playerIds(nullptr), playerX(nullptr), playerY(nullptr), playerVelX(nullptr),
+          playerVelY(nullptr), playerSize(nullptr), playerColor(nullptr), playerChanged(nullptr),
+          m_allocator(&allocator), m_playerBlock(nullptr), m_playerCapacity(0) {}
+
+    ~WorldStateMessage() {
+        YOJIMBO_FREE(*m_allocator, m_playerBlock);
+    }
 
-    uint16_t numFoodItems;
-    float foodX[MAX_FOOD];
-    float foodY[MAX_FOOD];
-    uint8_t foodTier[MAX_FOOD];  // Only 2 bits needed: 0=SMALL, 1=MEDIUM, 2=LARGE
-    // NOTE: color and value are generated client-side from tier (saves 8 bytes per food!)
+    // Seven 32-bit fields and the changed bits per player
+    static size_t GetPlayerBlockBytes(int count) { return 7 * count * sizeof(uint32_t) + count; }
+
+    // Sizes the player section for `count` players. Returns false when the
+    // connection's allocator is out of memory.
+    bool AllocatePlayers(int count) {
+        YOJIMBO_FREE(*m_allocator, m_playerBlock);
+        numPlayers = 0;
+        m_playerCapacity = 0;
+        if (count <= 0)
+            return true;
+
+        m_playerBlock = (uint8_t*)YOJIMBO_ALLOCATE(*m_allocator, GetPlayerBlockBytes(count));
+        if (!m_playerBlock)
+            return false;
+
+        playerIds = reinterpret_cast<uint32_t*>(m_playerBlock);
+        playerX = reinterpret_cast<float*>(playerIds + count);
+        playerY = playerX + count;
+        playerVelX = playerY + count;
+        playerVelY = playerVelX + count;
+        playerSize = playerVelY + count;
+        playerColor = reinterpret_cast<uint32_t*>(playerSize + count);
+        playerChanged = reinterpret_cast<uint8_t*>(playerColor + count);
+        numPlayers = static_cast<uint16_t>(count);
+        m_playerCapacity = count;
+        return true;
+    }
 
-    WorldStateMessage() : serverTick(0), timestamp(0.0), lastProcessedInputSeq(0), numPlayers(0), numFoodItems(0) {}
+    // Uses only the first `count` of the players AllocatePlayers made room
+    // for. Never allocates, so it is safe off the thread that owns the
+    // connection. Returns false if `count` is more than that room.
+    bool SetPlayerCount(int count) {
+        if (count < 0 || count > m_playerCapacity)
+            return false;
+        numPlayers = static_cast<uint16_t>(count);
+        return true;
+    }
 
     template <typename Stream>
     bool Serialize(Stream& stream) {
@@ -155,32 +442,62 @@ struct WorldStateMessage : public yojimbo::Message {
         serialize_double(stream, timestamp);
         serialize_bits(stream, lastProcessedInputSeq, 32);
 
+        bool isDelta = baselineTick != 0;
+        serialize_bool(stream, isDelta);
+        if (isDelta)
+            serialize_bits(stream, baselineTick, 32);
+        else if (Stream::IsReading)
+            baselineTick = 0;
+        serialize_bool(stream, quantized);
+
         // Players
-        serialize_int(stream, numPlayers, 0, MAX_PLAYERS);
-        for (int i = 0; i < numPlayers; ++i) {
-            serialize_bits(stream, playerIds[i], 32);
-            serialize_float(stream, playerX[i]);
-            serialize_float(stream, playerY[i]);
-            serialize_float(stream, playerVelX[i]);
-            serialize_float(stream, playerVelY[i]);
-            serialize_float(stream, playerSize[i]);
-            serialize_bits(stream, playerColor[i], 32);
-        }
+        int playerCount = numPlayers;
+        serialize_int(stream, playerCount, 0, MAX_PLAYER_CAPACITY);
+        if (Stream::IsReading && !AllocatePlayers(playerCount))
+            return false;
 
-        // Food (position + tier - color/value generated client-side from tier)
-        serialize_int(stream, numFoodItems, 0, MAX_FOOD);
-        for (int i = 0; i < numFoodItems; ++i) {
-            serialize_float(stream, foodX[i]);
-            serialize_float(stream, foodY[i]);
-            serialize_int(stream, foodTier[i], 0, 2);  // Only 2 bits for 3 tiers (0, 1, 2)
+        for (int i = 0; i < numPlayers; ++i) {
+            // Ids are client indices
+            serialize_int(stream, playerIds[i], 0, MAX_PLAYER_CAPACITY - 1);
+
+            uint32_t changed = isDelta ? playerChanged[i] : PLAYER_CHANGED_ALL;
+            if (isDelta)
+                serialize_bits(stream, changed, PLAYER_CHANGED_BITS);
+            if (Stream::IsReading)
+                playerChanged[i] = static_cast<uint8_t>(changed);
+
+            if (changed & PLAYER_CHANGED_X)
+                serialize_snapshot_float(stream, playerX[i], POSITION_X_QUANTIZATION, quantized);
+            if (changed & PLAYER_CHANGED_Y)
+                serialize_snapshot_float(stream, playerY[i], POSITION_Y_QUANTIZATION, quantized);
+            if (changed & PLAYER_CHANGED_VEL_X)
+                serialize_snapshot_float(stream, playerVelX[i], VELOCITY_QUANTIZATION, quantized);
+            if (changed & PLAYER_CHANGED_VEL_Y)
+                serialize_snapshot_float(stream, playerVelY[i], VELOCITY_QUANTIZATION, quantized);
+            if (changed & PLAYER_CHANGED_SIZE)
+                serialize_snapshot_float(stream, playerSize[i], SIZE_QUANTIZATION, quantized);
+            if (changed & PLAYER_CHANGED_COLOR)
+                serialize_bits(stream, playerColor[i], 32);
         }
 
         return true;
     }
 
     YOJIMBO_VIRTUAL_SERIALIZE_FUNCTIONS()
+
+private:
+    yojimbo::Allocator* m_allocator;
+    uint8_t* m_playerBlock;
+    int m_playerCapacity;
 };
 
+// Upper bound on a full WorldStateMessage for `maxPlayers`, used to size packets and memory
+inline int EstimateWorldStateBytes(int maxPlayers) {
+    const int HEADER_BYTES = 4 + 8 + 4 + 1 + 4 + 2;
+    const int PLAYER_BYTES = 7 * 4 + 1;
+    return HEADER_BYTES + maxPlayers * PLAYER_BYTES;
+}
+
 struct PlayerInputMessage : public yojimbo::Message {
     uint32_t sequenceNumber;  // Monotonically increasing input sequence
     double timestamp;         // Client timestamp when input was generated
@@ -200,49 +517,405 @@ struct PlayerInputMessage : public yojimbo::Message {
     YOJIMBO_VIRTUAL_SERIALIZE_FUNCTIONS()
 };
 
+// The newest few inputs, oldest first. Every packet repeats the inputs of the
+// previous ones, so a lost packet leaves no gap and the server drops the copies
+// by sequence. Sequences are strictly increasing and sent as deltas.
+struct PlayerInputBatchMessage : public yojimbo::Message {
+    int numInputs;
+    uint32_t sequence[MAX_INPUT_BATCH];
+    float moveX[MAX_INPUT_BATCH];
+    float moveY[MAX_INPUT_BATCH];
+
+    PlayerInputBatchMessage() : numInputs(0) {}
+
+    template <typename Stream>
+    bool Serialize(Stream& stream) {
+        serialize_int(stream, numInputs, 0, MAX_INPUT_BATCH);
+        for (int i = 0; i < numInputs; ++i) {
+            if (i == 0)
+                serialize_bits(stream, sequence[0], 32);
+            else
+                serialize_int_relative(stream, sequence[i - 1], sequence[i]);
+            serialize_quantized(stream, moveX[i], MOVE_AXIS_QUANTIZATION);
+            serialize_quantized(stream, moveY[i], MOVE_AXIS_QUANTIZATION);
+        }
+        return true;
+    }
+
+    YOJIMBO_VIRTUAL_SERIALIZE_FUNCTIONS()
+};
+
+// Tells the server the newest snapshot the client has decoded, so later
+// snapshots can be sent as deltas against it
+struct SnapshotAckMessage : public yojimbo::Message {
+    uint32_t serverTick;
+
+    SnapshotAckMessage() : serverTick(0) {}
+
+    template <typename Stream>
+    bool Serialize(Stream& stream) {
+        serialize_bits(stream, serverTick, 32);
+        return true;
+    }
+
+    YOJIMBO_VIRTUAL_SERIALIZE_FUNCTIONS()
+};
+
+// Per-client header of a snapshot whose body is serialized once per tick and
+// shared by every client. The block holds a full WorldStateMessage as written
+// by WriteMessageBytes; only the fields below differ between clients.
+// See ReadSharedSnapshot in common/snapshot.hpp.
+struct SharedSnapshotMessage : public yojimbo::BlockMessage {
+    uint32_t serverTick;
+    uint32_t lastProcessedInputSeq;
+
+    SharedSnapshotMessage() : serverTick(0), lastProcessedInputSeq(0) {}
+
+    template <typename Stream>
+    bool Serialize(Stream& stream) {
+        serialize_bits(stream, serverTick, 32);
+        serialize_bits(stream, lastProcessedInputSeq, 32);
+        return true;
+    }
+
+    YOJIMBO_VIRTUAL_SERIALIZE_FUNCTIONS()
+};
+
+// Food positions are whole world units, which the position encodings represent
+// exactly, so food messages always use them
+template <typename Stream>
+bool SerializeFoodItem(Stream& stream, float& x, float& y, uint8_t& tier) {
+    serialize_quantized(stream, x, POSITION_X_QUANTIZATION);
+    serialize_quantized(stream, y, POSITION_Y_QUANTIZATION);
+    serialize_int(stream, tier, 0, 2);  // Only 2 bits for 3 tiers (0, 1, 2)
+    return true;
+}
+
+// All food, sent on the reliable channel when a client connects. Ids are the
+// array indices. Color and value are generated client-side from tier.
+struct FoodSyncMessage : public yojimbo::Message {
+    uint16_t numFoodItems;
+    float foodX[MAX_FOOD];
+    float foodY[MAX_FOOD];
+    uint8_t foodTier[MAX_FOOD];
+
+    FoodSyncMessage() : numFoodItems(0) {}
+
+    template <typename Stream>
+    bool Serialize(Stream& stream) {
+        serialize_int(stream, numFoodItems, 0, MAX_FOOD);
+        for (int i = 0; i < numFoodItems; ++i) {
+            if (!SerializeFoodItem(stream, foodX[i], foodY[i], foodTier[i]))
+                return false;
+        }
+        return true;
+    }
+
+    YOJIMBO_VIRTUAL_SERIALIZE_FUNCTIONS()
+};
+
+// A food item appeared in slot foodId, replacing whatever was there
+struct FoodSpawnedMessage : public yojimbo::Message {
+    uint32_t foodId;
+    float x, y;
+    uint8_t tier;
+
+    FoodSpawnedMessage() : foodId(0), x(0.0f), y(0.0f), tier(0) {}
+
+    template <typename Stream>
+    bool Serialize(Stream& stream) {
+        serialize_int(stream, foodId, 0, MAX_FOOD - 1);
+        return SerializeFoodItem(stream, x, y, tier);
+    }
+
+    YOJIMBO_VIRTUAL_SERIALIZE_FUNCTIONS()
+};
+
+// Player playerId ate the food in slot foodId
+struct FoodEatenMessage : public yojimbo::Message {
+    uint32_t foodId;
+    uint32_t playerId;
+
+    FoodEatenMessage() : foodId(0), playerId(0) {}
+
+    template <typename Stream>
+    bool Serialize(Stream& stream) {
+        serialize_int(stream, foodId, 0, MAX_FOOD - 1);
+        serialize_int(stream, playerId, 0, MAX_PLAYER_CAPACITY - 1);
+        return true;
+    }
+
+    YOJIMBO_VIRTUAL_SERIALIZE_FUNCTIONS()
+};
+
 struct GameConnectionConfig : public yojimbo::ClientServerConfig {
-    GameConnectionConfig() {
+    // Packet size and per-connection memory scale with the room's player
+    // capacity. Servers pass their own capacity; clients pass
+    // MAX_PLAYER_CAPACITY so they can receive snapshots from any room.
+    // `serverClientMemory`, if set, replaces the server's per-client estimate
+    // with a measured budget (see RecommendConnectionMemory).
+    explicit GameConnectionConfig(int maxPlayers = DEFAULT_MAX_PLAYERS, int serverClientMemory = 0) {
         numChannels = 2;
         channel[static_cast<int>(GameChannel::RELIABLE)].type = yojimbo::CHANNEL_TYPE_RELIABLE_ORDERED;
         channel[static_cast<int>(GameChannel::UNRELIABLE)].type = yojimbo::CHANNEL_TYPE_UNRELIABLE_UNORDERED;
+
+        // A full snapshot plus room for the reliable channel in one (possibly fragmented) packet
+        const int PACKET_GRANULARITY = 1024;
+        int packetBytes = 2 * EstimateWorldStateBytes(maxPlayers);
+        packetBytes = (packetBytes + PACKET_GRANULARITY - 1) / PACKET_GRANULARITY * PACKET_GRANULARITY;
+        if (packetBytes > maxPacketSize)
+            maxPacketSize = packetBytes;
+        maxPacketFragments = (maxPacketSize + packetFragmentSize - 1) / packetFragmentSize;
+
+        // Channel queues and endpoint state, plus a full reassembly buffer of snapshot-sized packets
+        const int BASE_CONNECTION_MEMORY = 8 * 1024 * 1024;
+        serverPerClientMemory = BASE_CONNECTION_MEMORY + packetReassemblyBufferSize * maxPacketSize;
+        clientMemory = serverPerClientMemory;
+        if (serverClientMemory > 0)
+            serverPerClientMemory = serverClientMemory;
     }
 };
 
-// the message factory
-YOJIMBO_MESSAGE_FACTORY_START(GameMessageFactory, (int)GameMessageType::COUNT);
-    YOJIMBO_DECLARE_MESSAGE_TYPE((int)GameMessageType::WORLD_STATE, WorldStateMessage);
-    YOJIMBO_DECLARE_MESSAGE_TYPE((int)GameMessageType::PLAYER_INPUT, PlayerInputMessage);
-YOJIMBO_MESSAGE_FACTORY_FINISH();
+// The message factory. Written out rather than generated with the
+// YOJIMBO_MESSAGE_FACTORY macros because WorldStateMessage needs the
+// allocator it was created from to size its player section.
+// Hot messages are created and released for every client on every tick, so
+// each factory serves them from a MessagePoolAllocator: the small class holds
+// any message object short of a FoodSyncMessage, the large one a player
+// section for a full room.
+static const size_t MESSAGE_POOL_SMALL_BYTES = 256;
+static const int MESSAGE_POOL_SMALL_SLOTS = 64;
+static const size_t MESSAGE_POOL_LARGE_BYTES = WorldStateMessage::GetPlayerBlockBytes(MAX_PLAYER_CAPACITY);
+static const int MESSAGE_POOL_LARGE_SLOTS = 16;
+
+// Initialized ahead of the MessageFactory base, which is given the pool as its allocator
+struct GameMessagePoolBase {
+    MessagePoolAllocator m_messagePool;
+
+    GameMessagePoolBase(yojimbo::Allocator& allocator, MessagePoolStats* sharedStats)
+        : m_messagePool(allocator, MESSAGE_POOL_SMALL_BYTES, MESSAGE_POOL_SMALL_SLOTS, MESSAGE_POOL_LARGE_BYTES,
+                        MESSAGE_POOL_LARGE_SLOTS, sharedStats) {}
+};
+
+class GameMessageFactory : private GameMessagePoolBase, public yojimbo::MessageFactory {
+public:
+    // `sharedStats`, if given, totals the pool counters of several factories
+    explicit GameMessageFactory(yojimbo::Allocator& allocator, MessagePoolStats* sharedStats = nullptr)
+        : GameMessagePoolBase(allocator, sharedStats), MessageFactory(m_messagePool, (int)GameMessageType::COUNT) {}
+
+    const MessagePoolStats& GetPoolStats() const { return m_messagePool.GetStats(); }
+
+    yojimbo::Message* CreateMessageInternal(int type) override {
+        yojimbo::Allocator& allocator = GetAllocator();
+        yojimbo::Message* message = nullptr;
+
+        switch (type) {
+            case (int)GameMessageType::WORLD_STATE:
+                message = YOJIMBO_NEW(allocator, WorldStateMessage, allocator);
+                break;
+            case (int)GameMessageType::PLAYER_INPUT:
+                message = YOJIMBO_NEW(allocator, PlayerInputMessage, );
+                break;
+            case (int)GameMessageType::SNAPSHOT_ACK:
+                message = YOJIMBO_NEW(allocator, SnapshotAckMessage, );
+                break;
+            case (int)GameMessageType::FOOD_SYNC:
+                message = YOJIMBO_NEW(allocator, FoodSyncMessage, );
+                break;
+            case (int)GameMessageType::FOOD_SPAWNED:
+                message = YOJIMBO_NEW(allocator, FoodSpawnedMessage, );
+                break;
+            case (int)GameMessageType::FOOD_EATEN:
+                message = YOJIMBO_NEW(allocator, FoodEatenMessage, );
+                break;
+            case (int)GameMessageType::SHARED_SNAPSHOT:
+                message = YOJIMBO_NEW(allocator, SharedSnapshotMessage, );
+                break;
+            case (int)GameMessageType::PLAYER_INPUT_BATCH:
+                message = YOJIMBO_NEW(allocator, PlayerInputBatchMessage, );
+                break;
+            default:
+                return nullptr;
+        }
 
+        if (!message)
+            return nullptr;
+
+        SetMessageType(message, type);
+        return message;
+    }
+};
 
 class GameAdapter : public yojimbo::Adapter {
 public:
-    explicit GameAdapter(GameServer* server) : m_server(server) {}
+    explicit GameAdapter(GameServer* server)
+        : m_server(server), m_loopback(nullptr), m_poolStats(), m_blockCount(0), m_bound(false) {
+        for (int& block : m_clientBlock)
+            block = -1;
+    }
 
     yojimbo::MessageFactory* CreateMessageFactory(yojimbo::Allocator& allocator) override {
-        return YOJIMBO_NEW(allocator, GameMessageFactory, allocator);
+        return YOJIMBO_NEW(allocator, GameMessageFactory, allocator, &m_poolStats);
+    }
+
+    // BaseServer::Start creates the global allocator and one per client slot.
+    // Which is which is not known here: the server names each slot's
+    // allocator afterwards by a block allocated from it (BindClientMemory).
+    yojimbo::Allocator* CreateAllocator(yojimbo::Allocator& allocator, void* memory, size_t bytes) override {
+        if (m_bound) {
+            // A new Start: the previous allocators are gone
+            m_blockCount = 0;
+            m_bound = false;
+            for (int& block : m_clientBlock)
+                block = -1;
+        }
+        yojimbo_assert(m_blockCount < MAX_PLAYER_CAPACITY + 1);
+        ConnectionMemoryBlock& block = m_blocks[m_blockCount++];
+        block.memory = static_cast<const uint8_t*>(memory);
+        block.bytes = bytes;
+        block.stats = ConnectionMemoryStats();
+        block.allocator = YOJIMBO_NEW(allocator, BudgetedAllocator, memory, bytes, block.stats);
+        return block.allocator;
+    }
+
+    // Slots are bound between these two: a block allocated from the slot's
+    // allocator names it, and the counters are put back to what they were
+    // before those blocks, once all are freed
+    void BeginClientMemoryBinding() {
+        for (int i = 0; i < m_blockCount; ++i)
+            m_savedStats[i] = m_blocks[i].stats;
+    }
+    void EndClientMemoryBinding() {
+        for (int i = 0; i < m_blockCount; ++i)
+            m_blocks[i].stats = m_savedStats[i];
+        m_bound = true;
+    }
+
+    // Slot `clientIndex` is the allocator whose memory holds `p`
+    bool BindClientMemory(int clientIndex, const void* p) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(p);
+        for (int i = 0; i < m_blockCount; ++i) {
+            if (bytes >= m_blocks[i].memory && bytes < m_blocks[i].memory + m_blocks[i].bytes) {
+                m_clientBlock[clientIndex] = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Message pool counters of every client connection together
+    const MessagePoolStats& GetPoolStats() const { return m_poolStats; }
+    const ConnectionMemoryStats& GetClientMemoryStats(int clientIndex) const {
+        const int block = m_clientBlock[clientIndex];
+        return block >= 0 ? m_blocks[block].stats : m_noMemory;
+    }
+    // The one allocator no slot is bound to
+    const ConnectionMemoryStats& GetGlobalMemoryStats() const {
+        for (int i = 0; i < m_blockCount; ++i) {
+            bool bound = false;
+            for (int block : m_clientBlock)
+                bound = bound || block == i;
+            if (!bound)
+                return m_blocks[i].stats;
+        }
+        return m_noMemory;
+    }
+
+    // A failed allocation leaves the slot's allocator in an error state, and
+    // BaseServer drops whoever holds the slot while it lasts. Cleared when a
+    // client leaves and when the next one arrives.
+    void ClearClientMemoryError(int clientIndex) {
+        const int block = m_clientBlock[clientIndex];
+        if (block >= 0)
+            m_blocks[block].allocator->ClearError();
     }
 
     void OnServerClientConnected(int clientIndex) override;
     void OnServerClientDisconnected(int clientIndex) override;
 
+    void SetLoopback(LoopbackNetwork* loopback) { m_loopback = loopback; }
+    void ServerSendLoopbackPacket(int clientIndex, const uint8_t* packetData, int packetBytes,
+                                  uint64_t packetSequence) override {
+        if (m_loopback)
+            m_loopback->SendToClient(clientIndex, packetData, packetBytes, packetSequence);
+    }
+
 private:
+    // One allocator BaseServer::Start had this adapter create
+    struct ConnectionMemoryBlock {
+        const uint8_t* memory = nullptr;
+        size_t bytes = 0;
+        BudgetedAllocator* allocator = nullptr; // Owned by BaseServer
+        ConnectionMemoryStats stats;
+    };
+
     GameServer* m_server;
+    LoopbackNetwork* m_loopback;
+    MessagePoolStats m_poolStats;
+
+    ConnectionMemoryBlock m_blocks[MAX_PLAYER_CAPACITY + 1];
+    ConnectionMemoryStats m_savedStats[MAX_PLAYER_CAPACITY + 1];
+    int m_blockCount;
+    int m_clientBlock[MAX_PLAYER_CAPACITY]; // Index into m_blocks, or -1 before binding
+    bool m_bound;
+    ConnectionMemoryStats m_noMemory;
 };
 
 class ClientAdapter : public yojimbo::Adapter {
 public:
-    ClientAdapter() {}
+    ClientAdapter() : m_loopback(nullptr) {}
 
     yojimbo::MessageFactory* CreateMessageFactory(yojimbo::Allocator& allocator) override {
         return YOJIMBO_NEW(allocator, GameMessageFactory, allocator);
     }
+
+    void SetLoopback(LoopbackNetwork* loopback) { m_loopback = loopback; }
+    void ClientSendLoopbackPacket(int clientIndex, const uint8_t* packetData, int packetBytes,
+                                  uint64_t packetSequence) override {
+        if (m_loopback)
+            m_loopback->SendToServer(clientIndex, packetData, packetBytes, packetSequence);
+    }
+
+private:
+    LoopbackNetwork* m_loopback;
 };
 
 // ===========================
 // Prediction & Interpolation Structures
 // ===========================
 
+// One movement step for a single input. The server simulation and every
+// client's prediction call this, so replays match the server exactly. With
+// `quantize` the result is snapped to the snapshot encoding after every step,
+// which is what the server does when it sends quantized snapshots.
+inline void StepPlayerMovement(float& x, float& y, float& velX, float& velY, float moveX, float moveY, float dt,
+                               bool quantize) {
+    float length = std::sqrt(moveX * moveX + moveY * moveY);
+    if (length > 0.0f) {
+        moveX /= length;
+        moveY /= length;
+    }
+
+    velX = moveX * PLAYER_MOVE_SPEED;
+    velY = moveY * PLAYER_MOVE_SPEED;
+
+    x += velX * dt;
+    y += velY * dt;
+
+    // Clamp to world bounds
+    if (x < 0.0f) x = 0.0f;
+    if (x > WORLD_WIDTH) x = WORLD_WIDTH;
+    if (y < 0.0f) y = 0.0f;
+    if (y > WORLD_HEIGHT) y = WORLD_HEIGHT;
+
+    if (quantize) {
+        x = POSITION_X_QUANTIZATION.Snap(x);
+        y = POSITION_Y_QUANTIZATION.Snap(y);
+        velX = VELOCITY_QUANTIZATION.Snap(velX);
+        velY = VELOCITY_QUANTIZATION.Snap(velY);
+    }
+}
+
 // Stored input for client-side prediction and server reconciliation
 struct StoredInput {
     uint32_t sequenceNumber;
@@ -255,6 +928,21 @@ struct StoredInput {
         : sequenceNumber(seq), timestamp(ts), moveX(mx), moveY(my) {}
 };
 
+// Fills `message` with the newest `batchSize` entries of the input history
+inline void FillInputBatch(PlayerInputBatchMessage& message, const eastl::deque<StoredInput>& history, int batchSize) {
+    if (batchSize > MAX_INPUT_BATCH) batchSize = MAX_INPUT_BATCH;
+    if (batchSize > static_cast<int>(history.size())) batchSize = static_cast<int>(history.size());
+
+    message.numInputs = batchSize;
+    int first = static_cast<int>(history.size()) - batchSize;
+    for (int i = 0; i < batchSize; ++i) {
+        const StoredInput& input = history[first + i];
+        message.sequence[i] = input.sequenceNumber;
+        message.moveX[i] = input.moveX;
+        message.moveY[i] = input.moveY;
+    }
+}
+
 // Stored player state for prediction
 struct StoredPlayerState {
     Position position;
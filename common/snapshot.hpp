@@ -0,0 +1,266 @@
+#pragma once
+#include "protocol.hpp"
+#include <algorithm>
+
+// How many recent snapshots each side keeps as delta baselines. The server
+// only deltas against an ack younger than this, which the client is then
+// guaranteed to still hold.
+static const int SNAPSHOT_HISTORY_SIZE = 32;
+
+// The world as one client sees it at one server tick: what the server sent,
+// or what the client decoded. Players are looked up by id through PlayerTable.
+struct SnapshotState {
+    uint32_t serverTick;
+    double timestamp;
+    PlayerTable players;
+
+    SnapshotState() : serverTick(0), timestamp(0.0) {}
+
+    // Copies every player, as seen by a client with no interest filtering
+    void CopyFrom(const WorldState& world) {
+        serverTick = world.serverTick;
+        timestamp = world.timestamp;
+        players = world.players;
+    }
+};
+
+// Ring of the last SNAPSHOT_HISTORY_SIZE snapshots, indexed by tick
+class SnapshotHistory {
+public:
+    SnapshotHistory() : m_states(SNAPSHOT_HISTORY_SIZE) {}
+
+    // Claims the slot for `tick`, overwriting whatever older snapshot was there
+    SnapshotState& Insert(uint32_t tick) {
+        SnapshotState& state = m_states[tick % SNAPSHOT_HISTORY_SIZE];
+        state.serverTick = tick;
+        return state;
+    }
+
+    const SnapshotState* Find(uint32_t tick) const {
+        if (tick == 0)
+            return nullptr;
+        const SnapshotState& state = m_states[tick % SNAPSHOT_HISTORY_SIZE];
+        return state.serverTick == tick ? &state : nullptr;
+    }
+
+    void Clear() {
+        for (SnapshotState& state : m_states)
+            state.serverTick = 0;
+    }
+
+private:
+    eastl::vector<SnapshotState> m_states;
+};
+
+// PLAYER_CHANGED_* bits of player `slot` in `current` against slot `old` of
+// `baseline`, comparing floats bit for bit
+inline uint8_t GetPlayerChanges(const PlayerTable& current, int slot, const PlayerTable& baseline, int old) {
+    uint8_t changed = 0;
+    if (memcmp(&current.x[slot], &baseline.x[old], sizeof(float)) != 0) changed |= PLAYER_CHANGED_X;
+    if (memcmp(&current.y[slot], &baseline.y[old], sizeof(float)) != 0) changed |= PLAYER_CHANGED_Y;
+    if (memcmp(&current.velX[slot], &baseline.velX[old], sizeof(float)) != 0) changed |= PLAYER_CHANGED_VEL_X;
+    if (memcmp(&current.velY[slot], &baseline.velY[old], sizeof(float)) != 0) changed |= PLAYER_CHANGED_VEL_Y;
+    if (memcmp(&current.size[slot], &baseline.size[old], sizeof(float)) != 0) changed |= PLAYER_CHANGED_SIZE;
+    if (current.color[slot] != baseline.color[old]) changed |= PLAYER_CHANGED_COLOR;
+    return changed;
+}
+
+// Bits WorldStateMessage::Serialize spends before the first player
+inline int GetSnapshotHeaderBits(bool isDelta) {
+    return 32 + 64 + 32 + 1 + (isDelta ? 32 : 0) + 1 + serialize::bits_required(0, MAX_PLAYER_CAPACITY);
+}
+
+// Bits WorldStateMessage::Serialize spends on one player sending `changed`
+inline int GetPlayerEntryBits(uint8_t changed, bool isDelta, bool quantized) {
+    auto fieldBits = [quantized](const Quantization& quantization) {
+        return quantized ? serialize::bits_required(0, quantization.MaxIndex()) : 32;
+    };
+    int bits = serialize::bits_required(0, MAX_PLAYER_CAPACITY - 1);
+    if (isDelta)
+        bits += PLAYER_CHANGED_BITS;
+    else
+        changed = PLAYER_CHANGED_ALL;
+    if (changed & PLAYER_CHANGED_X) bits += fieldBits(POSITION_X_QUANTIZATION);
+    if (changed & PLAYER_CHANGED_Y) bits += fieldBits(POSITION_Y_QUANTIZATION);
+    if (changed & PLAYER_CHANGED_VEL_X) bits += fieldBits(VELOCITY_QUANTIZATION);
+    if (changed & PLAYER_CHANGED_VEL_Y) bits += fieldBits(VELOCITY_QUANTIZATION);
+    if (changed & PLAYER_CHANGED_SIZE) bits += fieldBits(SIZE_QUANTIZATION);
+    if (changed & PLAYER_CHANGED_COLOR) bits += 32;
+    return bits;
+}
+
+// Fills the snapshot section of `message` from `current`. With a baseline the
+// message becomes a delta that only carries what differs from it; fields are
+// compared bit for bit so the client rebuilds exactly `current`. The player
+// section must already be allocated for current.players.Count() players.
+inline void WriteSnapshot(WorldStateMessage& message, const SnapshotState& current, const SnapshotState* baseline) {
+    message.serverTick = current.serverTick;
+    message.timestamp = current.timestamp;
+    message.baselineTick = baseline ? baseline->serverTick : 0;
+
+    const PlayerTable& players = current.players;
+    int numPlayers = players.Count();
+    if (numPlayers > 0) {
+        // Player storage already matches the message layout, so each field is one block copy
+        memcpy(message.playerIds, players.ids.data(), numPlayers * sizeof(uint32_t));
+        memcpy(message.playerX, players.x.data(), numPlayers * sizeof(float));
+        memcpy(message.playerY, players.y.data(), numPlayers * sizeof(float));
+        memcpy(message.playerVelX, players.velX.data(), numPlayers * sizeof(float));
+        memcpy(message.playerVelY, players.velY.data(), numPlayers * sizeof(float));
+        memcpy(message.playerSize, players.size.data(), numPlayers * sizeof(float));
+        memcpy(message.playerColor, players.color.data(), numPlayers * sizeof(uint32_t));
+    }
+
+    for (int i = 0; i < numPlayers; ++i) {
+        int old = baseline ? baseline->players.Find(players.ids[i]) : -1;
+        if (old < 0) {
+            message.playerChanged[i] = PLAYER_CHANGED_ALL;
+            continue;
+        }
+
+        message.playerChanged[i] = GetPlayerChanges(players, i, baseline->players, old);
+    }
+}
+
+// Rebuilds the full snapshot carried by `message` into `out`. `baseline` must be
+// the snapshot named by message.baselineTick (nullptr for a full snapshot).
+// Returns false when a delta references state the baseline does not have.
+inline bool ReadSnapshot(const WorldStateMessage& message, const SnapshotState* baseline, SnapshotState& out) {
+    bool isDelta = message.baselineTick != 0;
+    if (isDelta && (!baseline || baseline->serverTick != message.baselineTick))
+        return false;
+
+    out.serverTick = message.serverTick;
+    out.timestamp = message.timestamp;
+
+    // Rebuilt from scratch so players missing from this snapshot drop out
+    PlayerTable& players = out.players;
+    players.Clear();
+
+    for (int i = 0; i < message.numPlayers; ++i) {
+        uint8_t changed = message.playerChanged[i];
+        int old = -1;
+        if (changed != PLAYER_CHANGED_ALL) {
+            old = isDelta ? baseline->players.Find(message.playerIds[i]) : -1;
+            if (old < 0)
+                return false;
+        }
+
+        const PlayerTable* before = old >= 0 ? &baseline->players : nullptr;
+        int slot = players.Add(message.playerIds[i]);
+        players.x[slot] = (changed & PLAYER_CHANGED_X) ? message.playerX[i] : before->x[old];
+        players.y[slot] = (changed & PLAYER_CHANGED_Y) ? message.playerY[i] : before->y[old];
+        players.velX[slot] = (changed & PLAYER_CHANGED_VEL_X) ? message.playerVelX[i] : before->velX[old];
+        players.velY[slot] = (changed & PLAYER_CHANGED_VEL_Y) ? message.playerVelY[i] : before->velY[old];
+        players.size[slot] = (changed & PLAYER_CHANGED_SIZE) ? message.playerSize[i] : before->size[old];
+        players.color[slot] = (changed & PLAYER_CHANGED_COLOR) ? message.playerColor[i] : before->color[old];
+    }
+
+    return true;
+}
+
+// Serializes `message` on its own into `buffer`, so the same bytes can be sent
+// to many clients. `capacity` must be a multiple of 4 and large enough for the
+// message (the bit writer asserts rather than failing). Returns the byte count,
+// rounded up to whole 32-bit words so readers never run past it, or 0 on error.
+inline int WriteMessageBytes(yojimbo::Message& message, uint8_t* buffer, int capacity) {
+    yojimbo::WriteStream stream(buffer, capacity);
+    if (!message.SerializeInternal(stream))
+        return 0;
+    stream.Flush();
+    return (stream.GetBytesProcessed() + 3) & ~3;
+}
+
+// Decodes the shared body of `header` into `body`, which then reads like any
+// other full snapshot. Returns false when the block is missing or corrupt.
+inline bool ReadSharedSnapshot(const SharedSnapshotMessage& header, WorldStateMessage& body) {
+    const uint8_t* data = header.GetBlockData();
+    int bytes = header.GetBlockSize();
+    if (!data || bytes <= 0 || bytes % 4 != 0)
+        return false;
+
+    yojimbo::ReadStream stream(data, bytes);
+    if (!body.SerializeInternal(stream))
+        return false;
+    if (body.serverTick != header.serverTick || body.baselineTick != 0)
+        return false;
+
+    body.lastProcessedInputSeq = header.lastProcessedInputSeq;
+    return true;
+}
+
+// Ticks between two snapshots to one client at `snapshotRate` per second,
+// rounded to the nearest whole tick. Rates at or above TICK_RATE send every tick.
+inline int GetSnapshotInterval(int snapshotRate) {
+    if (snapshotRate <= 0 || snapshotRate >= TICK_RATE)
+        return 1;
+    return (TICK_RATE + snapshotRate / 2) / snapshotRate;
+}
+
+// Whether client `clientIndex` is due a snapshot on `tick`. Clients are offset
+// by their index, so each tick only serializes about 1/interval of them.
+inline bool IsSnapshotTick(uint32_t tick, int clientIndex, int interval) {
+    return (tick + static_cast<uint32_t>(clientIndex)) % static_cast<uint32_t>(interval) == 0;
+}
+
+// Client-side estimate of the server clock, from the timestamps of received
+// snapshots. Each sample is late by the one-way delay plus jitter, so the
+// offset is smoothed rather than taken as is; only a large jump (a hitch, or
+// the first snapshot) resets it.
+class ServerClock {
+public:
+    ServerClock() : m_offset(0.0), m_synced(false) {}
+
+    void AddSample(double serverTime, double localTime) {
+        const double SMOOTHING = 0.1;
+        const double RESYNC_ERROR = 0.25;
+
+        double offset = serverTime - localTime;
+        if (!m_synced || std::fabs(offset - m_offset) > RESYNC_ERROR) {
+            m_offset = offset;
+            m_synced = true;
+            return;
+        }
+        m_offset += (offset - m_offset) * SMOOTHING;
+    }
+
+    bool IsSynced() const { return m_synced; }
+    double GetServerTime(double localTime) const { return localTime + m_offset; }
+
+private:
+    double m_offset;
+    bool m_synced;
+};
+
+// Client-side estimate of how far apart snapshots arrive, from the server
+// ticks they carry. The server's snapshot rate and congestion scaling both
+// widen the gap, so the render delay follows it instead of a fixed constant.
+// A wider gap is taken at once, so rendering never runs past the newest
+// snapshot; narrower ones are smoothed in.
+class SnapshotSpacing {
+public:
+    SnapshotSpacing() : m_interval(1.0 / DEFAULT_SNAPSHOT_RATE), m_lastTick(0) {}
+
+    void AddSnapshot(uint32_t serverTick) {
+        const double SMOOTHING = 0.1;
+
+        if (m_lastTick != 0 && serverTick > m_lastTick) {
+            double interval = static_cast<double>(serverTick - m_lastTick) / TICK_RATE;
+            if (interval > m_interval)
+                m_interval = interval;
+            else
+                m_interval += (interval - m_interval) * SMOOTHING;
+        }
+        m_lastTick = serverTick;
+    }
+
+    double GetInterval() const { return m_interval; }
+    // Two intervals behind, so one late or lost snapshot still leaves a pair to blend
+    double GetInterpolationDelay() const {
+        return std::max(static_cast<double>(INTERPOLATION_DELAY), INTERPOLATION_INTERVALS * m_interval);
+    }
+
+private:
+    double m_interval;  // Seconds
+    uint32_t m_lastTick;
+};
@@ -0,0 +1,243 @@
+#include "load_client.hpp"
+#include <cmath>
+
+LoadClient::LoadClient(int id, const yojimbo::Address &serverAddress, const GameConnectionConfig &config,
+                       MovementMode mode, double time)
+    : m_id(id),
+      m_serverAddress(serverAddress),
+      m_mode(mode),
+      m_randomState(2654435761u * static_cast<uint32_t>(id + 1)),
+      m_adapter(),
+      m_client(yojimbo::GetDefaultAllocator(), yojimbo::Address("0.0.0.0"), config, m_adapter, time),
+      m_connectStartTime(-1.0),
+      m_connectedTime(-1.0),
+      m_connectReported(false),
+      m_predictedPlayer(),
+      m_isLocalPlayerCreated(false),
+      m_inputSequence(0),
+      m_inputHistory(),
+      m_moveX(0.0f),
+      m_moveY(0.0f),
+      m_nextMovementChange(0.0),
+      m_receivedSnapshots(),
+      m_lastSnapshotTick(0),
+      m_quantizedSnapshots(false),
+      m_snapshotsThisInterval(0),
+      m_inputAckMs()
+{
+}
+
+LoadClient::~LoadClient()
+{
+    m_client.Disconnect();
+}
+
+void LoadClient::Connect(double time)
+{
+    uint64_t clientId;
+    yojimbo_random_bytes((uint8_t *)&clientId, 8);
+
+    m_connectStartTime = time;
+    m_client.InsecureConnect(DEFAULT_PRIVATE_KEY, clientId, m_serverAddress);
+}
+
+void LoadClient::Update(double time)
+{
+    m_client.AdvanceTime(time);
+    m_client.ReceivePackets();
+
+    if (m_client.IsConnected())
+    {
+        if (m_connectedTime < 0.0)
+        {
+            m_connectedTime = time;
+        }
+
+        ProcessMessages(time);
+        SendInput(time);
+    }
+
+    m_client.SendPackets();
+}
+
+void LoadClient::ProcessMessages(double time)
+{
+    for (int channelIndex = 0; channelIndex < (int)GameChannel::COUNT; ++channelIndex)
+    {
+        yojimbo::Message *message;
+        while ((message = m_client.ReceiveMessage(channelIndex)) != nullptr)
+        {
+            if (message->GetType() == (int)GameMessageType::WORLD_STATE)
+            {
+                ReceiveWorldState(static_cast<WorldStateMessage *>(message), time);
+            }
+            else if (message->GetType() == (int)GameMessageType::SHARED_SNAPSHOT)
+            {
+                ReceiveSharedSnapshot(static_cast<SharedSnapshotMessage *>(message), time);
+            }
+            m_client.ReleaseMessage(message);
+        }
+    }
+}
+
+void LoadClient::ReceiveWorldState(WorldStateMessage *message, double time)
+{
+    if (message->serverTick <= m_lastSnapshotTick)
+        return;
+
+    // Decoded and acked exactly like GameClient, so deltas cost the server the same
+    const SnapshotState *baseline = m_receivedSnapshots.Find(message->baselineTick);
+    SnapshotState &state = m_receivedSnapshots.Insert(message->serverTick);
+    if (!ReadSnapshot(*message, baseline, state))
+    {
+        state.serverTick = 0;
+        return;
+    }
+    m_lastSnapshotTick = state.serverTick;
+    m_quantizedSnapshots = message->quantized;
+    m_snapshotsThisInterval++;
+
+    SnapshotAckMessage *ackMessage = (SnapshotAckMessage *)m_client.CreateMessage((int)GameMessageType::SNAPSHOT_ACK);
+    if (ackMessage)
+    {
+        ackMessage->serverTick = state.serverTick;
+        m_client.SendMessage((int)GameChannel::UNRELIABLE, ackMessage);
+    }
+
+    int slot = state.players.Find(static_cast<uint32_t>(m_client.GetClientIndex()));
+    if (slot >= 0)
+    {
+        m_predictedPlayer = state.players.Get(slot);
+        m_isLocalPlayerCreated = true;
+    }
+
+    if (!m_isLocalPlayerCreated)
+        return;
+
+    // Same reconciliation as GameClient: drop acknowledged inputs, replay the rest
+    double ackedInputTime = -1.0;
+    while (!m_inputHistory.empty() && m_inputHistory.front().sequenceNumber <= message->lastProcessedInputSeq)
+    {
+        ackedInputTime = m_inputHistory.front().timestamp;
+        m_inputHistory.pop_front();
+    }
+    if (ackedInputTime >= 0.0)
+    {
+        m_inputAckMs.push_back((time - ackedInputTime) * 1000.0);
+    }
+
+    for (const StoredInput &input : m_inputHistory)
+    {
+        StepPlayerMovement(m_predictedPlayer.position.x, m_predictedPlayer.position.y,
+                           m_predictedPlayer.velocity.x, m_predictedPlayer.velocity.y,
+                           input.moveX, input.moveY, INPUT_STEP_DT, m_quantizedSnapshots);
+    }
+}
+
+void LoadClient::ReceiveSharedSnapshot(SharedSnapshotMessage *message, double time)
+{
+    WorldStateMessage *body = (WorldStateMessage *)m_client.CreateMessage((int)GameMessageType::WORLD_STATE);
+    if (!body)
+        return;
+
+    if (ReadSharedSnapshot(*message, *body))
+    {
+        ReceiveWorldState(body, time);
+    }
+    m_client.ReleaseMessage(body);
+}
+
+void LoadClient::SendInput(double time)
+{
+    if (!m_isLocalPlayerCreated)
+        return;
+
+    float moveX;
+    float moveY;
+    ChooseMovement(time, moveX, moveY);
+
+    // Like GameClient, an idle player sends nothing
+    if (moveX == 0.0f && moveY == 0.0f)
+        return;
+
+    PlayerInputBatchMessage *batchMessage = (PlayerInputBatchMessage *)m_client.CreateMessage((int)GameMessageType::PLAYER_INPUT_BATCH);
+    if (!batchMessage)
+        return;
+
+    moveX = MOVE_AXIS_QUANTIZATION.Snap(moveX);
+    moveY = MOVE_AXIS_QUANTIZATION.Snap(moveY);
+
+    m_inputSequence++;
+    m_inputHistory.push_back(StoredInput(m_inputSequence, time, moveX, moveY));
+    while (m_inputHistory.size() > MAX_INPUT_HISTORY)
+    {
+        m_inputHistory.pop_front();
+    }
+
+    StepPlayerMovement(m_predictedPlayer.position.x, m_predictedPlayer.position.y,
+                       m_predictedPlayer.velocity.x, m_predictedPlayer.velocity.y,
+                       moveX, moveY, INPUT_STEP_DT, m_quantizedSnapshots);
+
+    FillInputBatch(*batchMessage, m_inputHistory, DEFAULT_INPUT_BATCH);
+    m_client.SendMessage((int)GameChannel::UNRELIABLE, batchMessage);
+}
+
+void LoadClient::ChooseMovement(double time, float &moveX, float &moveY)
+{
+    if (m_mode == MovementMode::SCRIPTED)
+    {
+        // One lap every ~6 seconds, offset per client so they spread out
+        const double LAP_SPEED = 1.0;
+        double angle = time * LAP_SPEED + m_id * 0.618;
+        moveX = static_cast<float>(std::cos(angle));
+        moveY = static_cast<float>(std::sin(angle));
+        return;
+    }
+
+    if (time >= m_nextMovementChange)
+    {
+        // 1 in 9 outcomes is (0, 0), i.e. standing still
+        m_moveX = static_cast<float>(static_cast<int>(NextRandom() % 3) - 1);
+        m_moveY = static_cast<float>(static_cast<int>(NextRandom() % 3) - 1);
+        m_nextMovementChange = time + 0.5 + (NextRandom() % 1500) / 1000.0;
+    }
+    moveX = m_moveX;
+    moveY = m_moveY;
+}
+
+uint32_t LoadClient::NextRandom()
+{
+    // xorshift32: per-client and deterministic, so runs with the same client count repeat
+    m_randomState ^= m_randomState << 13;
+    m_randomState ^= m_randomState >> 17;
+    m_randomState ^= m_randomState << 5;
+    return m_randomState;
+}
+
+void LoadClient::SampleInterval(LoadReport &report, double elapsed)
+{
+    if (m_connectedTime >= 0.0 && !m_connectReported)
+    {
+        report.connectMs.Add((m_connectedTime - m_connectStartTime) * 1000.0);
+        m_connectReported = true;
+    }
+
+    for (double ackMs : m_inputAckMs)
+    {
+        report.inputAckMs.Add(ackMs);
+    }
+    m_inputAckMs.clear();
+
+    if (m_client.IsConnected() && elapsed > 0.0)
+    {
+        yojimbo::NetworkInfo info;
+        m_client.GetNetworkInfo(info);
+
+        // yojimbo reports bandwidth in kilobits per second
+        report.snapshotsPerSecond.Add(m_snapshotsThisInterval / elapsed);
+        report.rttMs.Add(info.RTT);
+        report.receivedBytesPerSecond.Add(info.receivedBandwidth * 1000.0 / 8.0);
+        report.sentBytesPerSecond.Add(info.sentBandwidth * 1000.0 / 8.0);
+    }
+    m_snapshotsThisInterval = 0;
+}
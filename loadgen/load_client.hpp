@@ -0,0 +1,71 @@
+#pragma once
+#include <yojimbo.h>
+#include "../common/protocol.hpp"
+#include "../common/snapshot.hpp"
+#include "load_report.hpp"
+#include <EASTL/deque.h>
+
+enum class MovementMode
+{
+    RANDOM,  // Keyboard-like 8-way directions, re-rolled every 0.5-2s, sometimes idle
+    SCRIPTED // Steady circles, each client with its own phase
+};
+
+// One synthetic player. Speaks the same protocol as GameClient and runs the
+// same prediction and reconciliation, but has no window: movement comes from
+// MovementMode instead of the keyboard.
+class LoadClient
+{
+public:
+    LoadClient(int id, const yojimbo::Address &serverAddress, const GameConnectionConfig &config,
+               MovementMode mode, double time);
+    ~LoadClient();
+
+    void Connect(double time);
+    void Update(double time);
+
+    bool IsStarted() const { return m_connectStartTime >= 0.0; }
+    bool IsConnected() const { return m_client.IsConnected(); }
+    // Refused, timed out, or dropped after connecting
+    bool IsFailed() const { return IsStarted() && m_client.IsDisconnected(); }
+    bool HasConnected() const { return m_connectedTime >= 0.0; }
+
+    // Adds this client's per-second samples for the interval since the last call
+    void SampleInterval(LoadReport &report, double elapsed);
+
+private:
+    void ProcessMessages(double time);
+    void ReceiveWorldState(WorldStateMessage *message, double time);
+    void ReceiveSharedSnapshot(SharedSnapshotMessage *message, double time);
+    void SendInput(double time);
+    void ChooseMovement(double time, float &moveX, float &moveY);
+    uint32_t NextRandom();
+
+    int m_id;
+    yojimbo::Address m_serverAddress;
+    MovementMode m_mode;
+    uint32_t m_randomState;
+
+    ClientAdapter m_adapter;
+    yojimbo::Client m_client;
+
+    double m_connectStartTime;
+    double m_connectedTime;
+    bool m_connectReported;
+
+    Player m_predictedPlayer;
+    bool m_isLocalPlayerCreated;
+    uint32_t m_inputSequence;
+    eastl::deque<StoredInput> m_inputHistory;
+
+    float m_moveX;
+    float m_moveY;
+    double m_nextMovementChange;
+
+    SnapshotHistory m_receivedSnapshots;
+    uint32_t m_lastSnapshotTick;
+    bool m_quantizedSnapshots;
+
+    int m_snapshotsThisInterval;
+    eastl::vector<double> m_inputAckMs;
+};
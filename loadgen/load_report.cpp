@@ -0,0 +1,60 @@
+#include "load_report.hpp"
+#include <EASTL/sort.h>
+#include <iomanip>
+
+double SampleSet::Percentile(double percentile)
+{
+    if (m_samples.empty())
+        return 0.0;
+
+    if (!m_sorted)
+    {
+        eastl::sort(m_samples.begin(), m_samples.end());
+        m_sorted = true;
+    }
+
+    // Nearest-rank percentile
+    int rank = static_cast<int>(percentile / 100.0 * m_samples.size() + 0.5);
+    if (rank < 1)
+        rank = 1;
+    if (rank > Count())
+        rank = Count();
+    return m_samples[rank - 1];
+}
+
+static void PrintRow(std::ostream &out, const char *name, SampleSet &samples)
+{
+    out << "  " << std::left << std::setw(22) << name << std::right << std::setw(10) << samples.Count();
+    if (samples.Count() == 0)
+    {
+        out << std::setw(12) << "-" << std::setw(12) << "-" << std::setw(12) << "-" << std::setw(12) << "-" << std::endl;
+        return;
+    }
+    out << std::setw(12) << samples.Percentile(50.0)
+        << std::setw(12) << samples.Percentile(90.0)
+        << std::setw(12) << samples.Percentile(99.0)
+        << std::setw(12) << samples.Percentile(100.0) << std::endl;
+}
+
+void LoadReport::Print(std::ostream &out)
+{
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << std::fixed << std::setprecision(1);
+    out << "Load report: " << clients << " clients, " << connected << " connected, " << failed
+        << " failed, " << duration << "s" << std::endl;
+    out << "  " << std::left << std::setw(22) << "metric" << std::right << std::setw(10) << "samples"
+        << std::setw(12) << "p50" << std::setw(12) << "p90" << std::setw(12) << "p99" << std::setw(12) << "max"
+        << std::endl;
+
+    PrintRow(out, "connect (ms)", connectMs);
+    PrintRow(out, "snapshots/s", snapshotsPerSecond);
+    PrintRow(out, "rtt (ms)", rttMs);
+    PrintRow(out, "input ack (ms)", inputAckMs);
+    PrintRow(out, "received bytes/s", receivedBytesPerSecond);
+    PrintRow(out, "sent bytes/s", sentBytesPerSecond);
+
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <ostream>
+#include <EASTL/vector.h>
+
+// Raw samples of one metric; percentiles are exact, computed once at report time
+class SampleSet
+{
+public:
+    void Add(double value) { m_samples.push_back(value); }
+    int Count() const { return static_cast<int>(m_samples.size()); }
+
+    // Sorts in place, so call after all samples are in
+    double Percentile(double percentile);
+
+private:
+    eastl::vector<double> m_samples;
+    bool m_sorted = false;
+};
+
+// Everything circ_loadgen measures over a run
+struct LoadReport
+{
+    int clients = 0;
+    int connected = 0;
+    int failed = 0;
+    double duration = 0.0;
+
+    SampleSet connectMs;          // InsecureConnect to connected, once per client
+    SampleSet snapshotsPerSecond; // WorldStateMessages received, per client per second
+    SampleSet rttMs;              // yojimbo's smoothed RTT, per client per second
+    SampleSet inputAckMs;         // Input sent to acknowledged in a snapshot, per ack
+    SampleSet receivedBytesPerSecond;
+    SampleSet sentBytesPerSecond;
+
+    void Print(std::ostream &out);
+};
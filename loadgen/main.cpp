@@ -0,0 +1,191 @@
+#include "load_client.hpp"
+#include <yojimbo.h>
+#include <iostream>
+#include <csignal>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+std::atomic<bool> g_running(true);
+
+void signalHandler(int signal)
+{
+    if (signal == SIGINT || signal == SIGTERM)
+    {
+        g_running = false;
+    }
+}
+
+static void PrintUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [address] [port] [clients] [seconds] [random|scripted] [servers]" << std::endl
+              << "  Clients are spread round-robin over `servers` servers on consecutive ports." << std::endl
+              << "  One server room holds at most " << MAX_PLAYER_CAPACITY
+              << " players (yojimbo::MaxClients); larger runs need more servers." << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 2 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0))
+    {
+        PrintUsage(argv[0]);
+        return 0;
+    }
+
+    if (!InitializeYojimbo())
+    {
+        std::cerr << "Failed to initialize yojimbo" << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+
+    const char *serverAddress = "127.0.0.1";
+    uint16_t serverPort = 40000;
+    int clientCount = 16;
+    double duration = 30.0;
+    MovementMode mode = MovementMode::RANDOM;
+    int serverCount = 1;
+
+    if (argc >= 2)
+    {
+        serverAddress = argv[1];
+    }
+    if (argc >= 3)
+    {
+        serverPort = static_cast<uint16_t>(std::atoi(argv[2]));
+    }
+    if (argc >= 4)
+    {
+        clientCount = std::atoi(argv[3]);
+    }
+    if (argc >= 5)
+    {
+        duration = std::atof(argv[4]);
+    }
+    if (argc >= 6 && strcmp(argv[5], "scripted") == 0)
+    {
+        mode = MovementMode::SCRIPTED;
+    }
+    if (argc >= 7)
+    {
+        // Clients are spread round-robin over servers on consecutive ports
+        serverCount = std::atoi(argv[6]);
+        if (serverCount < 1)
+            serverCount = 1;
+    }
+
+    std::cout << "Circ.io load generator" << std::endl;
+    std::cout << "Target: " << serverAddress << ":" << serverPort;
+    if (serverCount > 1)
+    {
+        std::cout << "-" << serverPort + serverCount - 1;
+    }
+    std::cout << ", " << clientCount << " clients, " << duration << "s, "
+              << (mode == MovementMode::SCRIPTED ? "scripted" : "random") << " movement" << std::endl;
+    if (clientCount > MAX_PLAYER_CAPACITY * serverCount)
+    {
+        std::cout << "Warning: " << serverCount << " server(s) hold at most " << MAX_PLAYER_CAPACITY * serverCount
+                  << " players; the rest will be refused. Add servers to spread the load." << std::endl;
+    }
+
+    // Same connection settings as the real client, so packet and memory limits match
+    GameConnectionConfig config(MAX_PLAYER_CAPACITY);
+
+    const double tickRate = 1.0 / TICK_RATE;
+    const int CONNECTS_PER_TICK = 16; // Ramp connections instead of flooding the handshake
+    const double SAMPLE_INTERVAL = 1.0;
+    const double PROGRESS_INTERVAL = 5.0;
+
+    double startTime = yojimbo_time();
+    double time = startTime;
+
+    eastl::vector<std::unique_ptr<LoadClient>> clients;
+    clients.reserve(clientCount);
+    for (int i = 0; i < clientCount; ++i)
+    {
+        yojimbo::Address address(serverAddress, static_cast<uint16_t>(serverPort + i % serverCount));
+        clients.push_back(std::make_unique<LoadClient>(i, address, config, mode, time));
+    }
+
+    LoadReport report;
+    report.clients = clientCount;
+
+    int nextToConnect = 0;
+    double lastSampleTime = startTime;
+    double lastProgressTime = startTime;
+
+    // One loop drives every client at the server tick rate
+    while (g_running && time - startTime < duration)
+    {
+        for (int i = 0; i < CONNECTS_PER_TICK && nextToConnect < clientCount; ++i)
+        {
+            clients[nextToConnect++]->Connect(time);
+        }
+
+        for (auto &client : clients)
+        {
+            if (client->IsStarted())
+            {
+                client->Update(time);
+            }
+        }
+
+        if (time - lastSampleTime >= SAMPLE_INTERVAL)
+        {
+            for (auto &client : clients)
+            {
+                client->SampleInterval(report, time - lastSampleTime);
+            }
+            lastSampleTime = time;
+        }
+
+        if (time - lastProgressTime >= PROGRESS_INTERVAL)
+        {
+            int connected = 0;
+            for (auto &client : clients)
+            {
+                if (client->IsConnected())
+                    connected++;
+            }
+            std::cout << "t=" << static_cast<int>(time - startTime) << "s: " << connected << "/" << clientCount
+                      << " connected" << std::endl;
+            lastProgressTime = time;
+        }
+
+        time += tickRate;
+        double currentTime = yojimbo_time();
+        if (time > currentTime)
+        {
+            yojimbo_sleep(time - currentTime);
+        }
+        else if (currentTime - time > tickRate * 10)
+        {
+            // The loop itself cannot keep up; report it rather than silently skewing the numbers
+            std::cerr << "Load generator is " << (currentTime - time) * 1000.0 << "ms behind" << std::endl;
+            time = currentTime;
+        }
+    }
+
+    // A short final interval only contributes connect and ack samples, not rates
+    double lastInterval = time - lastSampleTime;
+    if (lastInterval < SAMPLE_INTERVAL * 0.5)
+        lastInterval = 0.0;
+
+    for (auto &client : clients)
+    {
+        client->SampleInterval(report, lastInterval);
+        if (client->IsConnected())
+            report.connected++;
+        else if (client->IsFailed())
+            report.failed++;
+    }
+    report.duration = time - startTime;
+    report.Print(std::cout);
+
+    clients.clear();
+    ShutdownYojimbo();
+    return 0;
+}
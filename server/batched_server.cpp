@@ -0,0 +1,349 @@
+#include "batched_server.hpp"
+
+#if CIRC_BATCHED_TRANSPORT
+#include <cstring>
+#include <arpa/inet.h>
+#include <netcode.h>
+#include <reliable.h>
+
+// netcode keeps IPv4 octets in network order and IPv6 groups in host order
+static void ToSocketAddress(const netcode_address_t &address, sockaddr_storage &out)
+{
+    memset(&out, 0, sizeof(out));
+    if (address.type == NETCODE_ADDRESS_IPV6)
+    {
+        sockaddr_in6 &ipv6 = reinterpret_cast<sockaddr_in6 &>(out);
+        ipv6.sin6_family = AF_INET6;
+        ipv6.sin6_port = htons(address.port);
+        for (int i = 0; i < 8; ++i)
+        {
+            uint16_t group = htons(address.data.ipv6[i]);
+            memcpy(&ipv6.sin6_addr.s6_addr[i * 2], &group, sizeof(group));
+        }
+    }
+    else
+    {
+        sockaddr_in &ipv4 = reinterpret_cast<sockaddr_in &>(out);
+        ipv4.sin_family = AF_INET;
+        ipv4.sin_port = htons(address.port);
+        memcpy(&ipv4.sin_addr.s_addr, address.data.ipv4, 4);
+    }
+}
+
+static void FromSocketAddress(const sockaddr_storage &address, netcode_address_t &out)
+{
+    memset(&out, 0, sizeof(out));
+    if (address.ss_family == AF_INET6)
+    {
+        const sockaddr_in6 &ipv6 = reinterpret_cast<const sockaddr_in6 &>(address);
+        out.type = NETCODE_ADDRESS_IPV6;
+        out.port = ntohs(ipv6.sin6_port);
+        for (int i = 0; i < 8; ++i)
+        {
+            uint16_t group;
+            memcpy(&group, &ipv6.sin6_addr.s6_addr[i * 2], sizeof(group));
+            out.data.ipv6[i] = ntohs(group);
+        }
+    }
+    else
+    {
+        const sockaddr_in &ipv4 = reinterpret_cast<const sockaddr_in &>(address);
+        out.type = NETCODE_ADDRESS_IPV4;
+        out.port = ntohs(ipv4.sin_port);
+        memcpy(out.data.ipv4, &ipv4.sin_addr.s_addr, 4);
+    }
+}
+
+static void ToSocketAddress(const yojimbo::Address &address, sockaddr_storage &out)
+{
+    netcode_address_t netcodeAddress;
+    memset(&netcodeAddress, 0, sizeof(netcodeAddress));
+    netcodeAddress.port = address.GetPort();
+    if (address.GetType() == yojimbo::ADDRESS_IPV6)
+    {
+        netcodeAddress.type = NETCODE_ADDRESS_IPV6;
+        memcpy(netcodeAddress.data.ipv6, address.GetAddress6(), sizeof(netcodeAddress.data.ipv6));
+    }
+    else
+    {
+        netcodeAddress.type = NETCODE_ADDRESS_IPV4;
+        memcpy(netcodeAddress.data.ipv4, address.GetAddress4(), sizeof(netcodeAddress.data.ipv4));
+    }
+    ToSocketAddress(netcodeAddress, out);
+}
+
+BatchedServer::BatchedServer(yojimbo::Allocator &allocator, const uint8_t privateKey[],
+                             const yojimbo::Address &address, const yojimbo::ClientServerConfig &config,
+                             yojimbo::Adapter &adapter, double time, BatchedSocketMode socketMode)
+    : BaseServer(allocator, config, adapter, time),
+      m_config(config),
+      m_server(nullptr),
+      m_address(address),
+      m_boundAddress(),
+      m_socket(),
+      m_socketMode(socketMode),
+      m_ioThread()
+{
+    memcpy(m_privateKey, privateKey, yojimbo::KeyBytes);
+}
+
+BatchedServer::~BatchedServer()
+{
+    Stop();
+}
+
+void BatchedServer::Start(int maxClients)
+{
+    if (IsRunning())
+        Stop();
+
+    sockaddr_storage bindAddress;
+    ToSocketAddress(m_address, bindAddress);
+    if (m_socketMode == BatchedSocketMode::IO_THREAD)
+    {
+        m_ioThread = std::make_unique<NetworkThread>();
+        if (!m_ioThread->Start(bindAddress))
+        {
+            m_ioThread.reset();
+            return;
+        }
+    }
+    else if (m_socketMode == BatchedSocketMode::INLINE && !m_socket.Open(bindAddress))
+    {
+        return;
+    }
+    m_boundAddress = m_address;
+    if (m_socketMode != BatchedSocketMode::NONE)
+        m_boundAddress.SetPort(m_ioThread ? m_ioThread->GetPort() : m_socket.GetPort());
+
+    BaseServer::Start(maxClients);
+
+    // Connect tokens name the port actually bound, so netcode has to as well
+    char addressString[yojimbo::MaxAddressLength];
+    m_boundAddress.ToString(addressString, sizeof(addressString));
+
+    netcode_server_config_t netcodeConfig;
+    netcode_default_server_config(&netcodeConfig);
+    netcodeConfig.protocol_id = m_config.protocolId;
+    memcpy(netcodeConfig.private_key, m_privateKey, NETCODE_KEY_BYTES);
+    netcodeConfig.allocator_context = &GetGlobalAllocator();
+    netcodeConfig.allocate_function = StaticAllocateFunction;
+    netcodeConfig.free_function = StaticFreeFunction;
+    netcodeConfig.callback_context = this;
+    netcodeConfig.connect_disconnect_callback = StaticConnectDisconnectCallback;
+    netcodeConfig.send_loopback_packet_callback = StaticSendLoopbackPacketCallback;
+    // netcode opens no sockets of its own with these set
+    netcodeConfig.override_send_and_receive = 1;
+    netcodeConfig.send_packet_override = StaticSendPacketOverride;
+    netcodeConfig.receive_packet_override = StaticReceivePacketOverride;
+
+    m_server = netcode_server_create(addressString, &netcodeConfig, GetTime());
+    if (!m_server)
+    {
+        Stop();
+        return;
+    }
+
+    netcode_server_start(m_server, maxClients);
+}
+
+void BatchedServer::Stop()
+{
+    if (m_server)
+    {
+        netcode_server_stop(m_server);
+        netcode_server_destroy(m_server);
+        m_server = nullptr;
+    }
+    if (m_ioThread)
+    {
+        m_ioThread->Stop();
+        m_ioThread.reset();
+    }
+    m_socket.Close();
+    m_boundAddress = yojimbo::Address();
+    BaseServer::Stop();
+}
+
+TransportStats BatchedServer::GetTransportStats() const
+{
+    return m_ioThread ? m_ioThread->GetTransportStats() : m_socket.GetStats();
+}
+
+void BatchedServer::FlushSends()
+{
+    if (m_ioThread)
+        m_ioThread->Flush();
+    else
+        m_socket.Flush();
+}
+
+void BatchedServer::DisconnectClient(int clientIndex)
+{
+    netcode_server_disconnect_client(m_server, clientIndex);
+    FlushSends();
+}
+
+void BatchedServer::DisconnectAllClients()
+{
+    netcode_server_disconnect_all_clients(m_server);
+    FlushSends();
+}
+
+void BatchedServer::SendPackets()
+{
+    if (!m_server)
+        return;
+
+    const int maxClients = GetMaxClients();
+    for (int clientIndex = 0; clientIndex < maxClients; ++clientIndex)
+    {
+        if (!IsClientConnected(clientIndex))
+            continue;
+
+        uint8_t *packetData = GetPacketBuffer();
+        int packetBytes;
+        uint16_t packetSequence = reliable_endpoint_next_packet_sequence(GetClientEndpoint(clientIndex));
+        if (GetClientConnection(clientIndex).GeneratePacket(GetContext(), packetSequence, packetData,
+                                                            m_config.maxPacketSize, packetBytes))
+        {
+            reliable_endpoint_send_packet(GetClientEndpoint(clientIndex), packetData, packetBytes);
+        }
+    }
+
+    // Every client's packet for this tick goes out in one sendmmsg
+    FlushSends();
+}
+
+void BatchedServer::ReceivePackets()
+{
+    if (!m_server)
+        return;
+
+    const int maxClients = GetMaxClients();
+    for (int clientIndex = 0; clientIndex < maxClients; ++clientIndex)
+    {
+        while (true)
+        {
+            int packetBytes;
+            uint64_t packetSequence;
+            uint8_t *packetData = netcode_server_receive_packet(m_server, clientIndex, &packetBytes, &packetSequence);
+            if (!packetData)
+                break;
+            reliable_endpoint_receive_packet(GetClientEndpoint(clientIndex), packetData, packetBytes);
+            netcode_server_free_packet(m_server, packetData);
+        }
+    }
+}
+
+void BatchedServer::AdvanceTime(double time)
+{
+    // netcode reads the socket here (through the receive override) and sends
+    // keep-alives and connection traffic, which are flushed together
+    if (m_server)
+    {
+        netcode_server_update(m_server, time);
+        FlushSends();
+    }
+    BaseServer::AdvanceTime(time);
+}
+
+bool BatchedServer::IsClientConnected(int clientIndex) const
+{
+    return m_server && netcode_server_client_connected(m_server, clientIndex);
+}
+
+uint64_t BatchedServer::GetClientId(int clientIndex) const
+{
+    return netcode_server_client_id(m_server, clientIndex);
+}
+
+netcode_address_t *BatchedServer::GetClientAddress(int clientIndex) const
+{
+    return netcode_server_client_address(m_server, clientIndex);
+}
+
+int BatchedServer::GetNumConnectedClients() const
+{
+    return m_server ? netcode_server_num_connected_clients(m_server) : 0;
+}
+
+void BatchedServer::ConnectLoopbackClient(int clientIndex, uint64_t clientId, const uint8_t *userData)
+{
+    netcode_server_connect_loopback_client(m_server, clientIndex, clientId, userData);
+}
+
+void BatchedServer::DisconnectLoopbackClient(int clientIndex)
+{
+    netcode_server_disconnect_loopback_client(m_server, clientIndex);
+}
+
+bool BatchedServer::IsLoopbackClient(int clientIndex) const
+{
+    return netcode_server_client_loopback(m_server, clientIndex) != 0;
+}
+
+void BatchedServer::ProcessLoopbackPacket(int clientIndex, const uint8_t *packetData, int packetBytes,
+                                          uint64_t packetSequence)
+{
+    netcode_server_process_loopback_packet(m_server, clientIndex, packetData, packetBytes, packetSequence);
+}
+
+void BatchedServer::TransmitPacketFunction(int clientIndex, uint16_t packetSequence, uint8_t *packetData,
+                                           int packetBytes)
+{
+    (void)packetSequence;
+    netcode_server_send_packet(m_server, clientIndex, packetData, packetBytes);
+}
+
+int BatchedServer::ProcessPacketFunction(int clientIndex, uint16_t packetSequence, uint8_t *packetData,
+                                         int packetBytes)
+{
+    return GetClientConnection(clientIndex).ProcessPacket(GetContext(), packetSequence, packetData, packetBytes);
+}
+
+void BatchedServer::StaticConnectDisconnectCallback(void *context, int clientIndex, int connected)
+{
+    BatchedServer *server = static_cast<BatchedServer *>(context);
+    if (connected)
+    {
+        server->GetAdapter().OnServerClientConnected(clientIndex);
+    }
+    else
+    {
+        server->GetAdapter().OnServerClientDisconnected(clientIndex);
+        server->ResetClient(clientIndex);
+    }
+}
+
+void BatchedServer::StaticSendLoopbackPacketCallback(void *context, int clientIndex, const uint8_t *packetData,
+                                                     int packetBytes, uint64_t packetSequence)
+{
+    BatchedServer *server = static_cast<BatchedServer *>(context);
+    server->GetAdapter().ServerSendLoopbackPacket(clientIndex, packetData, packetBytes, packetSequence);
+}
+
+void BatchedServer::StaticSendPacketOverride(void *context, netcode_address_t *to, const uint8_t *packetData,
+                                             int packetBytes)
+{
+    BatchedServer *server = static_cast<BatchedServer *>(context);
+    sockaddr_storage address;
+    ToSocketAddress(*to, address);
+    if (server->m_ioThread)
+        server->m_ioThread->Send(address, packetData, packetBytes);
+    else
+        server->m_socket.Send(address, packetData, packetBytes);
+}
+
+int BatchedServer::StaticReceivePacketOverride(void *context, netcode_address_t *from, uint8_t *packetData,
+                                               int maxPacketBytes)
+{
+    BatchedServer *server = static_cast<BatchedServer *>(context);
+    sockaddr_storage address;
+    int bytes = server->m_ioThread ? server->m_ioThread->Receive(address, packetData, maxPacketBytes)
+                                   : server->m_socket.Receive(address, packetData, maxPacketBytes);
+    if (bytes > 0)
+        FromSocketAddress(address, *from);
+    return bytes;
+}
+#endif
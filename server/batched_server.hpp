@@ -0,0 +1,86 @@
+#pragma once
+#include <memory>
+#include <yojimbo.h>
+#include "batched_socket.hpp"
+#include "network_thread.hpp"
+
+#if CIRC_BATCHED_TRANSPORT
+struct netcode_server_t;
+struct netcode_address_t;
+
+// Where BatchedServer's datagrams go
+enum class BatchedSocketMode
+{
+    INLINE,    // A BatchedSocket driven by the thread that drives the server
+    IO_THREAD, // A BatchedSocket on a NetworkThread
+    NONE       // No socket at all: only loopback clients can connect
+};
+
+// yojimbo::Server with its UDP traffic moved onto a BatchedSocket. It does what
+// yojimbo::Server does, except that netcode is created with its send/receive
+// override hooks, so packets are read with recvmmsg during AdvanceTime and
+// written with sendmmsg once per SendPackets/AdvanceTime instead of one
+// syscall per packet. yojimbo's network simulator is not supported.
+//
+// With IO_THREAD the socket moves onto a NetworkThread: the server only
+// pushes and pops datagrams on SPSC rings and never makes a socket syscall
+// itself. yojimbo's connection state is not thread-safe, so packet encoding,
+// decoding and everything above stay on the thread that drives the server.
+// NONE binds nothing, for servers that only ever see loopback clients.
+class BatchedServer : public yojimbo::BaseServer
+{
+public:
+    BatchedServer(yojimbo::Allocator &allocator, const uint8_t privateKey[], const yojimbo::Address &address,
+                  const yojimbo::ClientServerConfig &config, yojimbo::Adapter &adapter, double time,
+                  BatchedSocketMode socketMode = BatchedSocketMode::INLINE);
+    ~BatchedServer();
+
+    void Start(int maxClients) override;
+    void Stop() override;
+    void DisconnectClient(int clientIndex) override;
+    void DisconnectAllClients() override;
+    void SendPackets() override;
+    void ReceivePackets() override;
+    void AdvanceTime(double time) override;
+
+    bool IsClientConnected(int clientIndex) const override;
+    uint64_t GetClientId(int clientIndex) const override;
+    netcode_address_t *GetClientAddress(int clientIndex) const override;
+    int GetNumConnectedClients() const override;
+
+    void ConnectLoopbackClient(int clientIndex, uint64_t clientId, const uint8_t *userData) override;
+    void DisconnectLoopbackClient(int clientIndex) override;
+    bool IsLoopbackClient(int clientIndex) const override;
+    void ProcessLoopbackPacket(int clientIndex, const uint8_t *packetData, int packetBytes,
+                               uint64_t packetSequence) override;
+
+    // The address bound by Start, with the port the kernel picked when asked for
+    // port 0; the requested address as is without a socket
+    const yojimbo::Address &GetAddress() const { return m_boundAddress; }
+    TransportStats GetTransportStats() const;
+    // Ring counters, or null without an I/O thread
+    const NetworkThread *GetNetworkThread() const { return m_ioThread.get(); }
+
+private:
+    void FlushSends();
+    void TransmitPacketFunction(int clientIndex, uint16_t packetSequence, uint8_t *packetData, int packetBytes) override;
+    int ProcessPacketFunction(int clientIndex, uint16_t packetSequence, uint8_t *packetData, int packetBytes) override;
+
+    static void StaticConnectDisconnectCallback(void *context, int clientIndex, int connected);
+    static void StaticSendLoopbackPacketCallback(void *context, int clientIndex, const uint8_t *packetData,
+                                                 int packetBytes, uint64_t packetSequence);
+    static void StaticSendPacketOverride(void *context, netcode_address_t *to, const uint8_t *packetData,
+                                         int packetBytes);
+    static int StaticReceivePacketOverride(void *context, netcode_address_t *from, uint8_t *packetData,
+                                           int maxPacketBytes);
+
+    yojimbo::ClientServerConfig m_config;
+    netcode_server_t *m_server;
+    yojimbo::Address m_address;
+    yojimbo::Address m_boundAddress;
+    uint8_t m_privateKey[yojimbo::KeyBytes];
+    BatchedSocket m_socket;
+    BatchedSocketMode m_socketMode;
+    std::unique_ptr<NetworkThread> m_ioThread; // Owns the socket instead of m_socket while started
+};
+#endif
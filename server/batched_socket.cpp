@@ -0,0 +1,182 @@
+#include "batched_socket.hpp"
+
+#if CIRC_BATCHED_TRANSPORT
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+BatchedSocket::BatchedSocket()
+    : m_socket(-1),
+      m_port(0),
+      m_sendData(TRANSPORT_BATCH_SIZE * TRANSPORT_MAX_PACKET_BYTES),
+      m_sendAddresses(TRANSPORT_BATCH_SIZE),
+      m_sendVectors(TRANSPORT_BATCH_SIZE),
+      m_sendMessages(TRANSPORT_BATCH_SIZE),
+      m_sendCount(0),
+      m_receiveData(TRANSPORT_BATCH_SIZE * TRANSPORT_MAX_PACKET_BYTES),
+      m_receiveAddresses(TRANSPORT_BATCH_SIZE),
+      m_receiveVectors(TRANSPORT_BATCH_SIZE),
+      m_receiveMessages(TRANSPORT_BATCH_SIZE),
+      m_receiveCount(0),
+      m_receiveIndex(0),
+      m_stats()
+{
+    // Every slot points at its own buffer and address for the socket's lifetime
+    for (int i = 0; i < TRANSPORT_BATCH_SIZE; ++i)
+    {
+        m_sendVectors[i].iov_base = &m_sendData[i * TRANSPORT_MAX_PACKET_BYTES];
+        memset(&m_sendMessages[i], 0, sizeof(mmsghdr));
+        m_sendMessages[i].msg_hdr.msg_name = &m_sendAddresses[i];
+        m_sendMessages[i].msg_hdr.msg_iov = &m_sendVectors[i];
+        m_sendMessages[i].msg_hdr.msg_iovlen = 1;
+
+        m_receiveVectors[i].iov_base = &m_receiveData[i * TRANSPORT_MAX_PACKET_BYTES];
+        memset(&m_receiveMessages[i], 0, sizeof(mmsghdr));
+        m_receiveMessages[i].msg_hdr.msg_name = &m_receiveAddresses[i];
+        m_receiveMessages[i].msg_hdr.msg_iov = &m_receiveVectors[i];
+        m_receiveMessages[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+BatchedSocket::~BatchedSocket()
+{
+    Close();
+}
+
+static socklen_t AddressLength(const sockaddr_storage &address)
+{
+    return address.ss_family == AF_INET6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+}
+
+bool BatchedSocket::Open(const sockaddr_storage &address, int bufferBytes)
+{
+    Close();
+
+    int family = address.ss_family;
+    m_socket = socket(family, SOCK_DGRAM, IPPROTO_UDP);
+    if (m_socket < 0)
+        return false;
+
+    int yes = 1;
+    if (family == AF_INET6)
+        setsockopt(m_socket, IPPROTO_IPV6, IPV6_V6ONLY, &yes, sizeof(yes));
+    setsockopt(m_socket, SOL_SOCKET, SO_SNDBUF, &bufferBytes, sizeof(bufferBytes));
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+
+    sockaddr_storage bound = address;
+    socklen_t length = AddressLength(address);
+    if (bind(m_socket, reinterpret_cast<const sockaddr *>(&address), length) < 0 ||
+        getsockname(m_socket, reinterpret_cast<sockaddr *>(&bound), &length) < 0 ||
+        fcntl(m_socket, F_SETFL, fcntl(m_socket, F_GETFL, 0) | O_NONBLOCK) < 0)
+    {
+        Close();
+        return false;
+    }
+
+    m_port = ntohs(family == AF_INET6 ? reinterpret_cast<sockaddr_in6 &>(bound).sin6_port
+                                      : reinterpret_cast<sockaddr_in &>(bound).sin_port);
+    m_stats = TransportStats();
+    return true;
+}
+
+void BatchedSocket::Close()
+{
+    if (m_socket >= 0)
+    {
+        Flush();
+        close(m_socket);
+        m_socket = -1;
+    }
+    m_port = 0;
+    m_sendCount = 0;
+    m_receiveCount = 0;
+    m_receiveIndex = 0;
+}
+
+void BatchedSocket::Send(const sockaddr_storage &to, const uint8_t *data, int bytes)
+{
+    if (m_socket < 0 || bytes <= 0 || bytes > TRANSPORT_MAX_PACKET_BYTES)
+        return;
+
+    int i = m_sendCount++;
+    memcpy(m_sendVectors[i].iov_base, data, bytes);
+    m_sendVectors[i].iov_len = bytes;
+    m_sendAddresses[i] = to;
+    m_sendMessages[i].msg_hdr.msg_namelen = AddressLength(to);
+
+    if (m_sendCount == TRANSPORT_BATCH_SIZE)
+        Flush();
+}
+
+void BatchedSocket::Flush()
+{
+    int sent = 0;
+    while (sent < m_sendCount)
+    {
+        int result = sendmmsg(m_socket, &m_sendMessages[sent], m_sendCount - sent, 0);
+        m_stats.sendCalls++;
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                // Send buffer full: drop the rest rather than spin on it. UDP
+                // would lose them anyway; this keeps the loss countable.
+                m_stats.sendDropped += m_sendCount - sent;
+                break;
+            }
+
+            // Skip the packet the kernel stopped at and carry on with the rest
+            m_stats.sendErrors++;
+            sent++;
+            continue;
+        }
+        m_stats.packetsSent += result;
+        if (result > m_stats.maxSendBatch)
+            m_stats.maxSendBatch = result;
+        sent += result;
+    }
+    m_sendCount = 0;
+}
+
+int BatchedSocket::Receive(sockaddr_storage &from, uint8_t *data, int capacity)
+{
+    if (m_socket < 0)
+        return 0;
+
+    while (true)
+    {
+        if (m_receiveIndex == m_receiveCount)
+        {
+            // recvmmsg writes the lengths back, so they are reset before every call
+            for (int i = 0; i < TRANSPORT_BATCH_SIZE; ++i)
+            {
+                m_receiveVectors[i].iov_len = TRANSPORT_MAX_PACKET_BYTES;
+                m_receiveMessages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+            }
+
+            int result = recvmmsg(m_socket, m_receiveMessages.data(), TRANSPORT_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+            m_stats.receiveCalls++;
+            m_receiveIndex = 0;
+            m_receiveCount = result > 0 ? result : 0;
+            if (m_receiveCount == 0)
+                return 0;
+
+            m_stats.packetsReceived += m_receiveCount;
+            if (m_receiveCount > m_stats.maxReceiveBatch)
+                m_stats.maxReceiveBatch = m_receiveCount;
+        }
+
+        const mmsghdr &message = m_receiveMessages[m_receiveIndex++];
+        int bytes = static_cast<int>(message.msg_len);
+        if (bytes <= 0 || bytes > capacity || (message.msg_hdr.msg_flags & MSG_TRUNC))
+            continue;
+
+        memcpy(&from, message.msg_hdr.msg_name, sizeof(sockaddr_storage));
+        memcpy(data, message.msg_hdr.msg_iov->iov_base, bytes);
+        return bytes;
+    }
+}
+#endif
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <EASTL/vector.h>
+
+// recvmmsg/sendmmsg are Linux only; elsewhere the batched transport is compiled
+// out and the server always uses yojimbo's own sockets
+#ifndef CIRC_BATCHED_TRANSPORT
+#if defined(__linux__)
+#define CIRC_BATCHED_TRANSPORT 1
+#else
+#define CIRC_BATCHED_TRANSPORT 0
+#endif
+#endif
+
+#if CIRC_BATCHED_TRANSPORT
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+static const int TRANSPORT_BATCH_SIZE = 64;          // Packets per recvmmsg/sendmmsg call
+static const int TRANSPORT_MAX_PACKET_BYTES = 1500;  // Ethernet MTU; netcode packets are smaller
+static const int TRANSPORT_SOCKET_BUFFER_BYTES = 4 * 1024 * 1024;
+
+// Syscall and packet counts of a BatchedSocket since it was opened
+struct TransportStats
+{
+    uint64_t sendCalls = 0;
+    uint64_t packetsSent = 0;
+    uint64_t sendErrors = 0;    // Packets the kernel refused; UDP, so they are dropped
+    uint64_t sendDropped = 0;   // Packets dropped because the socket send buffer was full
+    uint64_t receiveCalls = 0;  // Including the final call that finds nothing waiting
+    uint64_t packetsReceived = 0;
+    int maxSendBatch = 0;
+    int maxReceiveBatch = 0;
+
+    uint64_t Syscalls() const { return sendCalls + receiveCalls; }
+    double PacketsPerSend() const { return sendCalls ? static_cast<double>(packetsSent) / sendCalls : 0.0; }
+    double PacketsPerReceive() const { return receiveCalls ? static_cast<double>(packetsReceived) / receiveCalls : 0.0; }
+};
+
+// Non-blocking UDP socket that moves up to TRANSPORT_BATCH_SIZE packets per
+// syscall. Sends are queued and go out in one sendmmsg on Flush (or when the
+// batch fills); receives are read with one recvmmsg and handed out one by one.
+class BatchedSocket
+{
+public:
+    BatchedSocket();
+    ~BatchedSocket();
+
+    BatchedSocket(const BatchedSocket &) = delete;
+    BatchedSocket &operator=(const BatchedSocket &) = delete;
+
+    // Binds to `address` (IPv4 or IPv6, port 0 picks one). Returns false on failure.
+    bool Open(const sockaddr_storage &address, int bufferBytes = TRANSPORT_SOCKET_BUFFER_BYTES);
+    void Close();
+    bool IsOpen() const { return m_socket >= 0; }
+    uint16_t GetPort() const { return m_port; }
+    int GetHandle() const { return m_socket; }
+
+    // Queues a packet for the next Flush. Packets over TRANSPORT_MAX_PACKET_BYTES are dropped.
+    void Send(const sockaddr_storage &to, const uint8_t *data, int bytes);
+    void Flush();
+
+    // Copies the next received packet into `data`, reading a new batch when the
+    // current one is used up. Returns its size, or 0 when nothing is waiting.
+    int Receive(sockaddr_storage &from, uint8_t *data, int capacity);
+
+    const TransportStats &GetStats() const { return m_stats; }
+
+private:
+    int m_socket;
+    uint16_t m_port;
+
+    eastl::vector<uint8_t> m_sendData;
+    eastl::vector<sockaddr_storage> m_sendAddresses;
+    eastl::vector<iovec> m_sendVectors;
+    eastl::vector<mmsghdr> m_sendMessages;
+    int m_sendCount;
+
+    eastl::vector<uint8_t> m_receiveData;
+    eastl::vector<sockaddr_storage> m_receiveAddresses;
+    eastl::vector<iovec> m_receiveVectors;
+    eastl::vector<mmsghdr> m_receiveMessages;
+    int m_receiveCount;
+    int m_receiveIndex;
+
+    TransportStats m_stats;
+};
+#endif
@@ -0,0 +1,81 @@
+#include "congestion.hpp"
+#include <EASTL/algorithm.h>
+
+CongestionController::CongestionController(const CongestionConfig &config)
+    : m_config(config),
+      m_level(0),
+      m_penaltyTime(config.minPenaltyTime),
+      m_levelTime(0.0),
+      m_relaxTime(0.0),
+      m_clearSince(-1.0),
+      m_upshifted(false)
+{
+}
+
+void CongestionController::Reset(double time)
+{
+    m_level = 0;
+    m_penaltyTime = m_config.minPenaltyTime;
+    m_levelTime = time;
+    m_relaxTime = time;
+    m_clearSince = -1.0;
+    m_upshifted = false;
+}
+
+bool CongestionController::IsCongested(const yojimbo::NetworkInfo &info) const
+{
+    if (info.RTT > m_config.badRTT || info.packetLoss > m_config.badPacketLoss)
+        return true;
+    return info.sentBandwidth > 0.0f && info.ackedBandwidth < info.sentBandwidth * m_config.minAckedRatio;
+}
+
+bool CongestionController::IsClear(const yojimbo::NetworkInfo &info) const
+{
+    return info.RTT < m_config.goodRTT && info.packetLoss < m_config.goodPacketLoss;
+}
+
+bool CongestionController::Update(const yojimbo::NetworkInfo &info, double time)
+{
+    if (IsCongested(info))
+    {
+        m_clearSince = -1.0;
+        if (m_level == NUM_CONGESTION_LEVELS - 1 || time - m_levelTime < m_config.downshiftCooldown)
+            return false;
+
+        // Congested again soon after shifting up: that level is not sustainable yet
+        if (m_upshifted && time - m_levelTime < m_config.penaltyRelaxTime)
+        {
+            m_penaltyTime = eastl::min(m_penaltyTime * 2.0, m_config.maxPenaltyTime);
+        }
+        m_level++;
+        m_levelTime = time;
+        m_relaxTime = time;
+        m_upshifted = false;
+        return true;
+    }
+
+    // A level that holds up for a while earns back half its penalty
+    if (time - m_relaxTime >= m_config.penaltyRelaxTime)
+    {
+        m_penaltyTime = eastl::max(m_penaltyTime / 2.0, m_config.minPenaltyTime);
+        m_relaxTime = time;
+    }
+
+    if (!IsClear(info))
+    {
+        m_clearSince = -1.0;
+        return false;
+    }
+
+    if (m_clearSince < 0.0)
+        m_clearSince = time;
+    if (m_level == 0 || time - m_clearSince < m_penaltyTime)
+        return false;
+
+    m_level--;
+    m_levelTime = time;
+    m_relaxTime = time;
+    m_clearSince = -1.0;
+    m_upshifted = true;
+    return true;
+}
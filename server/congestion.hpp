@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <yojimbo.h>
+#include "../common/protocol.hpp"
+
+// One step of a client's send-rate ladder, best link first
+struct CongestionLevel
+{
+    int intervalScale; // Multiplies the server's snapshot interval
+    int maxPlayers;    // Players per snapshot, the client's own included
+};
+
+static const CongestionLevel CONGESTION_LEVELS[] = {
+    {1, MAX_PLAYER_CAPACITY},
+    {2, 32},
+    {4, 16},
+};
+static const int NUM_CONGESTION_LEVELS = sizeof(CONGESTION_LEVELS) / sizeof(CONGESTION_LEVELS[0]);
+
+struct CongestionConfig
+{
+    float badRTT = 250.0f;        // Milliseconds; above this the link counts as congested
+    float goodRTT = 150.0f;       // Milliseconds; below this (and good loss) it counts as clear
+    float badPacketLoss = 5.0f;   // Percent
+    float goodPacketLoss = 1.0f;  // Percent
+    float minAckedRatio = 0.75f;  // Acked over sent bandwidth; less means packets are piling up
+    double downshiftCooldown = 1.0;  // Seconds between two downshifts, so the RTT average catches up
+    double minPenaltyTime = 4.0;     // Seconds of clear link before shifting back up
+    double maxPenaltyTime = 60.0;
+    double penaltyRelaxTime = 10.0;  // Seconds at a level before its penalty is halved again
+};
+
+// Per-client send-rate controller fed from yojimbo::NetworkInfo every tick.
+// Congestion shifts a client down the CONGESTION_LEVELS ladder right away;
+// shifting back up waits for a clear link over the penalty time, which doubles
+// whenever an upshift is followed by congestion again. Between the good and
+// bad thresholds the level holds, so a borderline link does not oscillate.
+class CongestionController
+{
+public:
+    explicit CongestionController(const CongestionConfig &config = CongestionConfig());
+
+    // Back to the best level, e.g. when the slot is reused
+    void Reset(double time);
+
+    // Feeds one tick of link stats. Returns true when the level changed.
+    bool Update(const yojimbo::NetworkInfo &info, double time);
+
+    int GetLevel() const { return m_level; }
+    int GetIntervalScale() const { return CONGESTION_LEVELS[m_level].intervalScale; }
+    int GetMaxPlayers() const { return CONGESTION_LEVELS[m_level].maxPlayers; }
+    double GetPenaltyTime() const { return m_penaltyTime; }
+
+private:
+    bool IsCongested(const yojimbo::NetworkInfo &info) const;
+    bool IsClear(const yojimbo::NetworkInfo &info) const;
+
+    CongestionConfig m_config;
+    int m_level;
+    double m_penaltyTime;
+    double m_levelTime;   // When the current level was entered
+    double m_relaxTime;   // When the penalty time last changed or the level was entered
+    double m_clearSince;  // Start of the current clear stretch, negative when not clear
+    bool m_upshifted;     // The current level was entered by shifting up
+};
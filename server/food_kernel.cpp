@@ -0,0 +1,137 @@
+#include "food_kernel.hpp"
+#include <cstring>
+
+#ifdef CIRC_FOOD_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+// Scalar tail shared by every kernel; `first` must be where the vector loop stopped
+static int FindFoodOverlapsTail(const float *foodX, const float *foodY, int first, int count,
+                                float x, float y, float radiusSquared, uint64_t *outMask)
+{
+    int hits = 0;
+    for (int i = first; i < count; ++i)
+    {
+        float dx = foodX[i] - x;
+        float dy = foodY[i] - y;
+        if (dx * dx + dy * dy < radiusSquared)
+        {
+            outMask[i >> 6] |= uint64_t(1) << (i & 63);
+            hits++;
+        }
+    }
+    return hits;
+}
+
+int FindFoodOverlapsScalar(const float *foodX, const float *foodY, int count,
+                           float x, float y, float radiusSquared, uint64_t *outMask)
+{
+    if (count <= 0)
+        return 0;
+    memset(outMask, 0, FoodMaskWords(count) * sizeof(uint64_t));
+    return FindFoodOverlapsTail(foodX, foodY, 0, count, x, y, radiusSquared, outMask);
+}
+
+#ifdef CIRC_FOOD_KERNEL_X86
+
+// Kept as separate multiply and add (no FMA) so results match the scalar path bit for bit
+
+__attribute__((target("sse2")))
+int FindFoodOverlapsSSE(const float *foodX, const float *foodY, int count,
+                        float x, float y, float radiusSquared, uint64_t *outMask)
+{
+    if (count <= 0)
+        return 0;
+    memset(outMask, 0, FoodMaskWords(count) * sizeof(uint64_t));
+
+    const __m128 px = _mm_set1_ps(x);
+    const __m128 py = _mm_set1_ps(y);
+    const __m128 r2 = _mm_set1_ps(radiusSquared);
+
+    int hits = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(foodX + i), px);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(foodY + i), py);
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        uint32_t bits = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(d2, r2)));
+        if (bits)
+        {
+            outMask[i >> 6] |= uint64_t(bits) << (i & 63);
+            hits += __builtin_popcount(bits);
+        }
+    }
+
+    return hits + FindFoodOverlapsTail(foodX, foodY, i, count, x, y, radiusSquared, outMask);
+}
+
+__attribute__((target("avx2")))
+int FindFoodOverlapsAVX2(const float *foodX, const float *foodY, int count,
+                         float x, float y, float radiusSquared, uint64_t *outMask)
+{
+    if (count <= 0)
+        return 0;
+    memset(outMask, 0, FoodMaskWords(count) * sizeof(uint64_t));
+
+    const __m256 px = _mm256_set1_ps(x);
+    const __m256 py = _mm256_set1_ps(y);
+    const __m256 r2 = _mm256_set1_ps(radiusSquared);
+
+    int hits = 0;
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(foodX + i), px);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(foodY + i), py);
+        __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(d2, r2, _CMP_LT_OQ)));
+        if (bits)
+        {
+            // i is a multiple of 8, so the 8 bits never straddle two mask words
+            outMask[i >> 6] |= uint64_t(bits) << (i & 63);
+            hits += __builtin_popcount(bits);
+        }
+    }
+
+    return hits + FindFoodOverlapsTail(foodX, foodY, i, count, x, y, radiusSquared, outMask);
+}
+
+#endif // CIRC_FOOD_KERNEL_X86
+
+namespace
+{
+struct FoodKernelChoice
+{
+    FoodOverlapKernel kernel;
+    const char *name;
+};
+
+FoodKernelChoice ChooseFoodKernel()
+{
+#ifdef CIRC_FOOD_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return {FindFoodOverlapsAVX2, "avx2"};
+    if (__builtin_cpu_supports("sse2"))
+        return {FindFoodOverlapsSSE, "sse2"};
+#endif
+    return {FindFoodOverlapsScalar, "scalar"};
+}
+
+const FoodKernelChoice &GetFoodKernelChoice()
+{
+    static const FoodKernelChoice choice = ChooseFoodKernel();
+    return choice;
+}
+}
+
+FoodOverlapKernel GetFoodOverlapKernel()
+{
+    return GetFoodKernelChoice().kernel;
+}
+
+const char *GetFoodOverlapKernelName()
+{
+    return GetFoodKernelChoice().name;
+}
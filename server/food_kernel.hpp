@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+// Food-overlap kernels. Each one tests `count` food positions against a single
+// player circle and sets bit i of outMask (64 items per word) when
+//
+//     (foodX[i] - x)^2 + (foodY[i] - y)^2 < radiusSquared
+//
+// which is exactly FoodItem::position.distanceSquared(player) < radiusSquared.
+// The mask is overwritten, and the number of set bits is returned. With
+// `count` 0 nothing is written, so outMask may be null.
+typedef int (*FoodOverlapKernel)(const float *foodX, const float *foodY, int count,
+                                 float x, float y, float radiusSquared, uint64_t *outMask);
+
+inline int FoodMaskWords(int count) { return (count + 63) / 64; }
+
+// HandleGameFood runs the kernel over all MAX_FOOD items instead of walking
+// the food grid once a player's collision box covers this many grid cells.
+// bench_food_kernel.cpp "[kernel]" at MAX_FOOD (AVX2): 1 cell kernel 27 ns vs
+// grid 28 ns, 9 cells 35 vs 30, 25 cells 42 vs 55, 49 cells 44 vs 173. The
+// kernel's cost is flat, so from 9 cells on it is at worst level with the grid
+// and the grid's cost is what grows.
+static const int FOOD_KERNEL_MIN_CELLS = 9;
+
+int FindFoodOverlapsScalar(const float *foodX, const float *foodY, int count,
+                           float x, float y, float radiusSquared, uint64_t *outMask);
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CIRC_FOOD_KERNEL_X86 1
+int FindFoodOverlapsSSE(const float *foodX, const float *foodY, int count,
+                        float x, float y, float radiusSquared, uint64_t *outMask);
+int FindFoodOverlapsAVX2(const float *foodX, const float *foodY, int count,
+                         float x, float y, float radiusSquared, uint64_t *outMask);
+#endif
+
+// Widest kernel the running CPU supports, picked on first use
+FoodOverlapKernel GetFoodOverlapKernel();
+const char *GetFoodOverlapKernelName();
+
+inline int FindFoodOverlaps(const float *foodX, const float *foodY, int count,
+                            float x, float y, float radiusSquared, uint64_t *outMask)
+{
+    return GetFoodOverlapKernel()(foodX, foodY, count, x, y, radiusSquared, outMask);
+}
@@ -0,0 +1,109 @@
+#include "frame_arena.hpp"
+#include "../common/heap_counter.hpp"
+#include <cstdlib>
+#include <EASTL/allocator.h>
+
+static size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+FrameArena::FrameArena(size_t capacity)
+    : m_memory(static_cast<uint8_t *>(malloc(capacity))),
+      m_capacity(m_memory ? capacity : 0),
+      m_used(0),
+      m_highWater(0),
+      m_overflow(),
+      m_overflowBytes(0),
+      m_overflowCount(0)
+{
+    m_overflow.reserve(FRAME_ARENA_OVERFLOW_BLOCKS);
+}
+
+FrameArena::~FrameArena()
+{
+    for (void *block : m_overflow)
+        free(block);
+    free(m_memory);
+}
+
+void *FrameArena::Allocate(size_t bytes, size_t alignment)
+{
+    const uintptr_t base = reinterpret_cast<uintptr_t>(m_memory);
+    size_t offset = AlignUp(base + m_used, alignment) - base;
+    if (offset + bytes <= m_capacity)
+    {
+        m_used = offset + bytes;
+        if (GetUsed() > m_highWater)
+            m_highWater = GetUsed();
+        return m_memory + offset;
+    }
+
+    // malloc bypasses the counted operator new, so overflow is counted here
+#if CIRC_TICK_ALLOC_CHECK
+    CountHeapAllocation();
+#endif
+    uint8_t *block = static_cast<uint8_t *>(malloc(bytes + alignment - 1));
+    if (!block)
+        return nullptr;
+    m_overflow.push_back(block);
+    m_overflowBytes += bytes;
+    m_overflowCount++;
+    if (GetUsed() > m_highWater)
+        m_highWater = GetUsed();
+    return block + (AlignUp(reinterpret_cast<uintptr_t>(block), alignment) - reinterpret_cast<uintptr_t>(block));
+}
+
+void FrameArena::Reset()
+{
+    for (void *block : m_overflow)
+        free(block);
+    m_overflow.clear();
+
+    // One tick did not fit: grow once so the next one like it does
+    if (m_overflowBytes > 0)
+    {
+        const size_t GROWTH_GRANULARITY = 4096;
+        size_t capacity = AlignUp(m_highWater + m_highWater / 2, GROWTH_GRANULARITY);
+#if CIRC_TICK_ALLOC_CHECK
+        CountHeapAllocation();
+#endif
+        uint8_t *memory = static_cast<uint8_t *>(malloc(capacity));
+        if (memory)
+        {
+            free(m_memory);
+            m_memory = memory;
+            m_capacity = capacity;
+        }
+    }
+
+    m_used = 0;
+    m_overflowBytes = 0;
+}
+
+bool FrameArena::Owns(const void *p) const
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(p);
+    return bytes >= m_memory && bytes < m_memory + m_capacity;
+}
+
+void *FrameArenaAllocator::allocate(size_t n, int flags)
+{
+    if (m_arena)
+        return m_arena->Allocate(n);
+    return eastl::GetDefaultAllocator()->allocate(n, flags);
+}
+
+void *FrameArenaAllocator::allocate(size_t n, size_t alignment, size_t offset, int flags)
+{
+    if (m_arena)
+        return m_arena->Allocate(n, alignment > alignof(max_align_t) ? alignment : alignof(max_align_t));
+    return eastl::GetDefaultAllocator()->allocate(n, alignment, offset, flags);
+}
+
+void FrameArenaAllocator::deallocate(void *p, size_t n)
+{
+    // Arena memory goes back all at once on Reset
+    if (!m_arena)
+        eastl::GetDefaultAllocator()->deallocate(p, n);
+}
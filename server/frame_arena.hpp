@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <EASTL/vector.h>
+
+static const size_t FRAME_ARENA_BYTES = 64 * 1024; // Initial capacity; grows to the busiest tick seen
+static const size_t FRAME_ARENA_OVERFLOW_BLOCKS = 64; // Overflow blocks one tick can take before their list grows
+
+// Linear allocator for temporaries that live for one server tick. Allocation
+// bumps a pointer and freeing is a no-op; Reset at the top of the tick makes
+// the whole block available again. A tick that runs past the block takes
+// overflow blocks from the heap, and the next Reset regrows the block to the
+// high-water mark so the steady state stays inside it. Overflow blocks, and
+// their list once it outgrows its reservation, count as heap allocations
+// under CIRC_TICK_ALLOC_CHECK.
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t capacity = FRAME_ARENA_BYTES);
+    ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void *Allocate(size_t bytes, size_t alignment = alignof(max_align_t));
+    void Reset();
+
+    // Whether `p` lies in the main block (overflow blocks are not included)
+    bool Owns(const void *p) const;
+    size_t GetCapacity() const { return m_capacity; }
+    size_t GetUsed() const { return m_used + m_overflowBytes; }
+    size_t GetHighWater() const { return m_highWater; }
+    uint64_t GetOverflowCount() const { return m_overflowCount; } // Overflow blocks taken so far
+
+private:
+    uint8_t *m_memory;
+    size_t m_capacity;
+    size_t m_used;
+    size_t m_highWater;
+
+    eastl::vector<void *> m_overflow; // Freed on the next Reset
+    size_t m_overflowBytes;
+    uint64_t m_overflowCount;
+};
+
+// EASTL allocator that draws from a FrameArena, for containers that are
+// rebuilt every tick. Memory from the arena is never freed one by one;
+// anything else (no arena set) goes through EASTL's default allocator.
+class FrameArenaAllocator
+{
+public:
+    explicit FrameArenaAllocator(const char *name = "FrameArena") : m_arena(nullptr), m_name(name) {}
+    explicit FrameArenaAllocator(FrameArena *arena, const char *name = "FrameArena") : m_arena(arena), m_name(name) {}
+    FrameArenaAllocator(const FrameArenaAllocator &other, const char *name) : m_arena(other.m_arena), m_name(name) {}
+    FrameArenaAllocator(const FrameArenaAllocator &other) = default;
+    FrameArenaAllocator &operator=(const FrameArenaAllocator &other) = default;
+
+    void *allocate(size_t n, int flags = 0);
+    void *allocate(size_t n, size_t alignment, size_t offset, int flags = 0);
+    void deallocate(void *p, size_t n);
+
+    const char *get_name() const { return m_name; }
+    void set_name(const char *name) { m_name = name; }
+    FrameArena *GetArena() const { return m_arena; }
+
+private:
+    FrameArena *m_arena;
+    const char *m_name;
+};
+
+inline bool operator==(const FrameArenaAllocator &a, const FrameArenaAllocator &b)
+{
+    return a.GetArena() == b.GetArena();
+}
+
+inline bool operator!=(const FrameArenaAllocator &a, const FrameArenaAllocator &b)
+{
+    return a.GetArena() != b.GetArena();
+}
+
+// A vector whose storage lives until the arena's next Reset
+template <typename T>
+using FrameVector = eastl::vector<T, FrameArenaAllocator>;
@@ -1,8 +1,11 @@
 #include "game_server.hpp"
 #include <cmath>
+#include <cstring>
+#include <EASTL/algorithm.h>
 
 void GameAdapter::OnServerClientConnected(int clientIndex)
 {
+    ClearClientMemoryError(clientIndex);
     if (m_server)
     {
         m_server->ClientConnected(clientIndex);
@@ -11,42 +14,203 @@ void GameAdapter::OnServerClientConnected(int clientIndex)
 
 void GameAdapter::OnServerClientDisconnected(int clientIndex)
 {
+    ClearClientMemoryError(clientIndex);
     if (m_server)
     {
         m_server->ClientDisconnected(clientIndex);
     }
 }
 
-GameServer::GameServer(const yojimbo::Address &address)
-    : m_connectionConfig(),
+static int ClampMaxPlayers(int maxPlayers)
+{
+    if (maxPlayers < 1)
+        return 1;
+    if (maxPlayers > MAX_PLAYER_CAPACITY)
+    {
+        std::cerr << "Requested " << maxPlayers << " players, but this build supports at most "
+                  << MAX_PLAYER_CAPACITY << " (yojimbo::MaxClients)" << std::endl;
+        return MAX_PLAYER_CAPACITY;
+    }
+    return maxPlayers;
+}
+
+static ServerTransport CheckTransport(ServerTransport transport)
+{
+#if !CIRC_BATCHED_TRANSPORT
+    if (transport != ServerTransport::SOCKET)
+    {
+        std::cerr << "Batched transport is not available on this platform, using sockets" << std::endl;
+        return ServerTransport::SOCKET;
+    }
+#endif
+    return transport;
+}
+
+// yojimbo's allocator for the server and its shared messages; counted in
+// CIRC_TICK_ALLOC_CHECK builds
+static yojimbo::Allocator &GetServerAllocator()
+{
+#if CIRC_TICK_ALLOC_CHECK
+    static CountingAllocator allocator;
+    return allocator;
+#else
+    return yojimbo::GetDefaultAllocator();
+#endif
+}
+
+static yojimbo::BaseServer *CreateServer(ServerTransport transport, const yojimbo::Address &address,
+                                         const yojimbo::ClientServerConfig &config, yojimbo::Adapter &adapter)
+{
+#if CIRC_BATCHED_TRANSPORT
+    if (transport != ServerTransport::SOCKET)
+    {
+        BatchedSocketMode socketMode = BatchedSocketMode::INLINE;
+        if (transport == ServerTransport::THREADED)
+            socketMode = BatchedSocketMode::IO_THREAD;
+        else if (transport == ServerTransport::LOOPBACK)
+            socketMode = BatchedSocketMode::NONE;
+        return new BatchedServer(GetServerAllocator(), DEFAULT_PRIVATE_KEY, address, config, adapter, 0.0,
+                                 socketMode);
+    }
+#endif
+    (void)transport;
+    return new yojimbo::Server(GetServerAllocator(), DEFAULT_PRIVATE_KEY, address, config, adapter, 0.0);
+}
+
+GameServer::GameServer(const yojimbo::Address &address, int maxPlayers, const InputQueueConfig &inputConfig,
+                       ServerTransport transport, int clientMemory)
+    : m_maxPlayers(ClampMaxPlayers(maxPlayers)),
+      m_connectionConfig(m_maxPlayers, clientMemory),
       m_adapter(std::make_unique<GameAdapter>(this)),
-      m_server(yojimbo::GetDefaultAllocator(), DEFAULT_PRIVATE_KEY, address, m_connectionConfig, *m_adapter, 0.0),
+      m_transport(CheckTransport(transport)),
+      m_server(CreateServer(m_transport, address, m_connectionConfig, *m_adapter)),
+#if CIRC_BATCHED_TRANSPORT
+      m_batchedServer(m_transport == ServerTransport::BATCHED || m_transport == ServerTransport::THREADED
+                          ? static_cast<BatchedServer *>(m_server.get())
+                          : nullptr),
+      m_transportReportTime(TRANSPORT_REPORT_INTERVAL),
+#endif
+      m_loopback(nullptr),
       m_time(0.0),
-      m_lastProcessedInput()
+      m_stopRequested(false),
+      m_quantizeSnapshots(true),
+      m_interestManagement(true),
+      m_snapshotMode(SnapshotMode::PER_CLIENT),
+      m_snapshotRate(DEFAULT_SNAPSHOT_RATE),
+      m_snapshotInterval(::GetSnapshotInterval(DEFAULT_SNAPSHOT_RATE)),
+      m_adaptiveSendRate(true),
+      m_snapshotByteBudget(SNAPSHOT_BYTE_BUDGET),
+      m_connectedClients(),
+      m_inputConfig(inputConfig),
+      m_inputQueues(m_maxPlayers, InputQueue(inputConfig.capacity, inputConfig.dropPolicy)),
+      m_sentSnapshots(m_maxPlayers),
+      m_ackedSnapshots(m_maxPlayers, 0),
+      m_interest(m_maxPlayers),
+      m_congestion(m_maxPlayers),
+      m_priority(m_maxPlayers),
+      m_snapshotJobPool(std::make_unique<JobPool>(1)),
+      m_snapshotJobs(),
+      m_needsFoodSync(m_maxPlayers, 0),
+      m_foodEvents(),
+      m_sharedFactory(GetServerAllocator()),
+      m_sharedBody((WorldStateMessage *)m_sharedFactory.CreateMessage((int)GameMessageType::WORLD_STATE)),
+      m_sharedState(),
+      m_sharedBytes((EstimateWorldStateBytes(m_maxPlayers) + 3) & ~3, 0),
+      m_foodGrid(static_cast<float>(WORLD_WIDTH), static_cast<float>(WORLD_HEIGHT), SPATIAL_CELL_SIZE, MAX_FOOD),
+      m_foodCandidates(),
+      m_foodMask(FoodMaskWords(MAX_FOOD), 0),
+      m_playerGrid(static_cast<float>(WORLD_WIDTH), static_cast<float>(WORLD_HEIGHT), SPATIAL_CELL_SIZE, m_maxPlayers),
+      m_playerCandidates(),
+      m_collisionPairs(),
+      m_frameArena()
+#if CIRC_TICK_ALLOC_CHECK
+      ,
+      m_tickAllocations(0),
+      m_allocatingTicks(0),
+      m_allocationFailures(0),
+      m_warmupEndTick(TICK_ALLOC_WARMUP_TICKS)
+#endif
 {
-    m_server.Start(MAX_PLAYERS);
-    if (!m_server.IsRunning())
+    InitializeFood();
+
+    m_connectedClients.reserve(m_maxPlayers);
+    m_snapshotJobs.reserve(m_maxPlayers);
+    m_server->Start(m_maxPlayers);
+    if (!m_server->IsRunning())
     {
         char buffer[256];
         address.ToString(buffer, sizeof(buffer));
         throw std::runtime_error(std::string("Failed to start server at ") + buffer +
                                  ". Port may be in use or address is invalid.");
     }
+    BindClientMemory();
 
     char buffer[256];
     address.ToString(buffer, sizeof(buffer));
-    std::cout << "Server started at " << buffer << std::endl;
+    const char *transportName = "";
+    if (m_transport == ServerTransport::BATCHED)
+        transportName = " (batched transport)";
+    else if (m_transport == ServerTransport::THREADED)
+        transportName = " (batched transport on an I/O thread)";
+    else if (m_transport == ServerTransport::LOOPBACK)
+        transportName = " (loopback only)";
+    std::cout << "Server started at " << buffer << transportName << std::endl;
 }
 
 GameServer::~GameServer()
 {
-    m_server.Stop();
+    // Loopback clients are let go first so Stop does not disconnect them behind the network's back
+    if (m_loopback)
+        m_loopback->DetachServer();
+    m_server->Stop();
+    m_sharedFactory.ReleaseMessage(m_sharedBody);
+    ReportTransportStats();
+    ReportConnectionMemory();
+
+    const MessagePoolStats &pool = GetMessagePoolStats();
+    std::cout << "Message pool: " << pool.hits << " hits, " << pool.misses << " misses, high water "
+              << pool.highWater << " slots" << std::endl;
+
+    const ContainerMemoryStats containers = GetContainerMemoryStats();
+    std::cout << "Container memory: high water " << containers.highWater << " bytes, " << containers.pooled << " of "
+              << containers.allocations << " allocations pooled, " << containers.overflow << " overflowed" << std::endl;
+    for (int i = 0; i < containers.tagCount; ++i)
+    {
+        const ContainerTagStats &tag = containers.tags[i];
+        std::cout << "  " << tag.name << ": " << tag.allocations << " allocations, high water " << tag.highWater
+                  << " bytes" << std::endl;
+    }
+
+    if (GetSnapshotWorkers() > 1)
+    {
+        const JobPoolStats jobs = GetSnapshotJobStats();
+        std::cout << "Snapshot jobs: " << jobs.jobs << " snapshots in " << jobs.runs << " runs on "
+                  << GetSnapshotWorkers() << " workers, " << jobs.steals << " steals" << std::endl;
+    }
+
+#if CIRC_TICK_PROFILER
+    m_profiler.Dump(std::cout);
+#endif
+}
+
+void GameServer::AttachLoopback(LoopbackNetwork &network)
+{
+    m_loopback = &network;
+    m_adapter->SetLoopback(&network);
+    network.AttachServer(m_server.get(), m_maxPlayers);
 }
 
 void GameServer::ClientConnected(int clientIndex)
 {
     std::cout << "Client " << clientIndex << " connected." << std::endl;
 
+    m_connectedClients.push_back(clientIndex);
+    m_needsFoodSync[clientIndex] = 1;
+#if CIRC_TICK_ALLOC_CHECK
+    m_warmupEndTick = m_worldState.serverTick + TICK_ALLOC_WARMUP_TICKS;
+#endif
+    m_congestion[clientIndex].Reset(m_time);
+
     SpawnPlayer(clientIndex);
 }
 
@@ -54,28 +218,60 @@ void GameServer::ClientDisconnected(int clientIndex)
 {
     std::cout << "Client " << clientIndex << " disconnected." << std::endl;
 
-    if (m_worldState.players.erase(clientIndex) > 0)
+    auto it = eastl::find(m_connectedClients.begin(), m_connectedClients.end(), clientIndex);
+    if (it != m_connectedClients.end())
+    {
+        *it = m_connectedClients.back();
+        m_connectedClients.pop_back();
+    }
+
+    // The slot may be reused by a new client whose input sequence starts over
+    m_inputQueues[clientIndex].Reset();
+    m_sentSnapshots[clientIndex].Clear();
+    m_ackedSnapshots[clientIndex] = 0;
+    m_interest.Reset(clientIndex);
+    m_priority.Reset(clientIndex);
+    m_needsFoodSync[clientIndex] = 0;
+#if CIRC_TICK_ALLOC_CHECK
+    m_warmupEndTick = m_worldState.serverTick + TICK_ALLOC_WARMUP_TICKS;
+#endif
+
+    PlayerTable &players = m_worldState.players;
+    const int slot = players.Find(clientIndex);
+    const int last = players.Count() - 1;
+    if (players.Remove(clientIndex))
     {
+        // Grid ids are table slots, and a client dropped mid-tick (a full
+        // reliable channel) leaves the grid in use for interest queries. The
+        // removal moved the last player into `slot`, so follow it there.
+        m_playerGrid.Remove(slot);
+        if (slot != last && m_playerGrid.Contains(last))
+        {
+            m_playerGrid.Remove(last);
+            m_playerGrid.Insert(slot, players.x[slot], players.y[slot]);
+        }
         std::cout << "Player " << clientIndex << " removed from world state." << std::endl;
     }
 }
 
 void GameServer::Run()
 {
-    const double tickRate = 1.0 / 60.0;
+    const double tickRate = 1.0 / TICK_RATE;
     m_time = yojimbo_time();
+#if CIRC_BATCHED_TRANSPORT
+    m_transportReportTime = m_time + TRANSPORT_REPORT_INTERVAL;
+#endif
 
-    for (int j = 0; j < MAX_FOOD; j++)
-    {
-        m_worldState.foodItems[j] = CreateFood();
-    }
-
-    while (m_server.IsRunning())
+    while (m_server->IsRunning() && !m_stopRequested.load(std::memory_order_relaxed))
     {
         double currentTime = yojimbo_time();
 
         if (m_time <= currentTime)
         {
+#if CIRC_TICK_PROFILER
+            // Jitter: how far behind its slot the tick starts
+            m_profiler.Record(TickPhase::TICK_LATENESS, static_cast<uint64_t>((currentTime - m_time) * 1e9));
+#endif
             Update(static_cast<float>(tickRate));
             m_time += tickRate;
         }
@@ -86,36 +282,189 @@ void GameServer::Run()
     }
 }
 
-void GameServer::Update(float dt)
+bool GameServer::Update(float dt)
 {
+    bool allocationFree = true;
+#if CIRC_TICK_PROFILER
+    m_profiler.Update(m_time, std::cout);
+#endif
+#if CIRC_TICK_ALLOC_CHECK
+    const uint64_t allocationsBefore = GetHeapAllocationCount();
+#endif
+    m_frameArena.Reset();
+    CIRC_PROFILE_PHASE(m_profiler, TickPhase::TICK);
+
     m_worldState.serverTick++;
     m_worldState.timestamp = m_time;
 
-    m_server.AdvanceTime(m_time);
-    m_server.ReceivePackets();
-    ProcessMessages();
+    {
+        CIRC_PROFILE_PHASE(m_profiler, TickPhase::ADVANCE_TIME);
+        m_server->AdvanceTime(m_time);
+    }
+    {
+        CIRC_PROFILE_PHASE(m_profiler, TickPhase::RECEIVE_PACKETS);
+        m_server->ReceivePackets();
+    }
+    {
+        CIRC_PROFILE_PHASE(m_profiler, TickPhase::PROCESS_MESSAGES);
+        ProcessMessages();
+    }
+    {
+        CIRC_PROFILE_PHASE(m_profiler, TickPhase::SIMULATE_PLAYERS);
+        SimulatePlayers();
+    }
+    {
+        CIRC_PROFILE_PHASE(m_profiler, TickPhase::HANDLE_GAME_FOOD);
+        HandleGameFood();
+    }
+    {
+        CIRC_PROFILE_PHASE(m_profiler, TickPhase::HANDLE_PLAYER_COLLISIONS);
+        HandlePlayerCollisions();
+    }
+    {
+        CIRC_PROFILE_PHASE(m_profiler, TickPhase::BROADCAST_FOOD_EVENTS);
+        BroadcastFoodEvents();
+    }
+    {
+        CIRC_PROFILE_PHASE(m_profiler, TickPhase::BROADCAST_WORLD_STATE);
+        SnapWorldState();
+        UpdateCongestion();
+        BroadcastWorldState();
+    }
+    {
+        CIRC_PROFILE_PHASE(m_profiler, TickPhase::SEND_PACKETS);
+        m_server->SendPackets();
+    }
+
+#if CIRC_TICK_ALLOC_CHECK
+    m_tickAllocations = GetHeapAllocationCount() - allocationsBefore;
+    if (m_tickAllocations > 0)
+    {
+        m_allocatingTicks++;
+        if (m_worldState.serverTick > m_warmupEndTick)
+        {
+            m_allocationFailures++;
+            allocationFree = false;
+            std::cerr << "ERROR: Tick " << m_worldState.serverTick << " made " << m_tickAllocations
+                      << " heap allocations after warm-up" << std::endl;
+        }
+        else
+        {
+            std::cerr << "Tick " << m_worldState.serverTick << " made " << m_tickAllocations
+                      << " heap allocations while warming up" << std::endl;
+        }
+    }
+#endif
 
-    HandleGameFood();
-    HandlePlayerCollisions();
+#if CIRC_BATCHED_TRANSPORT
+    if (m_batchedServer && m_time >= m_transportReportTime)
+    {
+        ReportTransportStats();
+        m_transportReportTime = m_time + TRANSPORT_REPORT_INTERVAL;
+    }
+#endif
+    return allocationFree;
+}
 
-    BroadcastWorldState();
-    m_server.SendPackets();
+#if CIRC_BATCHED_TRANSPORT
+bool GameServer::GetTransportStats(TransportStats &stats) const
+{
+    if (!m_batchedServer)
+        return false;
+    stats = m_batchedServer->GetTransportStats();
+    return true;
+}
+
+const NetworkThread *GameServer::GetNetworkThread() const
+{
+    return m_batchedServer ? m_batchedServer->GetNetworkThread() : nullptr;
+}
+#endif
+
+void GameServer::BindClientMemory()
+{
+    // A block from each slot's allocator tells the adapter which one it is
+    m_adapter->BeginClientMemoryBinding();
+    for (int i = 0; i < m_maxPlayers; ++i)
+    {
+        uint8_t *probe = m_server->AllocateBlock(i, 1);
+        if (probe)
+        {
+            m_adapter->BindClientMemory(i, probe);
+            m_server->FreeBlock(i, probe);
+        }
+    }
+    m_adapter->EndClientMemoryBinding();
+}
+
+int GameServer::GetRecommendedClientMemory() const
+{
+    uint64_t peak = 0;
+    for (int i = 0; i < m_maxPlayers; ++i)
+        peak = eastl::max(peak, GetClientMemoryStats(i).highWater);
+    return RecommendConnectionMemory(peak);
+}
+
+void GameServer::ReportConnectionMemory()
+{
+    uint64_t peak = 0;
+    uint64_t failures = 0;
+    int busiest = 0;
+    for (int i = 0; i < m_maxPlayers; ++i)
+    {
+        const ConnectionMemoryStats &stats = GetClientMemoryStats(i);
+        if (stats.highWater > peak)
+        {
+            peak = stats.highWater;
+            busiest = i;
+        }
+        failures += stats.failures;
+    }
+
+    std::cout << "Connection memory: " << m_connectionConfig.serverPerClientMemory / 1024 << " KB per client x "
+              << m_maxPlayers << ", peak " << peak / 1024 << " KB (client " << busiest << "), "
+              << failures << " failed allocations; recommended " << GetRecommendedClientMemory() / 1024 << " KB"
+              << std::endl;
+    const ConnectionMemoryStats &global = GetGlobalMemoryStats();
+    std::cout << "Global connection memory: " << global.budget / 1024 << " KB, peak " << global.highWater / 1024
+              << " KB" << std::endl;
+}
+
+void GameServer::ReportTransportStats()
+{
+#if CIRC_BATCHED_TRANSPORT
+    TransportStats stats;
+    if (!GetTransportStats(stats))
+        return;
+
+    std::cout << "Transport: " << stats.Syscalls() << " syscalls, "
+              << stats.packetsSent << " packets sent (" << stats.PacketsPerSend() << "/sendmmsg, max "
+              << stats.maxSendBatch << "), " << stats.packetsReceived << " received ("
+              << stats.PacketsPerReceive() << "/recvmmsg, max " << stats.maxReceiveBatch << "), "
+              << stats.sendErrors << " send errors, " << stats.sendDropped << " dropped on a full send buffer"
+              << std::endl;
+
+    if (const NetworkThread *ioThread = GetNetworkThread())
+    {
+        const NetworkThreadStats rings = ioThread->GetStats();
+        std::cout << "I/O thread: " << rings.wakeups << " wakeups, " << rings.outboundDropped
+                  << " packets dropped on a full send ring, " << rings.inboundStalls << " stalls on a full receive ring"
+                  << std::endl;
+    }
+#endif
 }
 
 void GameServer::ProcessMessages()
 {
-    for (int clientIndex = 0; clientIndex < MAX_PLAYERS; ++clientIndex)
+    for (int clientIndex : m_connectedClients)
     {
-        if (m_server.IsClientConnected(clientIndex))
+        for (int channelIndex = 0; channelIndex < m_connectionConfig.numChannels; ++channelIndex)
         {
-            for (int channelIndex = 0; channelIndex < m_connectionConfig.numChannels; ++channelIndex)
+            yojimbo::Message *message;
+            while ((message = m_server->ReceiveMessage(clientIndex, channelIndex)) != nullptr)
             {
-                yojimbo::Message *message;
-                while ((message = m_server.ReceiveMessage(clientIndex, channelIndex)) != nullptr)
-                {
-                    ProcessClientMessage(clientIndex, message);
-                    m_server.ReleaseMessage(clientIndex, message);
-                }
+                ProcessClientMessage(clientIndex, message);
+                m_server->ReleaseMessage(clientIndex, message);
             }
         }
     }
@@ -130,6 +479,16 @@ void GameServer::ProcessClientMessage(int clientIndex, yojimbo::Message *message
         ReceivePlayerInputMessage(clientIndex, static_cast<PlayerInputMessage *>(message));
         break;
     }
+    case (int)GameMessageType::PLAYER_INPUT_BATCH:
+    {
+        ReceivePlayerInputBatchMessage(clientIndex, static_cast<PlayerInputBatchMessage *>(message));
+        break;
+    }
+    case (int)GameMessageType::SNAPSHOT_ACK:
+    {
+        ReceiveSnapshotAckMessage(clientIndex, static_cast<SnapshotAckMessage *>(message));
+        break;
+    }
     default:
         std::cout << "Unknown message type from client " << clientIndex << std::endl;
         break;
@@ -138,40 +497,51 @@ void GameServer::ProcessClientMessage(int clientIndex, yojimbo::Message *message
 
 void GameServer::ReceivePlayerInputMessage(int clientIndex, PlayerInputMessage *message)
 {
-    m_lastProcessedInput[clientIndex] = message->sequenceNumber;
+    // Only buffered here; movement happens once per tick in SimulatePlayers
+    m_inputQueues[clientIndex].Push(message->sequenceNumber, message->moveX, message->moveY);
+}
 
-    if (m_worldState.players.find(clientIndex) == m_worldState.players.end())
+void GameServer::ReceivePlayerInputBatchMessage(int clientIndex, PlayerInputBatchMessage *message)
+{
+    // Oldest first; inputs already queued or consumed from earlier batches are dropped by sequence
+    InputQueue &queue = m_inputQueues[clientIndex];
+    for (int i = 0; i < message->numInputs; ++i)
     {
-        return;
+        queue.Push(message->sequence[i], message->moveX[i], message->moveY[i]);
     }
+}
 
-    float moveX = message->moveX;
-    float moveY = message->moveY;
-
-    float length = std::sqrt(moveX * moveX + moveY * moveY);
-    if (length > 0.0f)
+void GameServer::ReceiveSnapshotAckMessage(int clientIndex, SnapshotAckMessage *message)
+{
+    // Acks travel unordered, so an older one must not replace a newer baseline
+    if (message->serverTick > m_ackedSnapshots[clientIndex] && message->serverTick <= m_worldState.serverTick)
     {
-        moveX /= length;
-        moveY /= length;
+        m_ackedSnapshots[clientIndex] = message->serverTick;
     }
+}
 
-    const float moveSpeed = 200.0f;
-    m_worldState.players[clientIndex].velocity.x = moveX * moveSpeed;
-    m_worldState.players[clientIndex].velocity.y = moveY * moveSpeed;
+void GameServer::SimulatePlayers()
+{
+    for (int clientIndex : m_connectedClients)
+    {
+        int slot = m_worldState.players.Find(clientIndex);
+        if (slot < 0)
+            continue;
 
-    const float dt = 1.0f / 60.0f;
-    m_worldState.players[clientIndex].position.x += m_worldState.players[clientIndex].velocity.x * dt;
-    m_worldState.players[clientIndex].position.y += m_worldState.players[clientIndex].velocity.y * dt;
+        InputQueue &queue = m_inputQueues[clientIndex];
+        QueuedInput input;
+        for (int step = 0; step < m_inputConfig.maxInputsPerTick && queue.Pop(input); ++step)
+        {
+            ApplyPlayerInput(slot, input);
+        }
+    }
+}
 
-    // Clamp to world bounds
-    if (m_worldState.players[clientIndex].position.x < 0.0f)
-        m_worldState.players[clientIndex].position.x = 0.0f;
-    if (m_worldState.players[clientIndex].position.x > WORLD_WIDTH)
-        m_worldState.players[clientIndex].position.x = WORLD_WIDTH;
-    if (m_worldState.players[clientIndex].position.y < 0.0f)
-        m_worldState.players[clientIndex].position.y = 0.0f;
-    if (m_worldState.players[clientIndex].position.y > WORLD_HEIGHT)
-        m_worldState.players[clientIndex].position.y = WORLD_HEIGHT;
+void GameServer::ApplyPlayerInput(int slot, const QueuedInput &input)
+{
+    PlayerTable &players = m_worldState.players;
+    StepPlayerMovement(players.x[slot], players.y[slot], players.velX[slot], players.velY[slot],
+                       input.moveX, input.moveY, INPUT_STEP_DT, m_quantizeSnapshots);
 }
 
 void GameServer::SpawnPlayer(int clientIndex)
@@ -187,61 +557,340 @@ void GameServer::SpawnPlayer(int clientIndex)
     player.size = 10.0f;                                           // Default size
     player.color = color;
 
-    m_worldState.players[clientIndex] = player;
+    int slot = m_worldState.players.Add(clientIndex);
+    m_worldState.players.Set(slot, player);
 
     std::cout << "Player " << player.id << " spawned for client " << clientIndex << std::endl;
 }
 
+void GameServer::SnapWorldState()
+{
+    PlayerTable &players = m_worldState.players;
+    if (!m_quantizeSnapshots)
+    {
+        // Full precision has no encoding range to clamp to, so growth is capped here
+        for (int slot = 0; slot < players.Count(); ++slot)
+        {
+            players.size[slot] = eastl::min(players.size[slot], MAX_PLAYER_SIZE);
+        }
+        return;
+    }
+
+    // Movement is already snapped per input; this catches growth, respawns and
+    // anything else, so quantized snapshots describe the state exactly. Food
+    // spawns on whole units, which every position encoding represents.
+    for (int slot = 0; slot < players.Count(); ++slot)
+    {
+        players.x[slot] = POSITION_X_QUANTIZATION.Snap(players.x[slot]);
+        players.y[slot] = POSITION_Y_QUANTIZATION.Snap(players.y[slot]);
+        players.velX[slot] = VELOCITY_QUANTIZATION.Snap(players.velX[slot]);
+        players.velY[slot] = VELOCITY_QUANTIZATION.Snap(players.velY[slot]);
+        players.size[slot] = SIZE_QUANTIZATION.Snap(players.size[slot]);
+    }
+}
+
+void GameServer::BroadcastFoodEvents()
+{
+    FrameArenaAllocator frameAllocator(&m_frameArena);
+    FrameVector<int> overflowed(frameAllocator);
+
+    for (int clientIndex : m_connectedClients)
+    {
+        // The sync already holds this tick's respawns, so new clients skip the events
+        bool sent = true;
+        if (m_needsFoodSync[clientIndex])
+        {
+            sent = SendFoodSync(clientIndex);
+            m_needsFoodSync[clientIndex] = 0;
+        }
+        else
+        {
+            for (const FoodEvent &event : m_foodEvents)
+            {
+                if (!(sent = SendFoodEvent(clientIndex, event)))
+                    break;
+            }
+        }
+
+        if (!sent)
+        {
+            overflowed.push_back(clientIndex);
+        }
+    }
+
+    m_foodEvents.clear();
+
+    // A gap in the reliable stream would leave the client's food wrong for good.
+    // Disconnecting calls back into ClientDisconnected, so it waits until here.
+    for (int clientIndex : overflowed)
+    {
+        std::cerr << "ERROR: Reliable channel full for client " << clientIndex << ", disconnecting" << std::endl;
+        m_server->DisconnectClient(clientIndex);
+    }
+}
+
+bool GameServer::SendFoodSync(int clientIndex)
+{
+    if (!m_server->CanSendMessage(clientIndex, (int)GameChannel::RELIABLE))
+        return false;
+
+    FoodSyncMessage *msg = (FoodSyncMessage *)m_server->CreateMessage(clientIndex, (int)GameMessageType::FOOD_SYNC);
+    if (!msg)
+        return false;
+
+    int numFood = static_cast<int>(m_worldState.foodItems.size());
+    msg->numFoodItems = static_cast<uint16_t>(numFood);
+    memcpy(msg->foodX, m_worldState.foodX.data(), numFood * sizeof(float));
+    memcpy(msg->foodY, m_worldState.foodY.data(), numFood * sizeof(float));
+    for (int i = 0; i < numFood; ++i)
+    {
+        msg->foodTier[i] = static_cast<uint8_t>(m_worldState.foodItems[i].tier);
+    }
+
+    m_server->SendMessage(clientIndex, (int)GameChannel::RELIABLE, msg);
+    return true;
+}
+
+bool GameServer::SendFoodEvent(int clientIndex, const FoodEvent &event)
+{
+    if (!m_server->CanSendMessage(clientIndex, (int)GameChannel::RELIABLE))
+        return false;
+
+    FoodEatenMessage *eaten = (FoodEatenMessage *)m_server->CreateMessage(clientIndex, (int)GameMessageType::FOOD_EATEN);
+    if (!eaten)
+        return false;
+    eaten->foodId = event.foodId;
+    eaten->playerId = event.playerId;
+    m_server->SendMessage(clientIndex, (int)GameChannel::RELIABLE, eaten);
+
+    if (!m_server->CanSendMessage(clientIndex, (int)GameChannel::RELIABLE))
+        return false;
+
+    FoodSpawnedMessage *spawned = (FoodSpawnedMessage *)m_server->CreateMessage(clientIndex, (int)GameMessageType::FOOD_SPAWNED);
+    if (!spawned)
+        return false;
+
+    // The slot respawned in the same tick, so its current contents are the new item
+    const FoodItem &food = m_worldState.foodItems[event.foodId];
+    spawned->foodId = event.foodId;
+    spawned->x = food.position.x;
+    spawned->y = food.position.y;
+    spawned->tier = static_cast<uint8_t>(food.tier);
+    m_server->SendMessage(clientIndex, (int)GameChannel::RELIABLE, spawned);
+    return true;
+}
+
+void GameServer::SetSnapshotWorkers(int workers)
+{
+    workers = JobPool::ResolveWorkerCount(workers);
+    if (workers == GetSnapshotWorkers())
+        return;
+    m_snapshotJobPool = std::make_unique<JobPool>(workers);
+    m_interest.SetWorkerCount(workers);
+    m_priority.SetWorkerCount(workers);
+}
+
+void GameServer::SetSnapshotRate(int snapshotRate)
+{
+    m_snapshotRate = snapshotRate;
+    m_snapshotInterval = ::GetSnapshotInterval(snapshotRate);
+}
+
+void GameServer::UpdateCongestion()
+{
+    if (!m_adaptiveSendRate)
+        return;
+
+    for (int clientIndex : m_connectedClients)
+    {
+        yojimbo::NetworkInfo info;
+        m_server->GetNetworkInfo(clientIndex, info);
+
+        CongestionController &congestion = m_congestion[clientIndex];
+        if (congestion.Update(info, m_time))
+        {
+            std::cout << "Client " << clientIndex << " send rate level " << congestion.GetLevel() << " (RTT "
+                      << info.RTT << " ms, loss " << info.packetLoss << "%)" << std::endl;
+        }
+    }
+}
+
 void GameServer::BroadcastWorldState()
 {
-    const int maxClients = m_server.GetMaxClients();
-    for (int clientIndex = 0; clientIndex < maxClients; ++clientIndex)
+    if (m_snapshotMode == SnapshotMode::SHARED)
+    {
+        BroadcastSharedWorldState();
+        return;
+    }
+
+    uint32_t tick = m_worldState.serverTick;
+
+    // The player grid was built for collisions this tick; interest queries reuse it
+    const PlayerTable &players = m_worldState.players;
+    float maxPlayerRadius = 0.0f;
+    for (int slot = 0; slot < players.Count(); ++slot)
     {
-        if (!m_server.IsClientConnected(clientIndex))
+        maxPlayerRadius = eastl::max(maxPlayerRadius, players.size[slot] / 2.0f);
+    }
+
+    // yojimbo stays on this thread: messages are created and sized here,
+    // filled by the pool, then sent here. The connection allocators and the
+    // message pool counters are not thread-safe, so jobs never allocate; a
+    // job only touches its own client's history, interest set and priorities.
+    m_snapshotJobs.clear();
+    for (int clientIndex : m_connectedClients)
+    {
+        int snapshotInterval = m_snapshotInterval * m_congestion[clientIndex].GetIntervalScale();
+        if (!IsSnapshotTick(tick, clientIndex, snapshotInterval))
             continue;
 
-        WorldStateMessage *msg = (WorldStateMessage *)m_server.CreateMessage(clientIndex, (int)GameMessageType::WORLD_STATE);
+        WorldStateMessage *msg = (WorldStateMessage *)m_server->CreateMessage(clientIndex, (int)GameMessageType::WORLD_STATE);
+        if (!msg)
+        {
+            std::cerr << "ERROR: Failed to create WorldStateMessage for client " << clientIndex
+                      << " - message allocator may be out of memory" << std::endl;
+            continue;
+        }
 
-        if (msg)
+        // Room for as many players as the interest filter can let through
+        int numPlayers = players.Count();
+        if (m_interestManagement)
+            numPlayers = eastl::min(numPlayers, eastl::max(1, m_congestion[clientIndex].GetMaxPlayers()));
+        if (!msg->AllocatePlayers(numPlayers))
         {
-            msg->serverTick = m_worldState.serverTick;
-            msg->timestamp = m_worldState.timestamp;
+            std::cerr << "ERROR: Failed to allocate " << numPlayers << " players in WorldStateMessage for client "
+                      << clientIndex << std::endl;
+            m_server->ReleaseMessage(clientIndex, msg);
+            continue;
+        }
+        msg->lastProcessedInputSeq = m_inputQueues[clientIndex].GetLastConsumed();
+        msg->quantized = m_quantizeSnapshots;
+        m_snapshotJobs.push_back({clientIndex, snapshotInterval, msg, numPlayers, false});
+    }
 
-            auto it = m_lastProcessedInput.find(clientIndex);
-            msg->lastProcessedInputSeq = (it != m_lastProcessedInput.end()) ? it->second : 0;
+    m_snapshotJobPool->ParallelFor(static_cast<int>(m_snapshotJobs.size()), [this, maxPlayerRadius](int job, int worker) {
+        BuildSnapshot(m_snapshotJobs[job], maxPlayerRadius, worker);
+    });
 
-            msg->numPlayers = 0;
-            for (const auto &[id, player] : m_worldState.players)
-            {
-                if (msg->numPlayers >= MAX_PLAYERS)
-                    break;
+    for (const SnapshotJob &job : m_snapshotJobs)
+    {
+        if (job.written)
+        {
+            m_server->SendMessage(job.clientIndex, (int)GameChannel::UNRELIABLE, job.message);
+        }
+        else
+        {
+            std::cerr << "ERROR: Snapshot for client " << job.clientIndex << " has " << job.numPlayers
+                      << " players, more than its message was sized for" << std::endl;
+            m_server->ReleaseMessage(job.clientIndex, job.message);
+        }
+    }
+}
 
-                int idx = msg->numPlayers;
-                msg->playerIds[idx] = player.id;
-                msg->playerX[idx] = player.position.x;
-                msg->playerY[idx] = player.position.y;
-                msg->playerVelX[idx] = player.velocity.x;
-                msg->playerVelY[idx] = player.velocity.y;
-                msg->playerSize[idx] = player.size;
-                msg->playerColor[idx] = player.color;
-                msg->numPlayers++;
-            }
+void GameServer::BuildSnapshot(SnapshotJob &job, float maxPlayerRadius, int worker)
+{
+    const int clientIndex = job.clientIndex;
+    const uint32_t tick = m_worldState.serverTick;
 
-            msg->numFoodItems = MAX_FOOD;
-            for (int i = 0; i < msg->numFoodItems; ++i)
-            {
-                msg->foodX[i] = m_worldState.foodItems[i].position.x;
-                msg->foodY[i] = m_worldState.foodItems[i].position.y;
-                msg->foodTier[i] = static_cast<uint8_t>(m_worldState.foodItems[i].tier);
-            }
+    SnapshotHistory &history = m_sentSnapshots[clientIndex];
+    SnapshotState &state = history.Insert(tick);
+    if (m_interestManagement)
+    {
+        m_interest.Build(clientIndex, m_worldState, m_playerGrid, maxPlayerRadius, state,
+                         m_congestion[clientIndex].GetMaxPlayers(), worker);
+    }
+    else
+    {
+        state.CopyFrom(m_worldState);
+    }
 
-            m_server.SendMessage(clientIndex, (int)GameChannel::UNRELIABLE, msg);
+    // Delta against the newest acked snapshot while the client still holds it
+    uint32_t ackedTick = m_ackedSnapshots[clientIndex];
+    const SnapshotState *baseline = nullptr;
+    if (ackedTick != 0 && tick - ackedTick < SNAPSHOT_HISTORY_SIZE)
+    {
+        baseline = history.Find(ackedTick);
+    }
+
+    // Keep the snapshot in one unfragmented packet; the rest waits for later snapshots
+    if (m_snapshotByteBudget > 0)
+    {
+        m_priority.Apply(clientIndex, state, baseline, m_quantizeSnapshots, m_snapshotByteBudget,
+                         job.snapshotInterval / static_cast<float>(TICK_RATE), worker);
+        if (m_interestManagement)
+        {
+            m_interest.Commit(clientIndex, state);
         }
-        else
+    }
+
+    job.numPlayers = state.players.Count();
+    if (!job.message->SetPlayerCount(job.numPlayers))
+    {
+        state.serverTick = 0;
+        return;
+    }
+
+    WriteSnapshot(*job.message, state, baseline);
+    job.written = true;
+}
+
+void GameServer::BroadcastSharedWorldState()
+{
+    uint32_t tick = m_worldState.serverTick;
+
+    // Not staggered: the body is only worth sharing if every client gets it on the same tick
+    if (m_connectedClients.empty() || !IsSnapshotTick(tick, 0, m_snapshotInterval))
+        return;
+
+    // Everything but the input ack is the same for every client, so the body
+    // is serialized once and each client only gets a copy plus its header
+    m_sharedState.CopyFrom(m_worldState);
+    int numPlayers = m_sharedState.players.Count();
+    if (!m_sharedBody || !m_sharedBody->AllocatePlayers(numPlayers))
+    {
+        std::cerr << "ERROR: Failed to allocate " << numPlayers << " players for the shared snapshot" << std::endl;
+        return;
+    }
+    WriteSnapshot(*m_sharedBody, m_sharedState, nullptr);
+    m_sharedBody->lastProcessedInputSeq = 0;
+    m_sharedBody->quantized = m_quantizeSnapshots;
+
+    int bytes = WriteMessageBytes(*m_sharedBody, m_sharedBytes.data(), static_cast<int>(m_sharedBytes.size()));
+    if (bytes == 0)
+    {
+        std::cerr << "ERROR: Failed to serialize the shared snapshot for tick " << tick << std::endl;
+        return;
+    }
+
+    for (int clientIndex : m_connectedClients)
+    {
+        // Congested clients skip some of the shared ticks; the body has no entity budget
+        if (!IsSnapshotTick(tick, 0, m_snapshotInterval * m_congestion[clientIndex].GetIntervalScale()))
+            continue;
+
+        SharedSnapshotMessage *msg = (SharedSnapshotMessage *)m_server->CreateMessage(clientIndex, (int)GameMessageType::SHARED_SNAPSHOT);
+        if (!msg)
         {
-            std::cerr << "ERROR: Failed to create WorldStateMessage for client " << clientIndex
+            std::cerr << "ERROR: Failed to create SharedSnapshotMessage for client " << clientIndex
                       << " - message allocator may be out of memory" << std::endl;
+            continue;
+        }
+
+        // Blocks are owned by the connection's allocator, hence one copy per client
+        uint8_t *block = m_server->AllocateBlock(clientIndex, bytes);
+        if (!block)
+        {
+            std::cerr << "ERROR: Failed to allocate a " << bytes << " byte snapshot block for client " << clientIndex
+                      << std::endl;
+            m_server->ReleaseMessage(clientIndex, msg);
+            continue;
         }
+        memcpy(block, m_sharedBytes.data(), bytes);
+
+        msg->serverTick = tick;
+        msg->lastProcessedInputSeq = m_inputQueues[clientIndex].GetLastConsumed();
+        m_server->AttachBlockToMessage(clientIndex, msg, block, bytes);
+        m_server->SendMessage(clientIndex, (int)GameChannel::UNRELIABLE, msg);
     }
 }
 
@@ -249,24 +898,79 @@ void GameServer::HandleGameFood()
 {
     const float FOOD_SIZE = 5.0f; 
 
-    for (const auto &[id, player] : m_worldState.players)
+    PlayerTable &players = m_worldState.players;
+    for (int slot = 0; slot < players.Count(); ++slot)
     {
-        float collisionRadius = player.size / 2.0f + FOOD_SIZE / 2.0f;
+        Position position = players.GetPosition(slot);
+        float collisionRadius = players.size[slot] / 2.0f + FOOD_SIZE / 2.0f;
         float collisionRadiusSquared = collisionRadius * collisionRadius;
 
-        for (int j = 0; j < MAX_FOOD; j++)
+        int cells = m_foodGrid.CountCellsInRect(position.x - collisionRadius, position.y - collisionRadius,
+                                                position.x + collisionRadius, position.y + collisionRadius);
+        if (cells >= FOOD_KERNEL_MIN_CELLS)
         {
-            if (m_worldState.foodItems[j].position.distanceSquared(player.position) < collisionRadiusSquared)
+            if (FindFoodOverlaps(m_worldState.foodX.data(), m_worldState.foodY.data(), MAX_FOOD,
+                                 position.x, position.y, collisionRadiusSquared, m_foodMask.data()) == 0)
+                continue;
+
+            for (int word = 0; word < static_cast<int>(m_foodMask.size()); ++word)
+            {
+                for (uint64_t bits = m_foodMask[word]; bits != 0; bits &= bits - 1)
+                {
+                    uint32_t j = word * 64 + __builtin_ctzll(bits);
+                    players.size[slot] += m_worldState.foodItems[j].value;
+                    EatFood(j, players.ids[slot]);
+                }
+            }
+            continue;
+        }
+
+        // Only the grid cells under the player's collision circle can hold food it touches
+        m_foodCandidates.clear();
+        m_foodGrid.QueryRadius(position.x, position.y, collisionRadius, m_foodCandidates);
+
+        for (uint32_t j : m_foodCandidates)
+        {
+            Position foodPosition(m_worldState.foodX[j], m_worldState.foodY[j]);
+            if (foodPosition.distanceSquared(position) < collisionRadiusSquared)
             {
                 float growthAmount = m_worldState.foodItems[j].value;
-                m_worldState.players[id].size += growthAmount;
+                players.size[slot] += growthAmount;
 
-                m_worldState.foodItems[j] = CreateFood();
+                EatFood(j, players.ids[slot]);
             }
         }
     }
 }
 
+void GameServer::EatFood(uint32_t foodIndex, uint32_t playerId)
+{
+    RespawnFood(foodIndex);
+    m_foodEvents.push_back({foodIndex, playerId});
+}
+
+void GameServer::InitializeFood()
+{
+    m_worldState.foodItems.resize(MAX_FOOD);
+    m_worldState.foodX.resize(MAX_FOOD);
+    m_worldState.foodY.resize(MAX_FOOD);
+    m_foodGrid.Clear();
+
+    for (uint32_t j = 0; j < MAX_FOOD; j++)
+    {
+        RespawnFood(j);
+    }
+}
+
+void GameServer::RespawnFood(uint32_t foodIndex)
+{
+    FoodItem& food = m_worldState.foodItems[foodIndex];
+    food = CreateFood();
+    m_worldState.foodX[foodIndex] = food.position.x;
+    m_worldState.foodY[foodIndex] = food.position.y;
+    m_foodGrid.Move(foodIndex, food.position.x, food.position.y);
+}
+
 FoodItem GameServer::CreateFood()
 {
     float x = static_cast<float>(rand() % WORLD_WIDTH);
@@ -288,64 +992,97 @@ FoodItem GameServer::CreateFood()
 
 void GameServer::RespawnPlayer(uint32_t playerId)
 {
-    auto it = m_worldState.players.find(playerId);
-    if (it == m_worldState.players.end())
+    PlayerTable &players = m_worldState.players;
+    int slot = players.Find(playerId);
+    if (slot < 0)
         return;
 
-    Player& player = it->second;
-
-    player.position.x = static_cast<float>(rand() % WORLD_WIDTH);
-    player.position.y = static_cast<float>(rand() % WORLD_HEIGHT);
-    player.velocity.x = 0.0f;
-    player.velocity.y = 0.0f;
-    player.size = 10.0f;
+    players.x[slot] = static_cast<float>(rand() % WORLD_WIDTH);
+    players.y[slot] = static_cast<float>(rand() % WORLD_HEIGHT);
+    players.velX[slot] = 0.0f;
+    players.velY[slot] = 0.0f;
+    players.size[slot] = 10.0f;
 
+    // Keep the grid current for this tick's interest queries
+    m_playerGrid.Move(slot, players.x[slot], players.y[slot]);
 
     std::cout << "Player " << playerId << " respawned at ("
-              << player.position.x << ", " << player.position.y << ")" << std::endl;
+              << players.x[slot] << ", " << players.y[slot] << ")" << std::endl;
 }
 
-void GameServer::HandlePlayerCollisions()
+void GameServer::FindCollisionPairs()
 {
-    eastl::vector<uint32_t> playersToRespawn;
+    m_collisionPairs.clear();
 
-    for (auto it1 = m_worldState.players.begin(); it1 != m_worldState.players.end(); ++it1)
+    // Players move every tick, so the grid is rebuilt rather than updated
+    // Grid ids are table slots; nothing is added or removed until the pairs are resolved
+    const PlayerTable &players = m_worldState.players;
+    m_playerGrid.Clear();
+    float maxRadius = 0.0f;
+    for (int slot = 0; slot < players.Count(); ++slot)
     {
-        auto it2 = it1;
-        ++it2;
-        for (; it2 != m_worldState.players.end(); ++it2)
+        m_playerGrid.Insert(slot, players.x[slot], players.y[slot]);
+        maxRadius = eastl::max(maxRadius, players.size[slot] / 2.0f);
+    }
+
+    // Players are bucketed by center, so widen each query by the largest
+    // radius to catch every neighbour whose circle can reach this one
+    for (int slot = 0; slot < players.Count(); ++slot)
+    {
+        m_playerCandidates.clear();
+        m_playerGrid.QueryRadius(players.x[slot], players.y[slot], players.size[slot] / 2.0f + maxRadius, m_playerCandidates);
+
+        for (uint32_t otherSlot : m_playerCandidates)
         {
-            Player& player1 = it1->second;
-            Player& player2 = it2->second;
+            if (otherSlot > static_cast<uint32_t>(slot))
+            {
+                m_collisionPairs.push_back({static_cast<uint32_t>(slot), otherSlot});
+            }
+        }
+    }
+}
 
-            float distSquared = player1.position.distanceSquared(player2.position);
+void GameServer::HandlePlayerCollisions()
+{
+    FrameArenaAllocator frameAllocator(&m_frameArena);
+    FrameVector<uint32_t> playersToRespawn(frameAllocator);
 
-            float collisionRadius = (player1.size + player2.size) / 2.0f;
-            float collisionRadiusSquared = collisionRadius * collisionRadius;
+    FindCollisionPairs();
 
-            if (distSquared < collisionRadiusSquared)
-            {
-                const float SIZE_ADVANTAGE = 1.1f;
+    PlayerTable &players = m_worldState.players;
+    for (const CollisionPair& pair : m_collisionPairs)
+    {
+        uint32_t slot1 = pair.first;
+        uint32_t slot2 = pair.second;
 
-                if (player1.size > player2.size * SIZE_ADVANTAGE)
-                {
-                    float growthAmount = player2.size * 0.5f; 
+        float distSquared = players.GetPosition(slot1).distanceSquared(players.GetPosition(slot2));
 
-                    std::cout << "Player " << player1.id << " (size " << player1.size - growthAmount
-                              << ") ate Player " << player2.id << " (size " << player2.size << ")" << std::endl;
+        float collisionRadius = (players.size[slot1] + players.size[slot2]) / 2.0f;
+        float collisionRadiusSquared = collisionRadius * collisionRadius;
 
-                    playersToRespawn.push_back(player2.id);
-                }
-                else if (player2.size > player1.size * SIZE_ADVANTAGE)
-                {
-                    float growthAmount = player1.size * 0.5f;
-                    player2.size += growthAmount;
+        if (distSquared < collisionRadiusSquared)
+        {
+            const float SIZE_ADVANTAGE = 1.1f;
 
-                    std::cout << "Player " << player2.id << " (size " << player2.size - growthAmount
-                              << ") ate Player " << player1.id << " (size " << player1.size << ")" << std::endl;
+            if (players.size[slot1] > players.size[slot2] * SIZE_ADVANTAGE)
+            {
+                float growthAmount = players.size[slot2] * 0.5f;
+                players.size[slot1] += growthAmount;
 
-                    playersToRespawn.push_back(player1.id);
-                }
+                std::cout << "Player " << players.ids[slot1] << " (size " << players.size[slot1] - growthAmount
+                          << ") ate Player " << players.ids[slot2] << " (size " << players.size[slot2] << ")" << std::endl;
+
+                playersToRespawn.push_back(players.ids[slot2]);
+            }
+            else if (players.size[slot2] > players.size[slot1] * SIZE_ADVANTAGE)
+            {
+                float growthAmount = players.size[slot1] * 0.5f;
+                players.size[slot2] += growthAmount;
+
+                std::cout << "Player " << players.ids[slot2] << " (size " << players.size[slot2] - growthAmount
+                          << ") ate Player " << players.ids[slot1] << " (size " << players.size[slot1] << ")" << std::endl;
+
+                playersToRespawn.push_back(players.ids[slot1]);
             }
         }
     }
@@ -1,50 +1,249 @@
 #pragma once
+#include <atomic>
 #include <memory>
 #include <iostream>
 #include <stdexcept>
 #include <yojimbo.h>
 #include "../common/protocol.hpp"
-#include <EASTL/unordered_map.h>
+#include "../common/snapshot.hpp"
+#include "spatial_grid.hpp"
+#include "food_kernel.hpp"
+#include "input_queue.hpp"
+#include "tick_profiler.hpp"
+#include "interest.hpp"
+#include "congestion.hpp"
+#include "priority.hpp"
+#include "batched_server.hpp"
+#include "frame_arena.hpp"
+#include "job_pool.hpp"
+#include "../common/heap_counter.hpp"
+#include "../common/eastl_allocator.hpp"
 #include <EASTL/vector.h>
 
+// A food item eaten this tick; its slot has already respawned
+struct FoodEvent
+{
+    uint32_t foodId;
+    uint32_t playerId;
+};
+
+// How BroadcastWorldState builds each tick's snapshots
+enum class SnapshotMode
+{
+    PER_CLIENT, // Interest-filtered deltas, serialized separately for every client
+    SHARED      // The whole world serialized once per tick, copied to every client
+};
+
+// Which UDP path the server runs on, chosen at startup
+enum class ServerTransport
+{
+    SOCKET,   // yojimbo::Server: one sendto/recvfrom per packet
+    BATCHED,  // BatchedServer: recvmmsg/sendmmsg batches (Linux only, falls back to SOCKET elsewhere)
+    THREADED, // BATCHED with the socket on a NetworkThread, so ticks make no socket syscalls
+    LOOPBACK  // No socket: only clients of an attached LoopbackNetwork can connect (tests, benchmarks)
+};
+
+static const double TRANSPORT_REPORT_INTERVAL = 10.0; // Seconds between transport stats lines
+#if CIRC_TICK_ALLOC_CHECK
+// Ticks after start, or after a client joins or leaves, that may still grow
+// containers to their working size without failing the allocation check
+static const uint32_t TICK_ALLOC_WARMUP_TICKS = 2 * TICK_RATE;
+#endif
+
+// One client's WorldStateMessage for this tick. The message is created,
+// sized and sent on the tick thread; in between a JobPool worker fills it.
+struct SnapshotJob
+{
+    int clientIndex;
+    int snapshotInterval;
+    WorldStateMessage *message;
+    int numPlayers; // Room allocated on the tick thread, then the players written
+    bool written;   // False when the snapshot had more players than that room
+};
+
+// Two players whose grid cells are close enough that they may overlap
+struct CollisionPair
+{
+    uint32_t first;
+    uint32_t second;
+};
+
 class GameServer
 {
 public:
-    GameServer(const yojimbo::Address &address);
+    GameServer(const yojimbo::Address &address, int maxPlayers = DEFAULT_MAX_PLAYERS,
+               const InputQueueConfig &inputConfig = InputQueueConfig(),
+               ServerTransport transport = ServerTransport::SOCKET, int clientMemory = 0);
     ~GameServer();
 
+    // Ticks in real time until RequestStop is called (from any thread) or the server stops
     void Run();
-    void Update(float dt);
+    void RequestStop() { m_stopRequested.store(true, std::memory_order_relaxed); }
+    // False when a CIRC_TICK_ALLOC_CHECK build saw the tick allocate after warm-up
+    bool Update(float dt);
     void ClientConnected(int clientIndex);
     void ClientDisconnected(int clientIndex);
 
-    bool IsRunning() const { return m_server.IsRunning(); }
-    int GetConnectedClientCount() const
-    {
-        int count = 0;
-        for (int i = 0; i < MAX_PLAYERS; ++i)
-        {
-            if (m_server.IsClientConnected(i)) count++;
-        }
-        return count;
-    }
+    bool IsRunning() const { return m_server->IsRunning(); }
+    int GetMaxPlayers() const { return m_maxPlayers; }
+    int GetConnectedClientCount() const { return static_cast<int>(m_connectedClients.size()); }
+    const InputQueue &GetInputQueue(int clientIndex) const { return m_inputQueues[clientIndex]; }
+
+    // Quantized snapshots (the default) snap the simulation onto the wire encoding
+    void SetQuantizeSnapshots(bool quantize) { m_quantizeSnapshots = quantize; }
+    bool GetQuantizeSnapshots() const { return m_quantizeSnapshots; }
+    // With interest management on (the default) each client only receives what is near its player
+    void SetInterestManagement(bool enabled) { m_interestManagement = enabled; }
+    bool GetInterestManagement() const { return m_interestManagement; }
+    // SHARED trades bandwidth (no deltas or interest filtering) for O(1) serialization per tick
+    void SetSnapshotMode(SnapshotMode mode) { m_snapshotMode = mode; }
+    SnapshotMode GetSnapshotMode() const { return m_snapshotMode; }
+    // Snapshots per second each client receives, independent of the simulation tick.
+    // Clients are staggered across ticks, so lower rates also spread the serialization cost.
+    void SetSnapshotRate(int snapshotRate);
+    int GetSnapshotRate() const { return m_snapshotRate; }
+    int GetSnapshotInterval() const { return m_snapshotInterval; }
+    // With adaptive send rates on (the default) congested clients get fewer, smaller snapshots
+    void SetAdaptiveSendRate(bool enabled) { m_adaptiveSendRate = enabled; }
+    bool GetAdaptiveSendRate() const { return m_adaptiveSendRate; }
+    const CongestionController &GetCongestion(int clientIndex) const { return m_congestion[clientIndex]; }
+    // Per-client snapshot size cap in bytes, filled in priority order (0 for no cap)
+    void SetSnapshotByteBudget(int bytes) { m_snapshotByteBudget = bytes; }
+    int GetSnapshotByteBudget() const { return m_snapshotByteBudget; }
+    // Threads that build PER_CLIENT snapshots, the tick thread included (1, the
+    // default, builds them inline; 0 uses one per hardware thread)
+    void SetSnapshotWorkers(int workers);
+    int GetSnapshotWorkers() const { return m_snapshotJobPool->GetWorkerCount(); }
+    JobPoolStats GetSnapshotJobStats() const { return m_snapshotJobPool->GetStats(); }
+    // Serves clients of `network` in-process; Run is not used then, the caller
+    // drives Update and SetTime from the network's clock
+    void AttachLoopback(LoopbackNetwork &network);
+    void SetTime(double time) { m_time = time; }
+    // Pooled message allocations of every client connection
+    const MessagePoolStats &GetMessagePoolStats() const { return m_adapter->GetPoolStats(); }
+    ServerTransport GetTransport() const { return m_transport; }
+    // Each client slot's connection block: its size, live bytes and peak. A
+    // measured run's GetRecommendedClientMemory is a good `clientMemory` for
+    // the constructor; 0 there keeps the estimate from GameConnectionConfig.
+    const ConnectionMemoryStats &GetClientMemoryStats(int i) const { return m_adapter->GetClientMemoryStats(i); }
+    const ConnectionMemoryStats &GetGlobalMemoryStats() const { return m_adapter->GetGlobalMemoryStats(); }
+    int GetRecommendedClientMemory() const;
+#if CIRC_BATCHED_TRANSPORT
+    // Syscall and batch counters of the batched transports; false on SOCKET
+    bool GetTransportStats(TransportStats &stats) const;
+    // Ring counters of the THREADED transport, or null
+    const NetworkThread *GetNetworkThread() const;
+#endif
+    // Per-tick temporaries; reset at the top of every Update
+    const FrameArena &GetFrameArena() const { return m_frameArena; }
+#if CIRC_TICK_ALLOC_CHECK
+    // Heap allocations made by the last Update, ticks that made any, and
+    // those of them past warm-up, which Update reports as failures
+    uint64_t GetTickAllocations() const { return m_tickAllocations; }
+    uint64_t GetAllocatingTicks() const { return m_allocatingTicks; }
+    uint64_t GetTickAllocationFailures() const { return m_allocationFailures; }
+#endif
+#if CIRC_TICK_PROFILER
+    TickProfiler &GetProfiler() { return m_profiler; }
+#endif
 
 private:
+    int m_maxPlayers;
     GameConnectionConfig m_connectionConfig;
     std::unique_ptr<GameAdapter> m_adapter;
-    yojimbo::Server m_server;
+    ServerTransport m_transport;
+    std::unique_ptr<yojimbo::BaseServer> m_server;
+#if CIRC_BATCHED_TRANSPORT
+    BatchedServer *m_batchedServer; // m_server when the transport is BATCHED or THREADED
+    double m_transportReportTime;
+#endif
+    LoopbackNetwork *m_loopback;
     double m_time;
+    std::atomic<bool> m_stopRequested;
     WorldState m_worldState;
+    bool m_quantizeSnapshots;
+    bool m_interestManagement;
+    SnapshotMode m_snapshotMode;
+    int m_snapshotRate;
+    int m_snapshotInterval; // Ticks between two snapshots to the same client
+    bool m_adaptiveSendRate;
+    int m_snapshotByteBudget;
+
+    // Client indices with a live connection, so per-client loops skip empty slots
+    eastl::vector<int> m_connectedClients;
+
+    // Pending inputs per client index, drained by SimulatePlayers once per tick
+    InputQueueConfig m_inputConfig;
+    eastl::vector<InputQueue> m_inputQueues;
+
+    // Snapshots sent to each client index and the newest one it acknowledged (0 for none)
+    eastl::vector<SnapshotHistory> m_sentSnapshots;
+    eastl::vector<uint32_t> m_ackedSnapshots;
+    InterestFilter m_interest;
+    eastl::vector<CongestionController> m_congestion;
+    PriorityAccumulator m_priority;
+
+    // PER_CLIENT snapshot builds, fanned out over the pool once yojimbo has
+    // handed out every client's message
+    std::unique_ptr<JobPool> m_snapshotJobPool;
+    eastl::vector<SnapshotJob> m_snapshotJobs;
+
+    // Food is replicated by reliable events: a full sync for new clients, then
+    // what was eaten and respawned each tick
+    eastl::vector<uint8_t> m_needsFoodSync;
+    eastl::vector<FoodEvent> m_foodEvents;
+
+    // SHARED mode: the tick's snapshot body, encoded once into m_sharedBytes
+    GameMessageFactory m_sharedFactory;
+    WorldStateMessage *m_sharedBody;
+    SnapshotState m_sharedState;
+    eastl::vector<uint8_t> m_sharedBytes;
+
+    SpatialGrid m_foodGrid;
+    eastl::vector<uint32_t> m_foodCandidates;
+    eastl::vector<uint64_t> m_foodMask;
+
+    SpatialGrid m_playerGrid;
+    eastl::vector<uint32_t> m_playerCandidates;
+    eastl::vector<CollisionPair> m_collisionPairs;
+
+    FrameArena m_frameArena;
+#if CIRC_TICK_ALLOC_CHECK
+    uint64_t m_tickAllocations;
+    uint64_t m_allocatingTicks;
+    uint64_t m_allocationFailures;
+    uint32_t m_warmupEndTick; // Ticks up to this one may still size containers
+#endif
 
-    eastl::unordered_map<int, uint32_t> m_lastProcessedInput;
+#if CIRC_TICK_PROFILER
+    TickProfiler m_profiler;
+#endif
 
+    void ReportTransportStats();
+    void BindClientMemory();
+    void ReportConnectionMemory();
     void ProcessMessages();
     void ProcessClientMessage(int clientIndex, yojimbo::Message *message);
     void ReceivePlayerInputMessage(int clientIndex, PlayerInputMessage *message);
+    void ReceivePlayerInputBatchMessage(int clientIndex, PlayerInputBatchMessage *message);
+    void ReceiveSnapshotAckMessage(int clientIndex, SnapshotAckMessage *message);
+    void SimulatePlayers();
+    void ApplyPlayerInput(int slot, const QueuedInput &input);
     void SpawnPlayer(int clientIndex);
     void RespawnPlayer(uint32_t playerId);
+    void SnapWorldState();
+    void UpdateCongestion();
     void BroadcastWorldState();
+    void BuildSnapshot(SnapshotJob &job, float maxPlayerRadius, int worker);
+    void BroadcastSharedWorldState();
+    void BroadcastFoodEvents();
+    bool SendFoodSync(int clientIndex);
+    bool SendFoodEvent(int clientIndex, const FoodEvent &event);
     void HandleGameFood();
+    void EatFood(uint32_t foodIndex, uint32_t playerId);
     void HandlePlayerCollisions();
+    void FindCollisionPairs();
+    void InitializeFood();
+    void RespawnFood(uint32_t foodIndex);
     FoodItem CreateFood();
 };
\ No newline at end of file
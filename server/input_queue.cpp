@@ -0,0 +1,83 @@
+#include "input_queue.hpp"
+
+InputQueue::InputQueue(int capacity, InputDropPolicy dropPolicy)
+    : m_ring(capacity > 0 ? capacity : 1),
+      m_dropPolicy(dropPolicy),
+      m_head(0),
+      m_count(0),
+      m_hasConsumed(false),
+      m_lastConsumed(0),
+      m_droppedCount(0),
+      m_duplicateCount(0)
+{
+}
+
+bool InputQueue::Push(uint32_t sequenceNumber, float moveX, float moveY)
+{
+    if (m_hasConsumed && sequenceNumber <= m_lastConsumed)
+    {
+        m_droppedCount++;
+        m_duplicateCount++;
+        return false;
+    }
+
+    // Walk back from the newest entry; in-order arrival stops immediately
+    int position = m_count;
+    while (position > 0 && At(position - 1).sequenceNumber > sequenceNumber)
+    {
+        position--;
+    }
+    if (position > 0 && At(position - 1).sequenceNumber == sequenceNumber)
+    {
+        m_droppedCount++;
+        m_duplicateCount++;
+        return false;
+    }
+
+    if (m_count == GetCapacity())
+    {
+        if (m_dropPolicy == InputDropPolicy::DROP_NEWEST || position == 0)
+        {
+            // Either the policy keeps what is queued, or the new input is older than all of it
+            m_droppedCount++;
+            return false;
+        }
+
+        m_head = (m_head + 1) % GetCapacity();
+        m_count--;
+        position--;
+        m_droppedCount++;
+    }
+
+    for (int i = m_count; i > position; --i)
+    {
+        At(i) = At(i - 1);
+    }
+    At(position) = {sequenceNumber, moveX, moveY};
+    m_count++;
+    return true;
+}
+
+bool InputQueue::Pop(QueuedInput &out)
+{
+    if (m_count == 0)
+        return false;
+
+    out = At(0);
+    m_head = (m_head + 1) % GetCapacity();
+    m_count--;
+
+    m_hasConsumed = true;
+    m_lastConsumed = out.sequenceNumber;
+    return true;
+}
+
+void InputQueue::Reset()
+{
+    m_head = 0;
+    m_count = 0;
+    m_hasConsumed = false;
+    m_lastConsumed = 0;
+    m_droppedCount = 0;
+    m_duplicateCount = 0;
+}
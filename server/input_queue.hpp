@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <EASTL/vector.h>
+
+struct QueuedInput
+{
+    uint32_t sequenceNumber;
+    float moveX;
+    float moveY;
+};
+
+// What Push does with a new input when the ring is already full
+enum class InputDropPolicy
+{
+    DROP_OLDEST, // Discard the oldest queued input, keeping latency bounded
+    DROP_NEWEST  // Reject the incoming input, keeping every queued step
+};
+
+struct InputQueueConfig
+{
+    int capacity = 8;         // Inputs buffered per client (8 ticks at 60 Hz)
+    int maxInputsPerTick = 2; // Upper bound on simulation steps per client per tick
+    InputDropPolicy dropPolicy = InputDropPolicy::DROP_OLDEST;
+};
+
+// Fixed-size ring of one client's pending inputs, kept sorted by sequence
+// number. Inputs at or below the last consumed sequence, and duplicates of a
+// queued one, are discarded on arrival, so reordered or resent messages never
+// rewind the simulation.
+class InputQueue
+{
+public:
+    explicit InputQueue(int capacity = InputQueueConfig().capacity,
+                        InputDropPolicy dropPolicy = InputDropPolicy::DROP_OLDEST);
+
+    // Returns false when the input was discarded (stale, duplicate or full)
+    bool Push(uint32_t sequenceNumber, float moveX, float moveY);
+
+    // Removes the oldest queued input
+    bool Pop(QueuedInput &out);
+
+    // Forgets queued inputs and the consumed sequence, e.g. when the slot is reused
+    void Reset();
+
+    int Count() const { return m_count; }
+    int GetCapacity() const { return static_cast<int>(m_ring.size()); }
+    bool HasConsumed() const { return m_hasConsumed; }
+    uint32_t GetLastConsumed() const { return m_lastConsumed; }
+    uint32_t GetDroppedCount() const { return m_droppedCount; }
+    // The stale and duplicate part of the dropped count. Batched input resends
+    // every input several times, so this grows steadily without any loss.
+    uint32_t GetDuplicateCount() const { return m_duplicateCount; }
+
+private:
+    QueuedInput &At(int index) { return m_ring[(m_head + index) % m_ring.size()]; }
+
+    eastl::vector<QueuedInput> m_ring;
+    InputDropPolicy m_dropPolicy;
+    int m_head;
+    int m_count;
+    bool m_hasConsumed;
+    uint32_t m_lastConsumed;
+    uint32_t m_droppedCount;
+    uint32_t m_duplicateCount;
+};
@@ -0,0 +1,113 @@
+#include "interest.hpp"
+#include <EASTL/sort.h>
+
+ViewRect GetViewRect(float x, float y, float size)
+{
+    float zoom = GetViewZoom(size);
+    float halfWidth = VIEW_WIDTH / (2.0f * zoom);
+    float halfHeight = VIEW_HEIGHT / (2.0f * zoom);
+    return {x - halfWidth, y - halfHeight, x + halfWidth, y + halfHeight};
+}
+
+void InterestSet::Clear()
+{
+    memset(m_players, 0, sizeof(m_players));
+}
+
+InterestFilter::InterestFilter(int maxClients, int workers)
+    : m_sets(maxClients),
+      m_scratch(workers < 1 ? 1 : workers)
+{
+}
+
+void InterestFilter::SetWorkerCount(int workers)
+{
+    m_scratch.resize(workers < 1 ? 1 : workers);
+}
+
+void InterestFilter::Reset(int clientIndex)
+{
+    m_sets[clientIndex].Clear();
+}
+
+void InterestFilter::Commit(int clientIndex, const SnapshotState &sent)
+{
+    InterestSet &visible = m_sets[clientIndex];
+    visible.Clear();
+    for (int slot = 0; slot < sent.players.Count(); ++slot)
+    {
+        visible.AddPlayer(sent.players.ids[slot]);
+    }
+}
+
+void InterestFilter::Build(int clientIndex, const WorldState &world, const SpatialGrid &playerGrid,
+                           float maxPlayerRadius, SnapshotState &out, int maxPlayers, int worker)
+{
+    out.serverTick = world.serverTick;
+    out.timestamp = world.timestamp;
+    out.players.Clear();
+
+    InterestSet &visible = m_sets[clientIndex];
+    InterestSet next;
+
+    const PlayerTable &players = world.players;
+    int self = players.Find(static_cast<uint32_t>(clientIndex));
+    if (self < 0)
+    {
+        visible = next;
+        return;
+    }
+
+    ViewRect view = GetViewRect(players.x[self], players.y[self], players.size[self]);
+    ViewRect enter = view.Expanded(INTEREST_ENTER_MARGIN);
+    ViewRect exit = view.Expanded(INTEREST_EXIT_MARGIN);
+
+    out.players.Set(out.players.Add(players.ids[self]), players.Get(self));
+    next.AddPlayer(players.ids[self]);
+
+    // Already visible players are kept until they leave the wider exit area.
+    // Players are bucketed by center, so the query reaches one radius further.
+    eastl::vector<uint32_t> &candidates = m_scratch[worker].candidates;
+    eastl::vector<InterestCandidate> &accepted = m_scratch[worker].accepted;
+    candidates.clear();
+    accepted.clear();
+    ViewRect playerQuery = exit.Expanded(maxPlayerRadius);
+    playerGrid.QueryRect(playerQuery.minX, playerQuery.minY, playerQuery.maxX, playerQuery.maxY, candidates);
+    for (uint32_t slot : candidates)
+    {
+        if (slot == static_cast<uint32_t>(self) || slot >= static_cast<uint32_t>(players.Count()))
+            continue;
+
+        uint32_t id = players.ids[slot];
+        const ViewRect &area = visible.HasPlayer(id) ? exit : enter;
+        if (area.Overlaps(players.x[slot], players.y[slot], players.size[slot] / 2.0f))
+        {
+            float dx = players.x[slot] - players.x[self];
+            float dy = players.y[slot] - players.y[self];
+            accepted.push_back({slot, dx * dx + dy * dy});
+        }
+    }
+
+    // Over budget: keep the nearest. Dropped players are no longer visible, so
+    // they have to pass the enter margin again once the budget allows.
+    int budget = maxPlayers - 1;
+    if (budget < 0)
+        budget = 0;
+    if (static_cast<int>(accepted.size()) > budget)
+    {
+        eastl::nth_element(accepted.begin(), accepted.begin() + budget, accepted.end(),
+                           [](const InterestCandidate &a, const InterestCandidate &b) {
+                               return a.distanceSquared < b.distanceSquared;
+                           });
+        accepted.resize(budget);
+    }
+
+    for (const InterestCandidate &candidate : accepted)
+    {
+        uint32_t id = players.ids[candidate.slot];
+        out.players.Set(out.players.Add(id), players.Get(candidate.slot));
+        next.AddPlayer(id);
+    }
+
+    visible = next;
+}
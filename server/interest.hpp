@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <EASTL/vector.h>
+#include "../common/protocol.hpp"
+#include "../common/snapshot.hpp"
+#include "spatial_grid.hpp"
+
+// Distance beyond the camera edge at which players enter a client's view, and
+// the larger one at which they leave it again. The gap keeps players near the
+// edge from flickering in and out of consecutive snapshots.
+static const float INTEREST_ENTER_MARGIN = 150.0f;
+static const float INTEREST_EXIT_MARGIN = 300.0f;
+
+struct ViewRect
+{
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+
+    ViewRect Expanded(float margin) const { return {minX - margin, minY - margin, maxX + margin, maxY + margin}; }
+
+    // True when a circle of `radius` around (x, y) reaches into the rectangle
+    bool Overlaps(float x, float y, float radius) const
+    {
+        return x + radius >= minX && x - radius <= maxX && y + radius >= minY && y - radius <= maxY;
+    }
+};
+
+// World area the client camera shows once it has settled on a player of `size` at (x, y)
+ViewRect GetViewRect(float x, float y, float size);
+
+// Player ids one client currently sees, one bit each
+class InterestSet
+{
+public:
+    InterestSet() { Clear(); }
+
+    void Clear();
+    bool HasPlayer(uint32_t id) const { return (m_players[id / 64] >> (id % 64)) & 1; }
+    void AddPlayer(uint32_t id) { m_players[id / 64] |= uint64_t(1) << (id % 64); }
+
+private:
+    uint64_t m_players[(MAX_PLAYER_CAPACITY + 63) / 64];
+};
+
+// A player that passed the view test, and its squared distance to the viewer
+struct InterestCandidate
+{
+    uint32_t slot;
+    float distanceSquared;
+};
+
+// Server-side area-of-interest filter. Each client only receives the players
+// around its own player, found through the server's player grid. Food is
+// replicated to everyone through reliable events instead.
+class InterestFilter
+{
+public:
+    explicit InterestFilter(int maxClients, int workers = 1);
+
+    // Scratch for this many concurrent Build calls, one per JobPool worker
+    void SetWorkerCount(int workers);
+
+    // Forgets what the client saw, e.g. when the slot is reused
+    void Reset(int clientIndex);
+
+    // Fills `out` with the players client `clientIndex` should see this tick,
+    // its own first. `playerGrid` holds player table slots bucketed by center
+    // and `maxPlayerRadius` bounds their radii. When more than `maxPlayers`
+    // qualify, only the nearest are kept. Builds for different clients may
+    // run at once as long as each passes its own `worker`.
+    void Build(int clientIndex, const WorldState &world, const SpatialGrid &playerGrid, float maxPlayerRadius,
+               SnapshotState &out, int maxPlayers = MAX_PLAYER_CAPACITY, int worker = 0);
+
+    // Replaces what the client sees with the players of the snapshot actually
+    // sent. Call it after anything that trims Build's output (the priority
+    // byte budget), so players left out do not count as already visible.
+    void Commit(int clientIndex, const SnapshotState &sent);
+
+    const InterestSet &GetInterestSet(int clientIndex) const { return m_sets[clientIndex]; }
+
+private:
+    struct Scratch
+    {
+        eastl::vector<uint32_t> candidates;
+        eastl::vector<InterestCandidate> accepted;
+    };
+
+    eastl::vector<InterestSet> m_sets;
+    eastl::vector<Scratch> m_scratch; // One per worker
+};
@@ -0,0 +1,197 @@
+#include "job_pool.hpp"
+
+static uint64_t PackRange(uint32_t begin, uint32_t end)
+{
+    return (static_cast<uint64_t>(begin) << 32) | end;
+}
+
+static uint32_t RangeBegin(uint64_t range)
+{
+    return static_cast<uint32_t>(range >> 32);
+}
+
+static uint32_t RangeEnd(uint64_t range)
+{
+    return static_cast<uint32_t>(range);
+}
+
+JobPool::JobPool(int workers)
+    : m_workerCount(workers < 1 ? 1 : (workers > MAX_JOB_WORKERS ? MAX_JOB_WORKERS : workers)),
+      m_threads(),
+      m_function(nullptr),
+      m_context(nullptr),
+      m_generation(0),
+      m_stopping(false),
+      m_active(0),
+      m_runs(0),
+      m_jobs(0),
+      m_steals(0)
+{
+    m_threads.reserve(m_workerCount - 1);
+    for (int worker = 1; worker < m_workerCount; ++worker)
+    {
+        m_threads.push_back(std::thread([this, worker]() { WorkerMain(worker); }));
+    }
+}
+
+JobPool::~JobPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread &thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+JobPoolStats JobPool::GetStats() const
+{
+    JobPoolStats stats;
+    stats.runs = m_runs;
+    stats.jobs = m_jobs;
+    stats.steals = m_steals.load(std::memory_order_relaxed);
+    return stats;
+}
+
+int JobPool::ResolveWorkerCount(int requested)
+{
+    int workers = requested;
+    if (workers <= 0)
+        workers = static_cast<int>(std::thread::hardware_concurrency());
+    if (workers < 1)
+        workers = 1;
+    return workers > MAX_JOB_WORKERS ? MAX_JOB_WORKERS : workers;
+}
+
+void JobPool::Run(int count, JobFunction function, const void *context)
+{
+    if (count <= 0)
+        return;
+
+    // Waking the workers costs more than a single job
+    if (m_workerCount == 1 || count == 1)
+    {
+        for (int index = 0; index < count; ++index)
+        {
+            function(context, index, 0);
+        }
+        return;
+    }
+
+    for (int worker = 0; worker < m_workerCount; ++worker)
+    {
+        uint32_t begin = static_cast<uint32_t>(static_cast<int64_t>(count) * worker / m_workerCount);
+        uint32_t end = static_cast<uint32_t>(static_cast<int64_t>(count) * (worker + 1) / m_workerCount);
+        m_ranges[worker].range.store(PackRange(begin, end), std::memory_order_relaxed);
+    }
+    m_active.store(m_workerCount - 1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_function = function;
+        m_context = context;
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    Work(0);
+
+    // Every index is claimed once Work returns; the workers may still be
+    // running their last ones. Waiting for all of them also keeps a slow
+    // worker from stealing out of the next ParallelFor's ranges with this one's job.
+    while (m_active.load(std::memory_order_acquire) != 0)
+    {
+        std::this_thread::yield();
+    }
+
+    m_runs++;
+    m_jobs += count;
+}
+
+void JobPool::WorkerMain(int worker)
+{
+    uint64_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, seen]() { return m_stopping || m_generation != seen; });
+            if (m_stopping)
+                return;
+            seen = m_generation;
+        }
+        Work(worker);
+        m_active.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void JobPool::Work(int worker)
+{
+    int index;
+    do
+    {
+        while (Claim(worker, index))
+        {
+            m_function(m_context, index, worker);
+        }
+    } while (Steal(worker));
+}
+
+bool JobPool::Claim(int worker, int &index)
+{
+    std::atomic<uint64_t> &range = m_ranges[worker].range;
+    uint64_t current = range.load(std::memory_order_acquire);
+    while (RangeBegin(current) < RangeEnd(current))
+    {
+        uint32_t begin = RangeBegin(current);
+        if (range.compare_exchange_weak(current, PackRange(begin + 1, RangeEnd(current)), std::memory_order_acq_rel,
+                                        std::memory_order_acquire))
+        {
+            index = static_cast<int>(begin);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobPool::Steal(int worker)
+{
+    while (true)
+    {
+        // The fullest range is the most likely to still be worth splitting
+        // when the CAS lands
+        int victim = -1;
+        uint64_t victimRange = 0;
+        uint32_t victimSize = 0;
+        for (int other = 0; other < m_workerCount; ++other)
+        {
+            if (other == worker)
+                continue;
+            uint64_t current = m_ranges[other].range.load(std::memory_order_acquire);
+            uint32_t size = RangeEnd(current) > RangeBegin(current) ? RangeEnd(current) - RangeBegin(current) : 0;
+            if (size > victimSize)
+            {
+                victim = other;
+                victimRange = current;
+                victimSize = size;
+            }
+        }
+        if (victim < 0)
+            return false;
+
+        // Take the back half, or the last index when only one is left
+        uint32_t begin = RangeBegin(victimRange);
+        uint32_t end = RangeEnd(victimRange);
+        uint32_t middle = begin + victimSize / 2;
+        if (m_ranges[victim].range.compare_exchange_strong(victimRange, PackRange(begin, middle),
+                                                           std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            // Thieves skip empty ranges, so nothing races this store
+            m_ranges[worker].range.store(PackRange(middle, end), std::memory_order_release);
+            m_steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+}
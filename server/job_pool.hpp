@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <EASTL/vector.h>
+
+static const int MAX_JOB_WORKERS = 64;
+
+struct JobPoolStats
+{
+    uint64_t runs = 0;   // ParallelFor calls that went to the workers
+    uint64_t jobs = 0;   // Indices run by those calls
+    uint64_t steals = 0; // Times a worker took half of another worker's range
+};
+
+// Fixed set of worker threads for data-parallel loops over one tick's work.
+// ParallelFor splits [0, count) into one contiguous range per worker; a
+// worker takes indices from the front of its own range and, once that is
+// empty, steals the back half of the fullest other range, so uneven jobs
+// (a client in a crowd next to one alone) still finish together. The calling
+// thread works as worker 0 and returns once every index has run. Nothing
+// allocates after construction.
+class JobPool
+{
+public:
+    // `workers` counts the calling thread; 1 runs everything inline
+    explicit JobPool(int workers = 1);
+    ~JobPool();
+
+    JobPool(const JobPool &) = delete;
+    JobPool &operator=(const JobPool &) = delete;
+
+    int GetWorkerCount() const { return m_workerCount; }
+    JobPoolStats GetStats() const;
+
+    // Calls job(index, worker) once for every index below `count`. `worker`
+    // is in [0, GetWorkerCount()) and unique among the concurrent calls, so it
+    // can pick per-worker scratch. Not reentrant.
+    template <typename Job>
+    void ParallelFor(int count, const Job &job)
+    {
+        Run(count, &CallJob<Job>, &job);
+    }
+
+    // Worker count for a machine: `requested` when positive, otherwise one per hardware thread
+    static int ResolveWorkerCount(int requested);
+
+private:
+    typedef void (*JobFunction)(const void *context, int index, int worker);
+
+    template <typename Job>
+    static void CallJob(const void *context, int index, int worker)
+    {
+        (*static_cast<const Job *>(context))(index, worker);
+    }
+
+    // One worker's unclaimed indices, packed as begin << 32 | end so that
+    // claiming from the front and stealing from the back are both one CAS
+    struct alignas(64) WorkRange
+    {
+        std::atomic<uint64_t> range;
+        WorkRange() : range(0) {}
+    };
+
+    void Run(int count, JobFunction function, const void *context);
+    void WorkerMain(int worker);
+    void Work(int worker);
+    bool Claim(int worker, int &index);
+    bool Steal(int worker);
+
+    int m_workerCount;
+    WorkRange m_ranges[MAX_JOB_WORKERS];
+    eastl::vector<std::thread> m_threads;
+
+    // The current ParallelFor, published under m_mutex with a new m_generation
+    JobFunction m_function;
+    const void *m_context;
+    uint64_t m_generation;
+    bool m_stopping;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+
+    // Worker threads still inside the current ParallelFor
+    std::atomic<int> m_active;
+
+    uint64_t m_runs;
+    uint64_t m_jobs;
+    std::atomic<uint64_t> m_steals;
+};
@@ -4,9 +4,13 @@
 #include <csignal>
 #include <atomic>
 #include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cmath>
 
 std::atomic<bool> g_running(true);
-std::thread g_serverThread;
 
 void signalHandler(int signal)
 {
@@ -17,8 +21,154 @@ void signalHandler(int signal)
     }
 }
 
+static void PrintUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " [options]" << std::endl
+              << "  --address ADDRESS            Address to bind (default 127.0.0.1)" << std::endl
+              << "  --port PORT                  UDP port (default 40000)" << std::endl
+              << "  --max-players N              Room size, at most " << MAX_PLAYER_CAPACITY << " (default "
+              << DEFAULT_MAX_PLAYERS << ")" << std::endl
+              << "  --transport MODE             socket, batched or threaded (default socket)" << std::endl
+              << "  --snapshot-mode MODE         per-client or shared (default per-client)" << std::endl
+              << "  --snapshot-rate HZ           Snapshots per second, 1 to " << TICK_RATE << " (default "
+              << DEFAULT_SNAPSHOT_RATE << ")"
+              << std::endl
+              << "  --snapshot-workers N         Threads building per-client snapshots; 0 for one per hardware "
+                 "thread (default 1)"
+              << std::endl
+              << "  --client-memory-kb KB        Connection memory per client, e.g. the recommendation printed "
+                 "by an earlier run"
+              << std::endl
+              << "  --container-memory-mb MB     Bound container memory to a TLSF block of this size" << std::endl
+              << "  --profile-interval SECONDS   Tick profile dump interval (CIRC_TICK_PROFILER builds)" << std::endl
+              << "  -h, --help                   Show this help" << std::endl;
+}
+
+// Whole-string base-10 integer within [min, max]
+static bool ParseInt(const char* value, long min, long max, int& out)
+{
+    char* end = nullptr;
+    errno = 0;
+    const long parsed = std::strtol(value, &end, 10);
+    if (errno != 0 || end == value || *end != '\0' || parsed < min || parsed > max)
+        return false;
+    out = static_cast<int>(parsed);
+    return true;
+}
+
+// Whole-string finite number no less than min
+static bool ParseDouble(const char* value, double min, double& out)
+{
+    char* end = nullptr;
+    errno = 0;
+    const double parsed = std::strtod(value, &end);
+    if (errno != 0 || end == value || *end != '\0' || !std::isfinite(parsed) || parsed < min)
+        return false;
+    out = parsed;
+    return true;
+}
+
 int main(int argc, char* argv[])
 {
+    const char* serverAddress = "127.0.0.1";
+    uint16_t serverPort = 40000;
+    int maxPlayers = DEFAULT_MAX_PLAYERS;
+    ServerTransport transport = ServerTransport::SOCKET;
+    SnapshotMode snapshotMode = SnapshotMode::PER_CLIENT;
+    int snapshotRate = 0;        // 0 keeps the server's default
+    int snapshotWorkers = -1;    // -1 keeps the server's default
+    int clientMemoryKB = 0;
+    int containerMemoryMB = 0;
+    double profileInterval = 0.0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* option = argv[i];
+        if (strcmp(option, "-h") == 0 || strcmp(option, "--help") == 0)
+        {
+            PrintUsage(argv[0]);
+            return 0;
+        }
+
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << option << std::endl;
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+
+        bool valid = true;
+        int port = 0;
+        if (strcmp(option, "--address") == 0)
+        {
+            serverAddress = value;
+        }
+        else if (strcmp(option, "--port") == 0)
+        {
+            valid = ParseInt(value, 1, 65535, port);
+            serverPort = static_cast<uint16_t>(port);
+        }
+        else if (strcmp(option, "--max-players") == 0)
+        {
+            valid = ParseInt(value, 1, MAX_PLAYER_CAPACITY, maxPlayers);
+        }
+        else if (strcmp(option, "--transport") == 0 && strcmp(value, "socket") == 0)
+        {
+            transport = ServerTransport::SOCKET;
+        }
+        else if (strcmp(option, "--transport") == 0 && strcmp(value, "batched") == 0)
+        {
+            transport = ServerTransport::BATCHED;
+        }
+        else if (strcmp(option, "--transport") == 0 && strcmp(value, "threaded") == 0)
+        {
+            transport = ServerTransport::THREADED;
+        }
+        else if (strcmp(option, "--snapshot-mode") == 0 && strcmp(value, "per-client") == 0)
+        {
+            snapshotMode = SnapshotMode::PER_CLIENT;
+        }
+        else if (strcmp(option, "--snapshot-mode") == 0 && strcmp(value, "shared") == 0)
+        {
+            snapshotMode = SnapshotMode::SHARED;
+        }
+        else if (strcmp(option, "--snapshot-rate") == 0)
+        {
+            valid = ParseInt(value, 1, TICK_RATE, snapshotRate);
+        }
+        else if (strcmp(option, "--snapshot-workers") == 0)
+        {
+            valid = ParseInt(value, 0, MAX_JOB_WORKERS, snapshotWorkers);
+        }
+        else if (strcmp(option, "--client-memory-kb") == 0)
+        {
+            // Passed on in bytes as an int
+            valid = ParseInt(value, 1, INT_MAX / 1024, clientMemoryKB);
+        }
+        else if (strcmp(option, "--container-memory-mb") == 0)
+        {
+            valid = ParseInt(value, 1, INT_MAX, containerMemoryMB);
+        }
+        else if (strcmp(option, "--profile-interval") == 0)
+        {
+            valid = ParseDouble(value, 0.0, profileInterval);
+        }
+        else
+        {
+            std::cerr << "Unknown option or value: " << option << " " << value << std::endl;
+            PrintUsage(argv[0]);
+            return 1;
+        }
+
+        if (!valid)
+        {
+            std::cerr << "Invalid value for " << option << ": " << value << std::endl;
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
     if (!InitializeYojimbo())
     {
         std::cerr << "Failed to initialize yojimbo" << std::endl;
@@ -28,36 +178,68 @@ int main(int argc, char* argv[])
     std::signal(SIGINT, signalHandler);
     std::signal(SIGTERM, signalHandler);
 
-    const char* serverAddress = "127.0.0.1";
-    uint16_t serverPort = 40000;
-
-    if (argc >= 2)
-    {
-        serverAddress = argv[1];
-    }
-    if (argc >= 3)
+    // Blocks that do not fit the TLSF block spill to the heap and are counted.
+    // Never freed, as containers may still use it during exit.
+    if (containerMemoryMB > 0)
     {
-        serverPort = static_cast<uint16_t>(std::atoi(argv[2]));
+        const size_t bytes = static_cast<size_t>(containerMemoryMB) * 1024 * 1024;
+        if (void* memory = malloc(bytes))
+        {
+            SetContainerAllocator(new yojimbo::TLSF_Allocator(memory, bytes));
+            std::cout << "Container memory: " << containerMemoryMB << " MB TLSF block" << std::endl;
+        }
     }
 
     std::cout << "Starting Agar.io-like Game Server" << std::endl;
     std::cout << "Address: " << serverAddress << ":" << serverPort << std::endl;
-    std::cout << "Max Players: " << MAX_PLAYERS << std::endl;
     std::cout << "Press Ctrl+C to stop the server" << std::endl;
 
+    uint64_t allocationFailures = 0;
     try
     {
         yojimbo::Address address(serverAddress, serverPort);
 
-        GameServer server(address);
+        GameServer server(address, maxPlayers, InputQueueConfig(), transport, clientMemoryKB * 1024);
+        std::cout << "Max Players: " << server.GetMaxPlayers() << std::endl;
 
-        std::thread([&server]() {
+#if CIRC_TICK_PROFILER
+        if (profileInterval > 0.0)
+        {
+            server.GetProfiler().SetDumpInterval(profileInterval);
+        }
+#else
+        (void)profileInterval;
+#endif
+        if (snapshotMode == SnapshotMode::SHARED)
+        {
+            server.SetSnapshotMode(SnapshotMode::SHARED);
+            std::cout << "Snapshot mode: shared" << std::endl;
+        }
+        if (snapshotRate > 0)
+        {
+            server.SetSnapshotRate(snapshotRate);
+        }
+        if (snapshotWorkers >= 0)
+        {
+            server.SetSnapshotWorkers(snapshotWorkers);
+            std::cout << "Snapshot workers: " << server.GetSnapshotWorkers() << std::endl;
+        }
+        std::cout << "Snapshot rate: " << server.GetSnapshotRate() << " Hz (every "
+                  << server.GetSnapshotInterval() << " ticks)" << std::endl;
+
+        // Joined before `server` goes out of scope, so Run never outlives it
+        std::thread serverThread([&server]() {
             server.Run();
-        }).detach();
+        });
         while (g_running)
         {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
+        server.RequestStop();
+        serverThread.join();
+#if CIRC_TICK_ALLOC_CHECK
+        allocationFailures = server.GetTickAllocationFailures();
+#endif
     }
     catch (const std::exception& e)
     {
@@ -67,6 +249,11 @@ int main(int argc, char* argv[])
     }
 
     ShutdownYojimbo();
+    if (allocationFailures > 0)
+    {
+        std::cerr << allocationFailures << " ticks made heap allocations after warm-up" << std::endl;
+        return 1;
+    }
     std::cout << "Server shut down successfully" << std::endl;
 
     return 0;
@@ -0,0 +1,220 @@
+#include "network_thread.hpp"
+
+#if CIRC_BATCHED_TRANSPORT
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+NetworkThread::NetworkThread()
+    : m_socket(),
+      m_inbound(NETWORK_RING_PACKETS),
+      m_outbound(NETWORK_RING_PACKETS),
+      m_thread(),
+      m_running(false),
+      m_wakeHandle(-1),
+      m_pendingSends(0),
+      m_transportStats(),
+      m_inboundStalls(0),
+      m_outboundDropped(0),
+      m_wakeups(0)
+{
+}
+
+NetworkThread::~NetworkThread()
+{
+    Stop();
+}
+
+bool NetworkThread::Start(const sockaddr_storage &address)
+{
+    Stop();
+
+    if (!m_socket.Open(address))
+        return false;
+    m_wakeHandle = eventfd(0, EFD_NONBLOCK);
+    if (m_wakeHandle < 0)
+    {
+        m_socket.Close();
+        return false;
+    }
+
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread([this]() { Run(); });
+    return true;
+}
+
+void NetworkThread::Stop()
+{
+    if (m_thread.joinable())
+    {
+        m_running.store(false, std::memory_order_release);
+        const uint64_t one = 1;
+        ssize_t written = write(m_wakeHandle, &one, sizeof(one));
+        (void)written;
+        m_thread.join();
+    }
+    if (m_wakeHandle >= 0)
+    {
+        close(m_wakeHandle);
+        m_wakeHandle = -1;
+    }
+    m_socket.Close();
+
+    // Whatever is left in the rings belonged to the closed socket
+    while (m_inbound.Front())
+        m_inbound.Pop();
+    while (m_outbound.Front())
+        m_outbound.Pop();
+    m_pendingSends = 0;
+}
+
+void NetworkThread::Send(const sockaddr_storage &to, const uint8_t *data, int bytes)
+{
+    if (bytes <= 0 || bytes > TRANSPORT_MAX_PACKET_BYTES)
+        return;
+
+    NetworkDatagram *packet = m_outbound.BeginPush();
+    if (!packet)
+    {
+        m_outboundDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    packet->address = to;
+    packet->bytes = bytes;
+    memcpy(packet->data, data, bytes);
+    m_outbound.EndPush();
+    m_pendingSends++;
+}
+
+void NetworkThread::Flush()
+{
+    if (m_pendingSends == 0 || m_wakeHandle < 0)
+        return;
+    m_pendingSends = 0;
+    const uint64_t one = 1;
+    ssize_t written = write(m_wakeHandle, &one, sizeof(one));
+    (void)written;
+}
+
+int NetworkThread::Receive(sockaddr_storage &from, uint8_t *data, int capacity)
+{
+    // Datagrams too big for the caller are skipped, as BatchedSocket::Receive does
+    NetworkDatagram *packet;
+    while ((packet = m_inbound.Front()) != nullptr)
+    {
+        const int bytes = packet->bytes;
+        if (bytes <= capacity)
+        {
+            from = packet->address;
+            memcpy(data, packet->data, bytes);
+            m_inbound.Pop();
+            return bytes;
+        }
+        m_inbound.Pop();
+    }
+    return 0;
+}
+
+TransportStats NetworkThread::GetTransportStats() const
+{
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_transportStats;
+}
+
+NetworkThreadStats NetworkThread::GetStats() const
+{
+    NetworkThreadStats stats;
+    stats.inboundStalls = m_inboundStalls.load(std::memory_order_relaxed);
+    stats.outboundDropped = m_outboundDropped.load(std::memory_order_relaxed);
+    stats.wakeups = m_wakeups.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void NetworkThread::Run()
+{
+    while (m_running.load(std::memory_order_acquire))
+    {
+        // Outbound first: a finished tick's packets are what is waiting longest
+        bool busy = DrainOutbound();
+        bool inboundFull = false;
+        busy |= FillInbound(inboundFull);
+
+        if (busy)
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_transportStats = m_socket.GetStats();
+        }
+        else
+        {
+            // With the inbound ring full, waiting on the socket would spin on
+            // packets that have nowhere to go; wait for the simulation instead
+            Wait(!inboundFull);
+        }
+    }
+
+    // Packets queued by the last tick still go out
+    DrainOutbound();
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_transportStats = m_socket.GetStats();
+}
+
+bool NetworkThread::DrainOutbound()
+{
+    bool sent = false;
+    NetworkDatagram *packet;
+    while ((packet = m_outbound.Front()) != nullptr)
+    {
+        m_socket.Send(packet->address, packet->data, packet->bytes);
+        m_outbound.Pop();
+        sent = true;
+    }
+    if (sent)
+        m_socket.Flush();
+    return sent;
+}
+
+bool NetworkThread::FillInbound(bool &inboundFull)
+{
+    bool received = false;
+    while (true)
+    {
+        NetworkDatagram *packet = m_inbound.BeginPush();
+        if (!packet)
+        {
+            inboundFull = true;
+            m_inboundStalls.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        const int bytes = m_socket.Receive(packet->address, packet->data, sizeof(packet->data));
+        if (bytes <= 0)
+            break;
+        packet->bytes = bytes;
+        m_inbound.EndPush();
+        received = true;
+    }
+    return received;
+}
+
+void NetworkThread::Wait(bool pollSocket)
+{
+    pollfd handles[2];
+    handles[0].fd = m_wakeHandle;
+    handles[0].events = POLLIN;
+    handles[0].revents = 0;
+    handles[1].fd = m_socket.GetHandle();
+    handles[1].events = POLLIN;
+    handles[1].revents = 0;
+
+    if (poll(handles, pollSocket ? 2 : 1, NETWORK_THREAD_POLL_MS) > 0)
+    {
+        m_wakeups.fetch_add(1, std::memory_order_relaxed);
+        if (handles[0].revents & POLLIN)
+        {
+            uint64_t count;
+            ssize_t bytes = read(m_wakeHandle, &count, sizeof(count));
+            (void)bytes;
+        }
+    }
+}
+#endif
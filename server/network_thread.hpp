@@ -0,0 +1,77 @@
+#pragma once
+#include "batched_socket.hpp"
+#include "spsc_ring.hpp"
+
+#if CIRC_BATCHED_TRANSPORT
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+static const int NETWORK_RING_PACKETS = 1024;  // Per direction; about two ticks of a full room's traffic
+static const int NETWORK_THREAD_POLL_MS = 5;   // Longest the I/O thread sleeps without a packet or a wake-up
+
+struct NetworkDatagram
+{
+    sockaddr_storage address; // Sender on the way in, destination on the way out
+    int bytes;
+    uint8_t data[TRANSPORT_MAX_PACKET_BYTES];
+};
+
+struct NetworkThreadStats
+{
+    uint64_t inboundStalls = 0;   // Passes that found the inbound ring full; packets wait in the socket meanwhile
+    uint64_t outboundDropped = 0; // No room in the outbound ring. UDP, so dropped like the kernel would.
+    uint64_t wakeups = 0;         // Times the I/O thread woke from poll
+};
+
+// Runs a BatchedSocket on its own thread, so the simulation thread never
+// makes a socket syscall. Received datagrams arrive through one SPSC ring and
+// datagrams to send leave through another. Send, Flush and Receive belong to
+// the simulation thread; the socket belongs to the I/O thread.
+class NetworkThread
+{
+public:
+    NetworkThread();
+    ~NetworkThread();
+
+    NetworkThread(const NetworkThread &) = delete;
+    NetworkThread &operator=(const NetworkThread &) = delete;
+
+    // Binds the socket and starts the thread. Returns false if the socket could not be opened.
+    bool Start(const sockaddr_storage &address);
+    void Stop();
+    bool IsRunning() const { return m_running.load(std::memory_order_acquire); }
+    uint16_t GetPort() const { return m_socket.GetPort(); }
+
+    // Queues a datagram; it leaves on the next Flush, in one sendmmsg with the rest
+    void Send(const sockaddr_storage &to, const uint8_t *data, int bytes);
+    // Wakes the I/O thread if anything was queued since the last Flush
+    void Flush();
+    // Copies the oldest received datagram into `data`. Returns its size, or 0 when none is waiting.
+    int Receive(sockaddr_storage &from, uint8_t *data, int capacity);
+
+    // Socket counters as of the I/O thread's last pass
+    TransportStats GetTransportStats() const;
+    NetworkThreadStats GetStats() const;
+
+private:
+    void Run();
+    bool DrainOutbound();
+    bool FillInbound(bool &inboundFull);
+    void Wait(bool pollSocket);
+
+    BatchedSocket m_socket;
+    SpscRing<NetworkDatagram> m_inbound;
+    SpscRing<NetworkDatagram> m_outbound;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    int m_wakeHandle; // eventfd the simulation thread writes to on Flush
+    int m_pendingSends;
+
+    mutable std::mutex m_statsMutex;
+    TransportStats m_transportStats;
+    std::atomic<uint64_t> m_inboundStalls;
+    std::atomic<uint64_t> m_outboundDropped;
+    std::atomic<uint64_t> m_wakeups;
+};
+#endif
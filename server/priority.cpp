@@ -0,0 +1,126 @@
+#include "priority.hpp"
+#include <cmath>
+#include <EASTL/sort.h>
+
+PriorityAccumulator::PriorityAccumulator(int maxClients, int workers)
+    : m_priority(maxClients * MAX_PLAYER_CAPACITY, 0.0f),
+      m_scratch(workers < 1 ? 1 : workers)
+{
+}
+
+void PriorityAccumulator::SetWorkerCount(int workers)
+{
+    m_scratch.resize(workers < 1 ? 1 : workers);
+}
+
+void PriorityAccumulator::Reset(int clientIndex)
+{
+    for (int id = 0; id < MAX_PLAYER_CAPACITY; ++id)
+    {
+        m_priority[clientIndex * MAX_PLAYER_CAPACITY + id] = 0.0f;
+    }
+}
+
+int PriorityAccumulator::Apply(int clientIndex, SnapshotState &state, const SnapshotState *baseline, bool quantized,
+                               int byteBudget, float elapsed, int worker)
+{
+    PlayerTable &players = state.players;
+    float *priority = &m_priority[clientIndex * MAX_PLAYER_CAPACITY];
+    eastl::vector<PriorityEntry> &entries = m_scratch[worker].entries;
+    eastl::vector<uint32_t> &omitted = m_scratch[worker].omitted;
+
+    // Players out of view start over from zero when they come back
+    for (uint32_t id = 0; id < static_cast<uint32_t>(MAX_PLAYER_CAPACITY); ++id)
+    {
+        if (players.Find(id) < 0)
+            priority[id] = 0.0f;
+    }
+    if (players.Count() == 0)
+        return 0;
+
+    bool isDelta = baseline != nullptr;
+    int budgetBits = byteBudget * 8;
+    int unchangedBits = GetPlayerEntryBits(0, isDelta, quantized);
+
+    // The client's own player always goes out in full detail; without one,
+    // priority only follows size
+    int bits = GetSnapshotHeaderBits(isDelta);
+    int self = players.Find(static_cast<uint32_t>(clientIndex));
+    if (self >= 0)
+    {
+        int selfOld = isDelta ? baseline->players.Find(players.ids[self]) : -1;
+        uint8_t selfChanged = selfOld >= 0 ? GetPlayerChanges(players, self, baseline->players, selfOld) : PLAYER_CHANGED_ALL;
+        bits += GetPlayerEntryBits(selfChanged, isDelta, quantized);
+    }
+
+    entries.clear();
+    for (int slot = 0; slot < players.Count(); ++slot)
+    {
+        if (slot == self)
+            continue;
+
+        uint32_t id = players.ids[slot];
+        float distance = 0.0f;
+        if (self >= 0)
+        {
+            float dx = players.x[slot] - players.x[self];
+            float dy = players.y[slot] - players.y[self];
+            distance = std::sqrt(dx * dx + dy * dy);
+        }
+        priority[id] += (1.0f + players.size[slot] / PRIORITY_SIZE_SCALE) /
+                        (1.0f + distance / PRIORITY_DISTANCE_SCALE) * elapsed;
+
+        PriorityEntry entry;
+        entry.slot = slot;
+        entry.baselineSlot = isDelta ? baseline->players.Find(id) : -1;
+        entry.priority = priority[id];
+        if (entry.baselineSlot >= 0)
+        {
+            // Players the client has stay in as at least an unchanged entry, so
+            // that much is reserved up front and only the difference competes
+            uint8_t changed = GetPlayerChanges(players, slot, baseline->players, entry.baselineSlot);
+            bits += unchangedBits;
+            entry.bits = GetPlayerEntryBits(changed, isDelta, quantized) - unchangedBits;
+        }
+        else
+        {
+            entry.bits = GetPlayerEntryBits(PLAYER_CHANGED_ALL, isDelta, quantized);
+        }
+        entries.push_back(entry);
+    }
+
+    eastl::sort(entries.begin(), entries.end(), [](const PriorityEntry &a, const PriorityEntry &b) {
+        return a.priority > b.priority;
+    });
+
+    int deferred = 0;
+    omitted.clear();
+    for (const PriorityEntry &entry : entries)
+    {
+        uint32_t id = players.ids[entry.slot];
+        if (bits + entry.bits <= budgetBits)
+        {
+            bits += entry.bits;
+            priority[id] = 0.0f;
+            continue;
+        }
+
+        deferred++;
+        if (entry.baselineSlot >= 0)
+        {
+            players.Set(entry.slot, baseline->players.Get(entry.baselineSlot));
+        }
+        else
+        {
+            omitted.push_back(id);
+        }
+    }
+
+    // Removing swaps slots around, so it waits until the entries are done with them
+    for (uint32_t id : omitted)
+    {
+        players.Remove(id);
+    }
+
+    return deferred;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <EASTL/vector.h>
+#include "../common/protocol.hpp"
+#include "../common/snapshot.hpp"
+
+// How priority grows: a player PRIORITY_DISTANCE_SCALE units away accrues at
+// half the rate of one next to the viewer, and one PRIORITY_SIZE_SCALE units
+// across at twice the rate of a tiny one
+static const float PRIORITY_DISTANCE_SCALE = 200.0f;
+static const float PRIORITY_SIZE_SCALE = 100.0f;
+
+// A player competing for the byte budget of one snapshot
+struct PriorityEntry
+{
+    int slot;           // In the snapshot being trimmed
+    int baselineSlot;   // In the baseline, -1 when the client does not have it
+    float priority;
+    int bits;           // Cost of sending it this snapshot
+};
+
+// Per-client priority accumulator. Every snapshot each visible player gains
+// priority for its distance and size times the time since the previous one;
+// the snapshot is then filled in priority order up to a byte budget. Players
+// that got in start over at zero, the rest carry their priority into later
+// snapshots, so everyone is sent eventually.
+class PriorityAccumulator
+{
+public:
+    explicit PriorityAccumulator(int maxClients, int workers = 1);
+
+    // Scratch for this many concurrent Apply calls, one per JobPool worker
+    void SetWorkerCount(int workers);
+
+    // Forgets accumulated priorities, e.g. when the slot is reused
+    void Reset(int clientIndex);
+
+    // Trims `state`, built for client `clientIndex`, so the WorldStateMessage
+    // written from it against `baseline` fits in `byteBudget`. Deferred players
+    // the client already has keep their baseline values and cost only an
+    // unchanged entry; deferred new ones are left out. `elapsed` is the time
+    // since the client's previous snapshot. Returns how many were deferred.
+    // Calls for different clients may run at once with different `worker`s.
+    int Apply(int clientIndex, SnapshotState &state, const SnapshotState *baseline, bool quantized, int byteBudget,
+              float elapsed, int worker = 0);
+
+    float GetPriority(int clientIndex, uint32_t playerId) const
+    {
+        return m_priority[clientIndex * MAX_PLAYER_CAPACITY + playerId];
+    }
+
+private:
+    struct Scratch
+    {
+        eastl::vector<PriorityEntry> entries;
+        eastl::vector<uint32_t> omitted;
+    };
+
+    eastl::vector<float> m_priority; // MAX_PLAYER_CAPACITY per client, by player id
+    eastl::vector<Scratch> m_scratch; // One per worker
+};
@@ -0,0 +1,123 @@
+#include "spatial_grid.hpp"
+#include <cmath>
+
+SpatialGrid::SpatialGrid(float width, float height, float cellSize, uint32_t maxItems)
+    : m_cellSize(cellSize),
+      m_inverseCellSize(1.0f / cellSize),
+      m_columns(static_cast<int>(std::ceil(width / cellSize))),
+      m_rows(static_cast<int>(std::ceil(height / cellSize))),
+      m_itemCount(0),
+      m_cells(),
+      m_itemCell(maxItems, -1),
+      m_itemSlot(maxItems, 0)
+{
+    if (m_columns < 1) m_columns = 1;
+    if (m_rows < 1) m_rows = 1;
+    m_cells.resize(m_columns * m_rows);
+}
+
+int SpatialGrid::ColumnOf(float x) const
+{
+    int column = static_cast<int>(std::floor(x * m_inverseCellSize));
+    if (column < 0) return 0;
+    if (column >= m_columns) return m_columns - 1;
+    return column;
+}
+
+int SpatialGrid::RowOf(float y) const
+{
+    int row = static_cast<int>(std::floor(y * m_inverseCellSize));
+    if (row < 0) return 0;
+    if (row >= m_rows) return m_rows - 1;
+    return row;
+}
+
+void SpatialGrid::Insert(uint32_t id, float x, float y)
+{
+    if (id >= m_itemCell.size())
+    {
+        m_itemCell.resize(id + 1, -1);
+        m_itemSlot.resize(id + 1, 0);
+    }
+
+    if (m_itemCell[id] >= 0)
+    {
+        Remove(id);
+    }
+
+    int cellIndex = RowOf(y) * m_columns + ColumnOf(x);
+    eastl::vector<uint32_t>& cell = m_cells[cellIndex];
+
+    m_itemCell[id] = cellIndex;
+    m_itemSlot[id] = static_cast<uint32_t>(cell.size());
+    cell.push_back(id);
+    m_itemCount++;
+}
+
+void SpatialGrid::Remove(uint32_t id)
+{
+    if (!Contains(id))
+        return;
+
+    eastl::vector<uint32_t>& cell = m_cells[m_itemCell[id]];
+    uint32_t slot = m_itemSlot[id];
+
+    // Swap-remove so removal stays O(1) regardless of cell occupancy
+    uint32_t lastId = cell.back();
+    cell[slot] = lastId;
+    m_itemSlot[lastId] = slot;
+    cell.pop_back();
+
+    m_itemCell[id] = -1;
+    m_itemCount--;
+}
+
+void SpatialGrid::Move(uint32_t id, float x, float y)
+{
+    if (Contains(id))
+    {
+        int cellIndex = RowOf(y) * m_columns + ColumnOf(x);
+        if (m_itemCell[id] == cellIndex)
+            return;
+
+        Remove(id);
+    }
+
+    Insert(id, x, y);
+}
+
+void SpatialGrid::Clear()
+{
+    // Keep per-cell capacity around so rebuilding every tick doesn't allocate
+    for (auto& cell : m_cells)
+    {
+        for (uint32_t id : cell)
+        {
+            m_itemCell[id] = -1;
+        }
+        cell.clear();
+    }
+    m_itemCount = 0;
+}
+
+void SpatialGrid::QueryRect(float minX, float minY, float maxX, float maxY, eastl::vector<uint32_t>& out) const
+{
+    int firstColumn = ColumnOf(minX);
+    int lastColumn = ColumnOf(maxX);
+    int firstRow = RowOf(minY);
+    int lastRow = RowOf(maxY);
+
+    for (int row = firstRow; row <= lastRow; ++row)
+    {
+        const eastl::vector<uint32_t>* cell = &m_cells[row * m_columns + firstColumn];
+        for (int column = firstColumn; column <= lastColumn; ++column, ++cell)
+        {
+            out.insert(out.end(), cell->begin(), cell->end());
+        }
+    }
+}
+
+int SpatialGrid::CountCellsInRect(float minX, float minY, float maxX, float maxY) const
+{
+    return (ColumnOf(maxX) - ColumnOf(minX) + 1) * (RowOf(maxY) - RowOf(minY) + 1);
+}
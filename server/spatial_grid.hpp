@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <EASTL/vector.h>
+
+// Uniform grid over the world rectangle. Items are identified by a dense id
+// (food slot, client index) and bucketed by the cell their position falls in,
+// so a query only visits the cells overlapping the requested area.
+class SpatialGrid
+{
+public:
+    SpatialGrid(float width, float height, float cellSize, uint32_t maxItems);
+
+    void Insert(uint32_t id, float x, float y);
+    void Remove(uint32_t id);
+    void Move(uint32_t id, float x, float y);
+    void Clear();
+
+    bool Contains(uint32_t id) const { return id < m_itemCell.size() && m_itemCell[id] >= 0; }
+    uint32_t GetItemCount() const { return m_itemCount; }
+    int GetColumns() const { return m_columns; }
+    int GetRows() const { return m_rows; }
+    float GetCellSize() const { return m_cellSize; }
+
+    // Appends the ids stored in every cell overlapping the rectangle. This is a
+    // broad-phase result: callers still run their exact overlap test.
+    void QueryRect(float minX, float minY, float maxX, float maxY, eastl::vector<uint32_t>& out) const;
+    void QueryRadius(float x, float y, float radius, eastl::vector<uint32_t>& out) const
+    {
+        QueryRect(x - radius, y - radius, x + radius, y + radius, out);
+    }
+
+    // Number of cells a QueryRect with the same bounds would visit
+    int CountCellsInRect(float minX, float minY, float maxX, float maxY) const;
+
+private:
+    int ColumnOf(float x) const;
+    int RowOf(float y) const;
+
+    float m_cellSize;
+    float m_inverseCellSize;
+    int m_columns;
+    int m_rows;
+    uint32_t m_itemCount;
+
+    eastl::vector<eastl::vector<uint32_t>> m_cells;
+    eastl::vector<int32_t> m_itemCell;   // Cell holding each id, -1 when absent
+    eastl::vector<uint32_t> m_itemSlot;  // Position of each id inside its cell
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <EASTL/vector.h>
+
+// Bounded lock-free queue between exactly one producer thread and one
+// consumer thread. Slots are filled and read in place: the producer writes the
+// slot from BeginPush and publishes it with EndPush, the consumer reads Front
+// and hands the slot back with Pop. Nothing blocks or allocates after
+// construction. Each side caches the other's index, so the shared cache lines
+// are only touched when the cached view says full or empty.
+template <typename T>
+class SpscRing
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity)
+        : m_slots(RoundUpToPowerOfTwo(capacity)),
+          m_mask(m_slots.size() - 1),
+          m_head(0),
+          m_cachedTail(0),
+          m_tail(0),
+          m_cachedHead(0)
+    {
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    // Producer: the next free slot, or null when the ring is full
+    T *BeginPush()
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == m_slots.size())
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == m_slots.size())
+                return nullptr;
+        }
+        return &m_slots[tail & m_mask];
+    }
+
+    // Producer: makes the slot from BeginPush visible to the consumer
+    void EndPush() { m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer: the oldest published slot, or null when the ring is empty
+    T *Front()
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail)
+                return nullptr;
+        }
+        return &m_slots[head & m_mask];
+    }
+
+    // Consumer: returns the slot from Front to the producer
+    void Pop() { m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    size_t GetCapacity() const { return m_slots.size(); }
+
+    // Exact only when called from a side while the other is idle
+    size_t GetSize() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    static const size_t CACHE_LINE_BYTES = 64;
+
+    static size_t RoundUpToPowerOfTwo(size_t value)
+    {
+        size_t capacity = 1;
+        while (capacity < value)
+            capacity <<= 1;
+        return capacity;
+    }
+
+    eastl::vector<T> m_slots;
+    size_t m_mask;
+
+    // Consumer side
+    alignas(CACHE_LINE_BYTES) std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+
+    // Producer side
+    alignas(CACHE_LINE_BYTES) std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+};
@@ -0,0 +1,166 @@
+#include "tick_profiler.hpp"
+#include <iomanip>
+
+const char *GetTickPhaseName(TickPhase phase)
+{
+    switch (phase)
+    {
+    case TickPhase::ADVANCE_TIME:
+        return "AdvanceTime";
+    case TickPhase::RECEIVE_PACKETS:
+        return "ReceivePackets";
+    case TickPhase::PROCESS_MESSAGES:
+        return "ProcessMessages";
+    case TickPhase::SIMULATE_PLAYERS:
+        return "SimulatePlayers";
+    case TickPhase::HANDLE_GAME_FOOD:
+        return "HandleGameFood";
+    case TickPhase::HANDLE_PLAYER_COLLISIONS:
+        return "HandlePlayerCollisions";
+    case TickPhase::BROADCAST_FOOD_EVENTS:
+        return "BroadcastFoodEvents";
+    case TickPhase::BROADCAST_WORLD_STATE:
+        return "BroadcastWorldState";
+    case TickPhase::SEND_PACKETS:
+        return "SendPackets";
+    case TickPhase::TICK:
+        return "Tick";
+    case TickPhase::TICK_LATENESS:
+        return "TickLateness";
+    default:
+        return "Unknown";
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+    : m_count(0),
+      m_max(0)
+{
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+int LatencyHistogram::BucketOf(uint64_t value)
+{
+    const uint64_t maxValue = (uint64_t(1) << MAX_VALUE_BITS) - 1;
+    if (value > maxValue)
+        value = maxValue;
+    if (value < 2 * SUB_BUCKETS)
+        return static_cast<int>(value);
+
+    // Keep the top SUB_BUCKET_BITS + 1 bits; the leading one selects the power of two
+    int highestBit = 63 - __builtin_clzll(value);
+    int shift = highestBit - SUB_BUCKET_BITS;
+    int subBucket = static_cast<int>(value >> shift) - SUB_BUCKETS;
+    return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int bucket)
+{
+    if (bucket < 2 * SUB_BUCKETS)
+        return static_cast<uint64_t>(bucket);
+
+    int shift = (bucket - 2 * SUB_BUCKETS) / SUB_BUCKETS + 1;
+    int subBucket = (bucket - 2 * SUB_BUCKETS) % SUB_BUCKETS;
+    uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + subBucket) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t value)
+{
+    m_buckets[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+void LatencyHistogram::Reset()
+{
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const
+{
+    uint64_t count = GetCount();
+    if (count == 0)
+        return 0;
+
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * count + 0.5);
+    if (target < 1)
+        target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target)
+        {
+            // The exact max is tighter than the bucket bound for the top bucket
+            uint64_t bound = BucketUpperBound(i);
+            uint64_t max = GetMax();
+            return bound < max ? bound : max;
+        }
+    }
+    return GetMax();
+}
+
+TickProfiler::TickProfiler(double dumpInterval)
+    : m_dumpInterval(dumpInterval),
+      m_lastDumpTime(0.0),
+      m_started(false)
+{
+}
+
+void TickProfiler::Update(double time, std::ostream &out)
+{
+    if (!m_started)
+    {
+        m_lastDumpTime = time;
+        m_started = true;
+        return;
+    }
+
+    if (m_dumpInterval > 0.0 && time - m_lastDumpTime >= m_dumpInterval)
+    {
+        Dump(out);
+        m_lastDumpTime = time;
+    }
+}
+
+void TickProfiler::Dump(std::ostream &out)
+{
+    const LatencyHistogram &tick = GetHistogram(TickPhase::TICK);
+    if (tick.GetCount() == 0)
+        return;
+
+    out << "Tick profile over " << tick.GetCount() << " ticks (microseconds):" << std::endl;
+    out << "  " << std::left << std::setw(24) << "phase" << std::right
+        << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+
+    for (int i = 0; i < static_cast<int>(TickPhase::COUNT); ++i)
+    {
+        LatencyHistogram &histogram = m_histograms[i];
+        out << "  " << std::left << std::setw(24) << GetTickPhaseName(static_cast<TickPhase>(i)) << std::right
+            << std::setw(10) << histogram.GetPercentile(50.0) / 1000.0
+            << std::setw(10) << histogram.GetPercentile(99.0) / 1000.0
+            << std::setw(10) << histogram.GetMax() / 1000.0 << std::endl;
+        histogram.Reset();
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Build with -DCIRC_TICK_PROFILER=0 (CMake option CIRC_TICK_PROFILER) to
+// compile every CIRC_PROFILE_PHASE scope and the profiler itself out.
+#ifndef CIRC_TICK_PROFILER
+#define CIRC_TICK_PROFILER 1
+#endif
+
+// Phases of GameServer::Update, in the order they run
+enum class TickPhase
+{
+    ADVANCE_TIME = 0,
+    RECEIVE_PACKETS,
+    PROCESS_MESSAGES,
+    SIMULATE_PLAYERS,
+    HANDLE_GAME_FOOD,
+    HANDLE_PLAYER_COLLISIONS,
+    BROADCAST_FOOD_EVENTS,
+    BROADCAST_WORLD_STATE,
+    SEND_PACKETS,
+    TICK,          // The whole Update call
+    TICK_LATENESS, // From the tick's scheduled start to Run calling Update, i.e. tick jitter
+    COUNT
+};
+
+const char *GetTickPhaseName(TickPhase phase);
+
+// Log-linear (HDR-style) histogram of nanosecond durations. Values below 32
+// get a bucket each; above that every power of two is split into 16 buckets,
+// so any reported value is within 1/16 (6.25%) of the recorded one. Record
+// only does relaxed atomic updates, so another thread may read or dump while
+// the tick thread records.
+class LatencyHistogram
+{
+public:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_VALUE_BITS = 40; // ~18 minutes; longer values are clamped
+    static const int BUCKET_COUNT = 2 * SUB_BUCKETS + (MAX_VALUE_BITS - SUB_BUCKET_BITS - 1) * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    void Record(uint64_t value);
+    void Reset();
+
+    uint64_t GetCount() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t GetMax() const { return m_max.load(std::memory_order_relaxed); }
+
+    // Smallest bucket bound that at least `percentile` (0..100) of the values fall under
+    uint64_t GetPercentile(double percentile) const;
+
+    static int BucketOf(uint64_t value);
+    static uint64_t BucketUpperBound(int bucket);
+
+private:
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_max;
+};
+
+// One histogram per TickPhase. Dump prints p50/p99/max for the window since
+// the previous dump and starts a new one.
+class TickProfiler
+{
+public:
+    explicit TickProfiler(double dumpInterval = 10.0);
+
+    void Record(TickPhase phase, uint64_t nanoseconds)
+    {
+        m_histograms[static_cast<int>(phase)].Record(nanoseconds);
+    }
+
+    const LatencyHistogram &GetHistogram(TickPhase phase) const { return m_histograms[static_cast<int>(phase)]; }
+
+    // Seconds between periodic dumps; 0 leaves only the dump at shutdown
+    void SetDumpInterval(double seconds) { m_dumpInterval = seconds; }
+    double GetDumpInterval() const { return m_dumpInterval; }
+
+    // Dumps when the interval has elapsed since the last dump. `time` is the server clock.
+    void Update(double time, std::ostream &out);
+    void Dump(std::ostream &out);
+
+private:
+    LatencyHistogram m_histograms[static_cast<int>(TickPhase::COUNT)];
+    double m_dumpInterval;
+    double m_lastDumpTime;
+    bool m_started;
+};
+
+// Records the lifetime of the scope into one phase
+class ProfileScope
+{
+public:
+    ProfileScope(TickProfiler &profiler, TickPhase phase)
+        : m_profiler(profiler), m_phase(phase), m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ProfileScope()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        m_profiler.Record(m_phase, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+private:
+    TickProfiler &m_profiler;
+    TickPhase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#define CIRC_PROFILE_CONCAT_INNER(a, b) a##b
+#define CIRC_PROFILE_CONCAT(a, b) CIRC_PROFILE_CONCAT_INNER(a, b)
+
+#if CIRC_TICK_PROFILER
+#define CIRC_PROFILE_PHASE(profiler, phase) \
+    ProfileScope CIRC_PROFILE_CONCAT(profileScope, __LINE__)((profiler), (phase))
+#else
+#define CIRC_PROFILE_PHASE(profiler, phase) ((void)0)
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+#include "../common/loopback.hpp"
+#include "../server/game_server.hpp"
+#include <yojimbo.h>
+#include <initializer_list>
+
+// Address the in-process servers are created with; nothing is bound to it
+static const yojimbo::Address LOOPBACK_ADDRESS("127.0.0.1", 0);
+
+// GameServer on the LOOPBACK transport, attached to `network` and reachable
+// only through it
+class LoopbackServer : public GameServer
+{
+public:
+    explicit LoopbackServer(LoopbackNetwork &network, int maxPlayers = DEFAULT_MAX_PLAYERS, int clientMemory = 0)
+        : GameServer(LOOPBACK_ADDRESS, maxPlayers, InputQueueConfig(), ServerTransport::LOOPBACK, clientMemory)
+    {
+        AttachLoopback(network);
+    }
+};
+
+// Runs `ticks` ticks on the virtual clock: delivers what is due, then updates
+// the server and each client. `clients` holds pointers, raw or smart, to
+// anything with Update(float dt).
+template <typename ClientRange>
+inline void PumpLoopback(LoopbackNetwork &network, GameServer &server, const ClientRange &clients, int ticks = 1)
+{
+    const double dt = 1.0 / TICK_RATE;
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        network.Update(dt);
+        server.SetTime(network.GetTime());
+        server.Update(static_cast<float>(dt));
+        for (const auto &client : clients)
+            client->Update(static_cast<float>(dt));
+    }
+}
+
+template <typename Client>
+inline void PumpLoopback(LoopbackNetwork &network, GameServer &server, std::initializer_list<Client *> clients,
+                         int ticks = 1)
+{
+    PumpLoopback<std::initializer_list<Client *>>(network, server, clients, ticks);
+}
@@ -0,0 +1,114 @@
+#include "catch.hpp"
+#include "../server/batched_socket.hpp"
+#include "../server/batched_server.hpp"
+#include "../common/protocol.hpp"
+
+#if CIRC_BATCHED_TRANSPORT
+#include <cstring>
+#include <arpa/inet.h>
+
+static sockaddr_storage LoopbackAddress(uint16_t port)
+{
+    sockaddr_storage storage;
+    memset(&storage, 0, sizeof(storage));
+    sockaddr_in &address = reinterpret_cast<sockaddr_in &>(storage);
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return storage;
+}
+
+TEST_CASE("Batched socket tests", "[transport]")
+{
+    BatchedSocket sender;
+    BatchedSocket receiver;
+    REQUIRE(sender.Open(LoopbackAddress(0)));
+    REQUIRE(receiver.Open(LoopbackAddress(0)));
+    REQUIRE(receiver.GetPort() != 0);
+    const sockaddr_storage to = LoopbackAddress(receiver.GetPort());
+
+    uint8_t packet[TRANSPORT_MAX_PACKET_BYTES];
+    sockaddr_storage from;
+
+    SECTION("Queued packets go out in one sendmmsg and come back in one recvmmsg")
+    {
+        const int COUNT = 20;
+        for (int i = 0; i < COUNT; ++i)
+        {
+            memset(packet, i, i + 1);
+            sender.Send(to, packet, i + 1);
+        }
+        REQUIRE(sender.GetStats().sendCalls == 0);
+
+        sender.Flush();
+        REQUIRE(sender.GetStats().sendCalls == 1);
+        REQUIRE(sender.GetStats().packetsSent == COUNT);
+        REQUIRE(sender.GetStats().maxSendBatch == COUNT);
+
+        for (int i = 0; i < COUNT; ++i)
+        {
+            int bytes = receiver.Receive(from, packet, sizeof(packet));
+            REQUIRE(bytes == i + 1);
+            REQUIRE(packet[0] == i);
+            REQUIRE(ntohs(reinterpret_cast<sockaddr_in &>(from).sin_port) == sender.GetPort());
+        }
+        REQUIRE(receiver.GetStats().receiveCalls == 1);
+        REQUIRE(receiver.GetStats().maxReceiveBatch == COUNT);
+
+        REQUIRE(receiver.Receive(from, packet, sizeof(packet)) == 0);
+        REQUIRE(receiver.GetStats().packetsReceived == COUNT);
+    }
+
+    SECTION("A full batch flushes itself")
+    {
+        for (int i = 0; i < TRANSPORT_BATCH_SIZE + 1; ++i)
+            sender.Send(to, packet, 32);
+        REQUIRE(sender.GetStats().sendCalls == 1);
+        REQUIRE(sender.GetStats().packetsSent == TRANSPORT_BATCH_SIZE);
+
+        sender.Flush();
+        REQUIRE(sender.GetStats().packetsSent == TRANSPORT_BATCH_SIZE + 1);
+    }
+
+    SECTION("Oversized packets and empty flushes are ignored")
+    {
+        uint8_t big[TRANSPORT_MAX_PACKET_BYTES + 1] = {};
+        sender.Send(to, big, sizeof(big));
+        sender.Flush();
+        REQUIRE(sender.GetStats().sendCalls == 0);
+        REQUIRE(receiver.Receive(from, packet, sizeof(packet)) == 0);
+    }
+
+    SECTION("Packets larger than the caller's buffer are skipped")
+    {
+        memset(packet, 1, 100);
+        sender.Send(to, packet, 100);
+        memset(packet, 2, 10);
+        sender.Send(to, packet, 10);
+        sender.Flush();
+
+        uint8_t small[50];
+        REQUIRE(receiver.Receive(from, small, sizeof(small)) == 10);
+        REQUIRE(small[0] == 2);
+    }
+
+    SECTION("A server bound to port 0 reports the port it got")
+    {
+        REQUIRE(InitializeYojimbo());
+        {
+            GameConnectionConfig config(4);
+            yojimbo::Adapter adapter;
+            for (BatchedSocketMode socketMode : {BatchedSocketMode::INLINE, BatchedSocketMode::IO_THREAD})
+            {
+                BatchedServer server(yojimbo::GetDefaultAllocator(), DEFAULT_PRIVATE_KEY,
+                                     yojimbo::Address("127.0.0.1", 0), config, adapter, 0.0, socketMode);
+                server.Start(4);
+                REQUIRE(server.IsRunning());
+                REQUIRE(server.GetAddress().GetPort() != 0);
+                server.Stop();
+            }
+        }
+        ShutdownYojimbo();
+    }
+}
+#endif
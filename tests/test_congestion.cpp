@@ -0,0 +1,99 @@
+#include "catch.hpp"
+#include "../server/congestion.hpp"
+
+static yojimbo::NetworkInfo MakeInfo(float rtt, float packetLoss)
+{
+    yojimbo::NetworkInfo info;
+    memset(&info, 0, sizeof(info));
+    info.RTT = rtt;
+    info.packetLoss = packetLoss;
+    info.sentBandwidth = 100.0f;
+    info.ackedBandwidth = 100.0f;
+    return info;
+}
+
+// Feeds the same stats every tick for `seconds`, returning the time reached
+static double Run(CongestionController &congestion, const yojimbo::NetworkInfo &info, double time, double seconds)
+{
+    const double dt = 1.0 / TICK_RATE;
+    for (double end = time + seconds; time < end; time += dt)
+    {
+        congestion.Update(info, time);
+    }
+    return time;
+}
+
+TEST_CASE("Congestion controller tests", "[congestion]")
+{
+    CongestionController congestion;
+    congestion.Reset(0.0);
+    const yojimbo::NetworkInfo good = MakeInfo(40.0f, 0.0f);
+    const yojimbo::NetworkInfo laggy = MakeInfo(400.0f, 0.0f);
+    const yojimbo::NetworkInfo lossy = MakeInfo(40.0f, 10.0f);
+    const yojimbo::NetworkInfo borderline = MakeInfo(200.0f, 2.0f);
+
+    SECTION("A clear link stays at full rate and budget")
+    {
+        Run(congestion, good, 0.0, 30.0);
+        REQUIRE(congestion.GetLevel() == 0);
+        REQUIRE(congestion.GetIntervalScale() == 1);
+        REQUIRE(congestion.GetMaxPlayers() == MAX_PLAYER_CAPACITY);
+    }
+
+    SECTION("Congestion shifts down one level per cooldown, to the bottom")
+    {
+        REQUIRE(congestion.Update(laggy, 2.0));
+        REQUIRE(congestion.GetLevel() == 1);
+        REQUIRE_FALSE(congestion.Update(laggy, 2.5));
+
+        Run(congestion, lossy, 3.0, 10.0);
+        REQUIRE(congestion.GetLevel() == NUM_CONGESTION_LEVELS - 1);
+        REQUIRE(congestion.GetIntervalScale() > 1);
+        REQUIRE(congestion.GetMaxPlayers() < MAX_PLAYER_CAPACITY);
+    }
+
+    SECTION("Unacked bandwidth counts as congestion")
+    {
+        yojimbo::NetworkInfo backlog = good;
+        backlog.ackedBandwidth = backlog.sentBandwidth / 2.0f;
+        REQUIRE(congestion.Update(backlog, 2.0));
+    }
+
+    SECTION("Shifting back up waits for the penalty time, and a borderline link holds")
+    {
+        double time = Run(congestion, laggy, 2.0, 0.1);
+        REQUIRE(congestion.GetLevel() == 1);
+
+        time = Run(congestion, borderline, time, 30.0);
+        REQUIRE(congestion.GetLevel() == 1);
+
+        time = Run(congestion, good, time, congestion.GetPenaltyTime() - 0.5);
+        REQUIRE(congestion.GetLevel() == 1);
+        Run(congestion, good, time, 1.0);
+        REQUIRE(congestion.GetLevel() == 0);
+    }
+
+    SECTION("Congestion right after shifting up doubles the penalty, which relaxes later")
+    {
+        double time = Run(congestion, laggy, 2.0, 0.1);
+        time = Run(congestion, good, time, congestion.GetPenaltyTime() + 0.5);
+        REQUIRE(congestion.GetLevel() == 0);
+
+        double penalty = congestion.GetPenaltyTime();
+        time = Run(congestion, laggy, time + 1.0, 0.1);
+        REQUIRE(congestion.GetLevel() == 1);
+        REQUIRE(congestion.GetPenaltyTime() == penalty * 2.0);
+
+        Run(congestion, good, time, 60.0);
+        REQUIRE(congestion.GetLevel() == 0);
+        REQUIRE(congestion.GetPenaltyTime() == penalty);
+    }
+
+    SECTION("Reset returns a reused slot to full rate")
+    {
+        Run(congestion, laggy, 2.0, 5.0);
+        REQUIRE(congestion.GetLevel() > 0);
+        congestion.Reset(10.0);
+        REQUIRE(congestion.GetLevel() == 0);
+    }
+}
@@ -1,29 +1,12 @@
 #include "catch.hpp"
 #include "../common/protocol.hpp"
+#include "loopback_server.hpp"
 #include "../server/game_server.hpp"
 #include "../client/game_client.hpp"
 #include <yojimbo.h>
-#include <thread>
 #include <chrono>
-
-// Helper function to pump messages between client and server
-static void PumpClientServer(GameClient& client, GameServer& server, double deltaTime = 0.016)
-{
-    server.Update(deltaTime);
-    client.Update(deltaTime);
-}
-
-// Helper function to wait for connection with timeout
-static bool WaitForConnection(GameClient& client, int maxAttempts = 100)
-{
-    for (int i = 0; i < maxAttempts; ++i)
-    {
-        if (client.IsConnected())
-            return true;
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    }
-    return false;
-}
+#include <initializer_list>
+#include <thread>
 
 TEST_CASE("Connection tests", "[connection]")
 {
@@ -37,59 +20,82 @@ TEST_CASE("Connection tests", "[connection]")
         REQUIRE(server.IsRunning());
     }
 
-    SECTION("Client connects to server")
+    SECTION("Clients connect and exchange messages over real sockets")
     {
-        const yojimbo::Address serverAddress("127.0.0.1", 40002);
+        struct TransportCase
+        {
+            ServerTransport transport;
+            uint16_t port;
+        };
+        const TransportCase cases[] = {
+            {ServerTransport::SOCKET, 40002},
+#if CIRC_BATCHED_TRANSPORT
+            {ServerTransport::BATCHED, 40003},
+            {ServerTransport::THREADED, 40004},
+#endif
+        };
+
+        for (const TransportCase &transportCase : cases)
+        {
+            INFO("Transport " << static_cast<int>(transportCase.transport));
+            const yojimbo::Address serverAddress("127.0.0.1", transportCase.port);
+            GameServer server(serverAddress, DEFAULT_MAX_PLAYERS, InputQueueConfig(), transportCase.transport);
+            REQUIRE(server.IsRunning());
+            GameClient client(serverAddress);
 
-        GameServer server(serverAddress);
-        REQUIRE(server.IsRunning());
+            // Each step sleeps briefly so the datagrams can cross the socket
+            const double dt = 1.0 / TICK_RATE;
+            double time = 0.0;
+            auto step = [&]() {
+                time += dt;
+                server.SetTime(time);
+                server.Update(static_cast<float>(dt));
+                client.Update(static_cast<float>(dt));
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            };
+
+            // Server to client: the world state that spawns the local player
+            for (int i = 0; i < 5 * TICK_RATE && !client.IsLocalPlayerCreated(); ++i)
+                step();
+            REQUIRE(client.IsConnected());
+            REQUIRE(client.IsLocalPlayerCreated());
 
-        // Give server time to start
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            // Client to server: input the server consumes
+            client.SetScriptedInput(1.0f, 0.0f);
+            for (int i = 0; i < TICK_RATE && !server.GetInputQueue(0).HasConsumed(); ++i)
+                step();
+            REQUIRE(server.GetInputQueue(0).HasConsumed());
+        }
+    }
 
-        GameClient client(serverAddress);
+    SECTION("Client connects to server")
+    {
+        LoopbackNetwork network;
+        LoopbackServer server(network);
+        REQUIRE(server.IsRunning());
 
-        // Pump messages to allow connection handshake
-        for (int i = 0; i < 100; ++i)
-        {
-            PumpClientServer(client, server);
-            if (client.IsConnected())
-                break;
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        }
+        GameClient client(network);
+        PumpLoopback(network, server, {&client});
 
         REQUIRE(client.IsConnected());
+        REQUIRE(server.GetConnectedClientCount() == 1);
     }
 
     SECTION("Client disconnects from server")
     {
-        const yojimbo::Address serverAddress("127.0.0.1", 40003);
-
-        GameServer server(serverAddress);
-        REQUIRE(server.IsRunning());
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        LoopbackNetwork network;
+        LoopbackServer server(network);
 
         {
-            GameClient client(serverAddress);
-
-            // Wait for connection
-            for (int i = 0; i < 100; ++i)
-            {
-                PumpClientServer(client, server);
-                if (client.IsConnected())
-                    break;
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            }
-
+            GameClient client(network);
+            PumpLoopback(network, server, {&client});
             REQUIRE(client.IsConnected());
 
             // Client destructor will disconnect
         }
 
-        // Give server time to process disconnection
-        server.Update(0.016);
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        PumpLoopback(network, server, std::initializer_list<GameClient *>());
+        REQUIRE(server.GetConnectedClientCount() == 0);
 
         // Server should still be running
         REQUIRE(server.IsRunning());
@@ -97,31 +103,16 @@ TEST_CASE("Connection tests", "[connection]")
 
     SECTION("Multiple clients can connect")
     {
-        const yojimbo::Address serverAddress("127.0.0.1", 40004);
-
-        GameServer server(serverAddress);
-        REQUIRE(server.IsRunning());
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        LoopbackNetwork network;
+        LoopbackServer server(network);
 
-        GameClient client1(serverAddress);
-        GameClient client2(serverAddress);
-
-        // Wait for both connections
-        for (int i = 0; i < 100; ++i)
-        {
-            server.Update(0.016);
-            client1.Update(0.016);
-            client2.Update(0.016);
-
-            if (client1.IsConnected() && client2.IsConnected())
-                break;
-
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        }
+        GameClient client1(network);
+        GameClient client2(network);
+        PumpLoopback(network, server, {&client1, &client2});
 
         REQUIRE(client1.IsConnected());
         REQUIRE(client2.IsConnected());
+        REQUIRE(server.GetConnectedClientCount() == 2);
     }
 
     ShutdownYojimbo();
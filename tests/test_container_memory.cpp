@@ -0,0 +1,179 @@
+#include "catch.hpp"
+#include "../common/eastl_allocator.hpp"
+#include <EASTL/internal/config.h>
+#include <yojimbo.h>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// The EASTL allocation entry points, as EASTL's default allocator calls them
+void *operator new[](size_t size, const char *name, int flags, unsigned debugFlags, const char *file, int line);
+void *operator new[](size_t size, size_t alignment, size_t alignmentOffset, const char *name, int flags,
+                     unsigned debugFlags, const char *file, int line);
+
+static const ContainerTagStats *FindTagStats(const ContainerMemoryStats &stats, const char *name)
+{
+    for (int i = 0; i < stats.tagCount; ++i)
+    {
+        if (strcmp(stats.tags[i].name, name) == 0)
+            return &stats.tags[i];
+    }
+    return nullptr;
+}
+
+TEST_CASE("Container memory tests", "[containers]")
+{
+    SECTION("Over-aligned requests are honored")
+    {
+        for (size_t alignment : {32, 64, 256, 4096})
+        {
+            char *p = static_cast<char *>(operator new[](100, alignment, 0, "test.align", 0, 0, nullptr, 0));
+            REQUIRE(p != nullptr);
+            REQUIRE(reinterpret_cast<uintptr_t>(p) % alignment == 0);
+            memset(p, 0xAB, 100);
+            delete[] p;
+        }
+
+        char *q = static_cast<char *>(operator new[](100, 64, 8, "test.align", 0, 0, nullptr, 0));
+        REQUIRE((reinterpret_cast<uintptr_t>(q) + 8) % 64 == 0);
+        delete[] q;
+    }
+
+    SECTION("Small blocks come from a size class and are reused")
+    {
+        const ContainerMemoryStats before = GetContainerMemoryStats();
+        char *first = static_cast<char *>(operator new[](40, "test.pool", 0, 0, nullptr, 0));
+        REQUIRE(reinterpret_cast<uintptr_t>(first) % 16 == 0);
+        delete[] first;
+        char *second = static_cast<char *>(operator new[](40, "test.pool", 0, 0, nullptr, 0));
+        REQUIRE(second == first);
+        delete[] second;
+
+        const ContainerMemoryStats after = GetContainerMemoryStats();
+        REQUIRE(after.pooled - before.pooled == 2);
+        REQUIRE(after.poolBytes >= CONTAINER_MEMORY_POOL_CHUNK);
+    }
+
+    SECTION("Bytes are counted by the name EASTL passes")
+    {
+        char *a = static_cast<char *>(operator new[](100, "test.tag", 0, 0, nullptr, 0));
+        char *b = static_cast<char *>(operator new[](5000, "test.tag", 0, 0, nullptr, 0));
+        ContainerMemoryStats stats = GetContainerMemoryStats();
+        const ContainerTagStats *tag = FindTagStats(stats, "test.tag");
+        REQUIRE(tag != nullptr);
+        REQUIRE(tag->bytesInUse == 5100);
+        REQUIRE(tag->allocations == 2);
+
+        delete[] a;
+        delete[] b;
+        stats = GetContainerMemoryStats();
+        tag = FindTagStats(stats, "test.tag");
+        REQUIRE(tag->bytesInUse == 0);
+        REQUIRE(tag->highWater == 5100);
+
+    }
+
+    SECTION("Plain new[] is left untracked")
+    {
+        const ContainerMemoryStats before = GetContainerMemoryStats();
+        int *values = new int[10];
+        values[9] = 7;
+        const ContainerMemoryStats during = GetContainerMemoryStats();
+        delete[] values;
+        const ContainerMemoryStats after = GetContainerMemoryStats();
+        REQUIRE(during.allocations == before.allocations);
+        REQUIRE(during.bytesInUse == before.bytesInUse);
+        REQUIRE(after.frees == before.frees);
+    }
+
+    SECTION("Threads allocate and free concurrently, across threads too")
+    {
+        const int THREADS = 4;
+        const int BLOCKS = 5000;
+        const size_t arenaBytes = 32 * 1024 * 1024;
+        uint8_t *memory = static_cast<uint8_t *>(malloc(arenaBytes));
+        {
+            yojimbo::TLSF_Allocator tlsf(memory, arenaBytes);
+            REQUIRE(SetContainerAllocator(&tlsf));
+
+            // Kept in std::vector so the bookkeeping stays out of the container stats
+            std::vector<std::vector<char *>> blocks(THREADS);
+            for (std::vector<char *> &list : blocks)
+                list.reserve(BLOCKS);
+            const ContainerMemoryStats before = GetContainerMemoryStats();
+
+            // Every thread frees the blocks of the one before it, so lists fill
+            // past the per-thread limit and spill to the shared depot. Every
+            // eighth block is past the largest size class and goes to the TLSF.
+            std::vector<std::thread> threads;
+            for (int t = 0; t < THREADS; ++t)
+            {
+                threads.emplace_back([&blocks, t, BLOCKS]() {
+                    for (int i = 0; i < BLOCKS; ++i)
+                    {
+                        const size_t bytes = i % 8 == 0 ? 4096 + (i % 64) * 64 : 8 + (i % 64) * 8;
+                        char *p = static_cast<char *>(operator new[](bytes, "test.threads", 0, 0, nullptr, 0));
+                        memset(p, t, bytes);
+                        blocks[t].push_back(p);
+                    }
+                });
+            }
+            for (std::thread &thread : threads)
+                thread.join();
+            threads.clear();
+            for (int t = 0; t < THREADS; ++t)
+            {
+                threads.emplace_back([&blocks, t, THREADS]() {
+                    for (char *p : blocks[(t + 1) % THREADS])
+                        delete[] p;
+                });
+            }
+            for (std::thread &thread : threads)
+                thread.join();
+
+            const ContainerMemoryStats after = GetContainerMemoryStats();
+            REQUIRE(SetContainerAllocator(nullptr));
+            REQUIRE(after.allocations - before.allocations == THREADS * BLOCKS);
+            REQUIRE(after.frees - before.frees == THREADS * BLOCKS);
+            REQUIRE(after.bytesInUse == before.bytesInUse);
+            REQUIRE(after.overflow == before.overflow);
+            const ContainerTagStats *tag = FindTagStats(after, "test.threads");
+            REQUIRE(tag != nullptr);
+            REQUIRE(tag->bytesInUse == 0);
+        }
+        free(memory);
+    }
+
+    SECTION("An installed TLSF allocator bounds large blocks and spills to the heap when full")
+    {
+        const size_t arenaBytes = 64 * 1024;
+        uint8_t *memory = static_cast<uint8_t *>(malloc(arenaBytes));
+        {
+            yojimbo::TLSF_Allocator tlsf(memory, arenaBytes);
+            REQUIRE(SetContainerAllocator(&tlsf));
+            REQUIRE(GetContainerAllocator() == &tlsf);
+            ContainerMemoryStats stats = GetContainerMemoryStats();
+            REQUIRE(stats.bounded);
+
+            const uint64_t overflow = stats.overflow;
+            char *inside = static_cast<char *>(operator new[](8192, 64, 0, "test.tlsf", 0, 0, nullptr, 0));
+            REQUIRE(inside >= reinterpret_cast<char *>(memory));
+            REQUIRE(inside < reinterpret_cast<char *>(memory) + arenaBytes);
+            REQUIRE(reinterpret_cast<uintptr_t>(inside) % 64 == 0);
+
+            char *spilled = static_cast<char *>(operator new[](2 * arenaBytes, "test.tlsf", 0, 0, nullptr, 0));
+            REQUIRE(spilled != nullptr);
+            stats = GetContainerMemoryStats();
+            REQUIRE(stats.overflow == overflow + 1);
+
+            // Switching back leaves existing blocks freeing to where they came from
+            REQUIRE(SetContainerAllocator(nullptr));
+            stats = GetContainerMemoryStats();
+            REQUIRE_FALSE(stats.bounded);
+            delete[] inside;
+            delete[] spilled;
+        }
+        free(memory);
+    }
+}
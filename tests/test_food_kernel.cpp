@@ -0,0 +1,107 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../server/food_kernel.hpp"
+#include <EASTL/vector.h>
+#include <cstdlib>
+
+struct FoodKernelInput
+{
+    eastl::vector<float> x;
+    eastl::vector<float> y;
+};
+
+static FoodKernelInput MakeFood(int count)
+{
+    FoodKernelInput food;
+    srand(42);
+    for (int i = 0; i < count; ++i)
+    {
+        food.x.push_back(static_cast<float>(rand() % WORLD_WIDTH) + (rand() % 8) * 0.125f);
+        food.y.push_back(static_cast<float>(rand() % WORLD_HEIGHT) + (rand() % 8) * 0.125f);
+    }
+    return food;
+}
+
+// Reference result built with the same expression HandleGameFood always used
+static eastl::vector<uint64_t> ReferenceMask(const FoodKernelInput& food, Position player, float radiusSquared)
+{
+    eastl::vector<uint64_t> mask(FoodMaskWords(static_cast<int>(food.x.size())), 0);
+    for (size_t i = 0; i < food.x.size(); ++i)
+    {
+        Position position(food.x[i], food.y[i]);
+        if (position.distanceSquared(player) < radiusSquared)
+            mask[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+    return mask;
+}
+
+static void CheckKernel(FoodOverlapKernel kernel, int count, float radius)
+{
+    FoodKernelInput food = MakeFood(count);
+    Position player(1600.0f, 1200.0f);
+    float radiusSquared = radius * radius;
+
+    eastl::vector<uint64_t> expected = ReferenceMask(food, player, radiusSquared);
+    eastl::vector<uint64_t> mask(FoodMaskWords(count), ~uint64_t(0));
+
+    int hits = kernel(food.x.data(), food.y.data(), count, player.x, player.y, radiusSquared, mask.data());
+
+    int expectedHits = 0;
+    for (uint64_t word : expected)
+        expectedHits += __builtin_popcountll(word);
+
+    REQUIRE(mask == expected);
+    REQUIRE(hits == expectedHits);
+}
+
+TEST_CASE("Food overlap kernel tests", "[kernel]")
+{
+    const int counts[] = {0, 1, 7, 63, 64, 65, MAX_FOOD, 1001};
+    const float radii[] = {0.0f, 50.0f, 600.0f, 5000.0f};
+
+    SECTION("Scalar kernel matches Position::distanceSquared")
+    {
+        for (int count : counts)
+            for (float radius : radii)
+                CheckKernel(FindFoodOverlapsScalar, count, radius);
+    }
+
+    SECTION("Dispatched kernel matches the scalar kernel")
+    {
+        INFO("Dispatched kernel: " << GetFoodOverlapKernelName());
+        for (int count : counts)
+            for (float radius : radii)
+                CheckKernel(GetFoodOverlapKernel(), count, radius);
+    }
+
+#ifdef CIRC_FOOD_KERNEL_X86
+    SECTION("SSE kernel matches the scalar kernel")
+    {
+        for (int count : counts)
+            for (float radius : radii)
+                CheckKernel(FindFoodOverlapsSSE, count, radius);
+    }
+
+    SECTION("AVX2 kernel matches the scalar kernel")
+    {
+        if (!__builtin_cpu_supports("avx2"))
+            return;
+
+        for (int count : counts)
+            for (float radius : radii)
+                CheckKernel(FindFoodOverlapsAVX2, count, radius);
+    }
+#endif
+
+    SECTION("Food exactly on the radius is not eaten")
+    {
+        float foodX[] = {110.0f, 100.0f, 90.0f};
+        float foodY[] = {100.0f, 109.0f, 100.0f};
+        uint64_t mask = 0;
+
+        int hits = FindFoodOverlaps(foodX, foodY, 3, 100.0f, 100.0f, 100.0f, &mask);
+
+        REQUIRE(hits == 1);
+        REQUIRE(mask == 0x2);
+    }
+}
@@ -0,0 +1,128 @@
+#include "catch.hpp"
+#include "../server/frame_arena.hpp"
+#include "../common/heap_counter.hpp"
+#include <cstdint>
+
+#if CIRC_TICK_ALLOC_CHECK
+#include "loopback_server.hpp"
+#include "../server/game_server.hpp"
+#include "../client/game_client.hpp"
+#include <thread>
+#endif
+
+TEST_CASE("Frame arena tests", "[arena]")
+{
+    SECTION("Allocations bump through one block and Reset hands it out again")
+    {
+        FrameArena arena(1024);
+        void *first = arena.Allocate(10);
+        void *second = arena.Allocate(8, 64);
+        REQUIRE(arena.Owns(first));
+        REQUIRE(arena.Owns(second));
+        REQUIRE(reinterpret_cast<uintptr_t>(second) % 64 == 0);
+        REQUIRE(static_cast<uint8_t *>(second) > static_cast<uint8_t *>(first));
+        REQUIRE(arena.GetUsed() <= 72);
+
+        arena.Reset();
+        REQUIRE(arena.GetUsed() == 0);
+        REQUIRE(arena.Allocate(10) == first);
+        REQUIRE(arena.GetHighWater() >= 18);
+    }
+
+    SECTION("A tick past the block overflows once, then the block grows to fit it")
+    {
+        FrameArena arena(256);
+        arena.Allocate(200);
+        void *spill = arena.Allocate(200);
+        REQUIRE(spill != nullptr);
+        REQUIRE_FALSE(arena.Owns(spill));
+        REQUIRE(arena.GetOverflowCount() == 1);
+        REQUIRE(arena.GetHighWater() == 400);
+
+        arena.Reset();
+        REQUIRE(arena.GetCapacity() >= 400);
+        arena.Allocate(200);
+        REQUIRE(arena.Owns(arena.Allocate(200)));
+        REQUIRE(arena.GetOverflowCount() == 1);
+    }
+
+    SECTION("FrameVector storage comes from the arena")
+    {
+        FrameArena arena;
+        FrameArenaAllocator allocator(&arena);
+        FrameVector<uint32_t> values(allocator);
+        for (uint32_t i = 0; i < 1000; ++i)
+            values.push_back(i);
+
+        REQUIRE(arena.Owns(values.data()));
+        REQUIRE(values[999] == 999);
+        REQUIRE(arena.GetOverflowCount() == 0);
+    }
+
+    SECTION("Without an arena the allocator falls back to the heap")
+    {
+        FrameArenaAllocator allocator;
+        REQUIRE(allocator.GetArena() == nullptr);
+        FrameVector<int> values(allocator);
+        values.push_back(1);
+        REQUIRE(values.back() == 1);
+    }
+
+#if CIRC_TICK_ALLOC_CHECK
+    SECTION("Overflow blocks count as heap allocations")
+    {
+        FrameArena arena(256);
+        arena.Allocate(200);
+        const uint64_t before = GetHeapAllocationCount();
+        arena.Allocate(200);
+        REQUIRE(GetHeapAllocationCount() == before + 1);
+        arena.Allocate(40);
+        REQUIRE(GetHeapAllocationCount() == before + 1);
+    }
+
+    SECTION("The server's yojimbo allocator counts what it takes from the heap")
+    {
+        REQUIRE(InitializeYojimbo());
+        {
+            CountingAllocator allocator;
+            const uint64_t before = GetHeapAllocationCount();
+            void *block = YOJIMBO_ALLOCATE(allocator, 64);
+            REQUIRE(block != nullptr);
+            REQUIRE(GetHeapAllocationCount() > before);
+            YOJIMBO_FREE(allocator, block);
+        }
+        ShutdownYojimbo();
+    }
+
+    SECTION("Allocations on other threads count too")
+    {
+        const uint64_t before = GetHeapAllocationCount();
+        std::thread([]() { delete new int(1); }).join();
+        REQUIRE(GetHeapAllocationCount() > before);
+    }
+
+    SECTION("A steady-state server tick makes no heap allocations")
+    {
+        REQUIRE(InitializeYojimbo());
+        {
+            LoopbackNetwork network;
+            LoopbackServer server(network);
+            GameClient client1(network);
+            GameClient client2(network);
+
+            PumpLoopback(network, server, {&client1, &client2}, 2 * TICK_RATE);
+
+            // Warmed up: every container has reached its working size
+            uint64_t allocatingTicks = server.GetAllocatingTicks();
+            for (int tick = 0; tick < TICK_RATE; ++tick)
+            {
+                PumpLoopback(network, server, {&client1, &client2});
+                REQUIRE(server.GetTickAllocations() == 0);
+            }
+            REQUIRE(server.GetAllocatingTicks() == allocatingTicks);
+            REQUIRE(server.GetTickAllocationFailures() == 0);
+        }
+        ShutdownYojimbo();
+    }
+#endif
+}
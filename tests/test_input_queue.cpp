@@ -0,0 +1,123 @@
+#include "catch.hpp"
+#include "../server/input_queue.hpp"
+
+static eastl::vector<uint32_t> Drain(InputQueue &queue)
+{
+    eastl::vector<uint32_t> sequences;
+    QueuedInput input;
+    while (queue.Pop(input))
+    {
+        sequences.push_back(input.sequenceNumber);
+    }
+    return sequences;
+}
+
+TEST_CASE("Input queue tests", "[input]")
+{
+    SECTION("Out of order inputs come out sorted by sequence")
+    {
+        InputQueue queue(8);
+        REQUIRE(queue.Push(3, 0.0f, 1.0f));
+        REQUIRE(queue.Push(1, 1.0f, 0.0f));
+        REQUIRE(queue.Push(2, -1.0f, 0.0f));
+
+        QueuedInput input;
+        REQUIRE(queue.Pop(input));
+        REQUIRE(input.sequenceNumber == 1);
+        REQUIRE(input.moveX == 1.0f);
+
+        REQUIRE(Drain(queue) == eastl::vector<uint32_t>{2, 3});
+        REQUIRE(queue.GetLastConsumed() == 3);
+    }
+
+    SECTION("Duplicates and inputs older than the last consumed are dropped")
+    {
+        InputQueue queue(8);
+        REQUIRE(queue.Push(5, 0.0f, 0.0f));
+        REQUIRE_FALSE(queue.Push(5, 0.0f, 0.0f));
+
+        QueuedInput input;
+        REQUIRE(queue.Pop(input));
+        REQUIRE_FALSE(queue.Push(4, 0.0f, 0.0f));
+        REQUIRE_FALSE(queue.Push(5, 0.0f, 0.0f));
+        REQUIRE(queue.Push(6, 0.0f, 0.0f));
+
+        REQUIRE(queue.Count() == 1);
+        REQUIRE(queue.GetDroppedCount() == 3);
+    }
+
+    SECTION("Overlapping input batches queue each sequence once")
+    {
+        InputQueue queue(8);
+        QueuedInput input;
+        for (uint32_t sequence = 1; sequence <= 4; ++sequence)
+        {
+            queue.Push(sequence, 0.0f, 0.0f);
+        }
+        REQUIRE(queue.Pop(input));
+
+        // The next batch resends 2..4 along with the new 5 and 6
+        for (uint32_t sequence = 2; sequence <= 6; ++sequence)
+        {
+            queue.Push(sequence, 0.0f, 0.0f);
+        }
+
+        REQUIRE(queue.GetDuplicateCount() == 3);
+        REQUIRE(queue.GetDroppedCount() == 3);
+        REQUIRE(Drain(queue) == eastl::vector<uint32_t>{2, 3, 4, 5, 6});
+    }
+
+    SECTION("A full queue drops its oldest input by default")
+    {
+        InputQueue queue(3, InputDropPolicy::DROP_OLDEST);
+        for (uint32_t sequence = 1; sequence <= 5; ++sequence)
+        {
+            REQUIRE(queue.Push(sequence, 0.0f, 0.0f));
+        }
+
+        REQUIRE(queue.GetDroppedCount() == 2);
+        REQUIRE(Drain(queue) == eastl::vector<uint32_t>{3, 4, 5});
+    }
+
+    SECTION("DROP_NEWEST keeps the queued inputs when full")
+    {
+        InputQueue queue(3, InputDropPolicy::DROP_NEWEST);
+        for (uint32_t sequence = 1; sequence <= 5; ++sequence)
+        {
+            queue.Push(sequence, 0.0f, 0.0f);
+        }
+
+        REQUIRE(queue.GetDroppedCount() == 2);
+        REQUIRE(Drain(queue) == eastl::vector<uint32_t>{1, 2, 3});
+    }
+
+    SECTION("A late input still slots in order while the ring wraps")
+    {
+        InputQueue queue(4);
+        QueuedInput input;
+        for (uint32_t sequence = 1; sequence <= 3; ++sequence)
+        {
+            queue.Push(sequence, 0.0f, 0.0f);
+        }
+        REQUIRE(queue.Pop(input));
+        REQUIRE(queue.Pop(input));
+
+        REQUIRE(queue.Push(6, 0.0f, 0.0f));
+        REQUIRE(queue.Push(4, 0.0f, 0.0f));
+        REQUIRE(queue.Push(5, 0.0f, 0.0f));
+
+        REQUIRE(Drain(queue) == eastl::vector<uint32_t>{3, 4, 5, 6});
+    }
+
+    SECTION("Reset lets a reconnecting client start its sequence over")
+    {
+        InputQueue queue(4);
+        QueuedInput input;
+        queue.Push(10, 0.0f, 0.0f);
+        REQUIRE(queue.Pop(input));
+
+        queue.Reset();
+        REQUIRE_FALSE(queue.HasConsumed());
+        REQUIRE(queue.Push(1, 0.0f, 0.0f));
+    }
+}
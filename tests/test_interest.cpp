@@ -0,0 +1,156 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../common/snapshot.hpp"
+#include "../server/interest.hpp"
+#include "../server/spatial_grid.hpp"
+#include <EASTL/algorithm.h>
+
+// A world with its player grid kept in sync, the way GameServer maintains it
+struct InterestWorld
+{
+    WorldState world;
+    SpatialGrid playerGrid;
+
+    InterestWorld()
+        : playerGrid(static_cast<float>(WORLD_WIDTH), static_cast<float>(WORLD_HEIGHT), SPATIAL_CELL_SIZE, MAX_PLAYER_CAPACITY)
+    {
+        world.serverTick = 1;
+    }
+
+    void SetPlayer(uint32_t id, float x, float y, float size = 10.0f)
+    {
+        PlayerTable& players = world.players;
+        int slot = players.Add(id);
+        players.x[slot] = x;
+        players.y[slot] = y;
+        players.size[slot] = size;
+        playerGrid.Insert(slot, x, y);
+    }
+
+    void Build(InterestFilter& filter, int clientIndex, SnapshotState& out, int maxPlayers = MAX_PLAYER_CAPACITY)
+    {
+        float maxRadius = 0.0f;
+        for (int slot = 0; slot < world.players.Count(); ++slot)
+            maxRadius = eastl::max(maxRadius, world.players.size[slot] / 2.0f);
+        filter.Build(clientIndex, world, playerGrid, maxRadius, out, maxPlayers);
+    }
+};
+
+TEST_CASE("Interest management tests", "[interest]")
+{
+    InterestWorld scene;
+    InterestFilter filter(MAX_PLAYER_CAPACITY);
+    SnapshotState state;
+
+    SECTION("View rectangle follows the client camera zoom")
+    {
+        ViewRect small = GetViewRect(1000.0f, 1000.0f, 10.0f);
+        ViewRect large = GetViewRect(1000.0f, 1000.0f, 200.0f);
+
+        float zoom = VIEW_BASE_ZOOM / (1.0f + 10.0f * VIEW_ZOOM_FACTOR);
+        REQUIRE(small.maxX - small.minX == Approx(VIEW_WIDTH / zoom));
+        REQUIRE(small.maxY - small.minY == Approx(VIEW_HEIGHT / zoom));
+        REQUIRE(large.maxX - large.minX > small.maxX - small.minX);
+
+        // Zoom bottoms out, so the view stops growing
+        REQUIRE(GetViewZoom(MAX_PLAYER_SIZE) == VIEW_MIN_ZOOM);
+        REQUIRE(GetViewZoom(0.0f) == VIEW_BASE_ZOOM);
+    }
+
+    SECTION("Only nearby players are included, the viewer first")
+    {
+        scene.SetPlayer(3, 1600.0f, 1200.0f);
+        scene.SetPlayer(5, 1700.0f, 1250.0f);
+        scene.SetPlayer(9, 100.0f, 100.0f);
+
+        scene.Build(filter, 3, state);
+
+        REQUIRE(state.serverTick == 1);
+        REQUIRE(state.players.Count() == 2);
+        REQUIRE(state.players.ids[0] == 3);
+        REQUIRE(state.players.Find(5) >= 0);
+        REQUIRE(state.players.Find(9) == -1);
+    }
+
+    SECTION("Entities leave the view later than they enter it")
+    {
+        scene.SetPlayer(0, 1000.0f, 1000.0f);
+        ViewRect view = GetViewRect(1000.0f, 1000.0f, 10.0f);
+        float between = view.maxX + (INTEREST_ENTER_MARGIN + INTEREST_EXIT_MARGIN) / 2.0f;
+
+        // Not yet visible, and between the margins: stays out
+        scene.SetPlayer(1, between, 1000.0f, 2.0f);
+        scene.Build(filter, 0, state);
+        REQUIRE(state.players.Find(1) == -1);
+
+        // Comes inside the view, then backs off between the margins: stays in
+        scene.world.players.x[1] = view.maxX - 10.0f;
+        scene.playerGrid.Move(1, view.maxX - 10.0f, 1000.0f);
+        scene.Build(filter, 0, state);
+        REQUIRE(state.players.Find(1) >= 0);
+
+        scene.world.players.x[1] = between;
+        scene.playerGrid.Move(1, between, 1000.0f);
+        scene.Build(filter, 0, state);
+        REQUIRE(state.players.Find(1) >= 0);
+
+        // Past the exit margin it drops out
+        float outside = view.maxX + INTEREST_EXIT_MARGIN + 50.0f;
+        scene.world.players.x[1] = outside;
+        scene.playerGrid.Move(1, outside, 1000.0f);
+        scene.Build(filter, 0, state);
+        REQUIRE(state.players.Find(1) == -1);
+        REQUIRE_FALSE(filter.GetInterestSet(0).HasPlayer(1));
+    }
+
+    SECTION("A player budget keeps the nearest players")
+    {
+        scene.SetPlayer(0, 1000.0f, 1000.0f);
+        for (uint32_t id = 1; id <= 6; ++id)
+            scene.SetPlayer(id, 1000.0f + 40.0f * id, 1000.0f);
+
+        scene.Build(filter, 0, state, 3);
+        REQUIRE(state.players.Count() == 3);
+        REQUIRE(state.players.ids[0] == 0);
+        REQUIRE(state.players.Find(1) >= 0);
+        REQUIRE(state.players.Find(2) >= 0);
+        REQUIRE_FALSE(filter.GetInterestSet(0).HasPlayer(3));
+
+        scene.Build(filter, 0, state);
+        REQUIRE(state.players.Count() == 7);
+    }
+
+    SECTION("Players trimmed after the build do not count as seen")
+    {
+        scene.SetPlayer(0, 1000.0f, 1000.0f);
+        ViewRect view = GetViewRect(1000.0f, 1000.0f, 10.0f);
+        float between = view.maxX + (INTEREST_ENTER_MARGIN + INTEREST_EXIT_MARGIN) / 2.0f;
+        scene.SetPlayer(1, view.maxX - 10.0f, 1000.0f, 2.0f);
+        scene.Build(filter, 0, state);
+        REQUIRE(filter.GetInterestSet(0).HasPlayer(1));
+
+        // A byte budget left player 1 out of what was actually sent
+        state.players.Remove(1);
+        filter.Commit(0, state);
+        REQUIRE(filter.GetInterestSet(0).HasPlayer(0));
+        REQUIRE_FALSE(filter.GetInterestSet(0).HasPlayer(1));
+
+        // So it has to pass the enter margin again rather than the exit one
+        scene.world.players.x[1] = between;
+        scene.playerGrid.Move(1, between, 1000.0f);
+        scene.Build(filter, 0, state);
+        REQUIRE(state.players.Find(1) == -1);
+    }
+
+    SECTION("Reset forgets what a reused client slot saw")
+    {
+        scene.SetPlayer(0, 1000.0f, 1000.0f);
+        scene.SetPlayer(1, 1010.0f, 1010.0f);
+        scene.Build(filter, 0, state);
+        REQUIRE(filter.GetInterestSet(0).HasPlayer(1));
+
+        filter.Reset(0);
+        REQUIRE_FALSE(filter.GetInterestSet(0).HasPlayer(1));
+        REQUIRE_FALSE(filter.GetInterestSet(0).HasPlayer(0));
+    }
+}
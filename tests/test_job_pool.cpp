@@ -0,0 +1,129 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../common/snapshot.hpp"
+#include "../server/job_pool.hpp"
+#include "../server/interest.hpp"
+#include "../server/spatial_grid.hpp"
+#include <EASTL/vector.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+TEST_CASE("Job pool tests", "[jobs]")
+{
+    SECTION("Every index runs exactly once on a valid worker")
+    {
+        for (int workers : {1, 2, 4, 7})
+        {
+            JobPool pool(workers);
+            REQUIRE(pool.GetWorkerCount() == workers);
+
+            for (int count : {0, 1, 3, 100, 1000})
+            {
+                eastl::vector<std::atomic<int>> runs(count);
+                for (auto &run : runs)
+                    run.store(0);
+                std::atomic<bool> validWorker(true);
+
+                pool.ParallelFor(count, [&](int index, int worker) {
+                    runs[index].fetch_add(1);
+                    if (worker < 0 || worker >= workers)
+                        validWorker.store(false);
+                });
+
+                bool once = true;
+                for (auto &run : runs)
+                    once = once && run.load() == 1;
+                REQUIRE(once);
+                REQUIRE(validWorker.load());
+            }
+        }
+    }
+
+    SECTION("One worker runs everything inline, in order")
+    {
+        JobPool pool(1);
+        const std::thread::id caller = std::this_thread::get_id();
+        eastl::vector<int> order;
+        bool onCaller = true;
+
+        pool.ParallelFor(10, [&](int index, int worker) {
+            order.push_back(index);
+            onCaller = onCaller && worker == 0 && std::this_thread::get_id() == caller;
+        });
+
+        REQUIRE(onCaller);
+        REQUIRE(order.size() == 10);
+        for (int i = 0; i < 10; ++i)
+            REQUIRE(order[i] == i);
+    }
+
+    SECTION("Idle workers steal from a worker stuck on slow jobs")
+    {
+        JobPool pool(4);
+        std::atomic<int> done(0);
+
+        // The first quarter is worker 0's range; only its jobs are slow
+        pool.ParallelFor(64, [&](int index, int) {
+            if (index < 16)
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            done.fetch_add(1);
+        });
+
+        const JobPoolStats stats = pool.GetStats();
+        REQUIRE(done.load() == 64);
+        REQUIRE(stats.runs == 1);
+        REQUIRE(stats.jobs == 64);
+        REQUIRE(stats.steals > 0);
+    }
+
+    SECTION("Worker counts resolve to at least one and at most the cap")
+    {
+        REQUIRE(JobPool::ResolveWorkerCount(3) == 3);
+        REQUIRE(JobPool::ResolveWorkerCount(0) >= 1);
+        REQUIRE(JobPool::ResolveWorkerCount(MAX_JOB_WORKERS + 10) == MAX_JOB_WORKERS);
+        REQUIRE(JobPool(0).GetWorkerCount() == 1);
+    }
+
+    SECTION("Interest builds spread over workers match the serial ones")
+    {
+        const int clients = 64;
+        WorldState world;
+        world.serverTick = 1;
+        SpatialGrid playerGrid(static_cast<float>(WORLD_WIDTH), static_cast<float>(WORLD_HEIGHT), SPATIAL_CELL_SIZE,
+                               MAX_PLAYER_CAPACITY);
+        srand(42);
+        for (int id = 0; id < clients; ++id)
+        {
+            int slot = world.players.Add(id);
+            world.players.x[slot] = static_cast<float>(rand() % 800);
+            world.players.y[slot] = static_cast<float>(rand() % 600);
+            world.players.size[slot] = 10.0f + rand() % 50;
+            playerGrid.Insert(slot, world.players.x[slot], world.players.y[slot]);
+        }
+
+        JobPool pool(4);
+        InterestFilter serialFilter(clients);
+        InterestFilter parallelFilter(clients, pool.GetWorkerCount());
+        eastl::vector<SnapshotState> serial(clients);
+        eastl::vector<SnapshotState> parallel(clients);
+
+        for (int client = 0; client < clients; ++client)
+            serialFilter.Build(client, world, playerGrid, 30.0f, serial[client], 8);
+        pool.ParallelFor(clients, [&](int client, int worker) {
+            parallelFilter.Build(client, world, playerGrid, 30.0f, parallel[client], 8, worker);
+        });
+
+        bool same = true;
+        for (int client = 0; client < clients; ++client)
+        {
+            const PlayerTable &a = serial[client].players;
+            const PlayerTable &b = parallel[client].players;
+            same = same && a.Count() == b.Count();
+            for (int slot = 0; same && slot < a.Count(); ++slot)
+                same = a.ids[slot] == b.ids[slot];
+        }
+        REQUIRE(same);
+    }
+}
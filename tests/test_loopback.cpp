@@ -0,0 +1,154 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "loopback_server.hpp"
+#include "../server/game_server.hpp"
+#include "../client/game_client.hpp"
+#include <yojimbo.h>
+
+// Ticks until the client has its local player, or -1 after `maxTicks`
+static int TicksUntilSpawned(LoopbackNetwork& network, GameServer& server, GameClient& client, int maxTicks)
+{
+    for (int tick = 1; tick <= maxTicks; ++tick)
+    {
+        PumpLoopback(network, server, {&client});
+        if (client.IsLocalPlayerCreated())
+            return tick;
+    }
+    return -1;
+}
+
+TEST_CASE("Loopback network tests", "[loopback]")
+{
+    REQUIRE(InitializeYojimbo());
+
+    SECTION("The virtual clock only moves when advanced")
+    {
+        VirtualClock clock;
+        REQUIRE(clock.GetTime() == 0.0);
+        REQUIRE(clock.Advance(0.5) == 0.5);
+        REQUIRE(clock.Advance(0.25) == 0.75);
+        REQUIRE(clock.GetTime() == 0.75);
+    }
+
+    SECTION("Thousands of ticks run without sockets or sleeps")
+    {
+        LoopbackNetwork network;
+        LoopbackServer server(network);
+        GameClient client(network);
+
+        REQUIRE(TicksUntilSpawned(network, server, client, 10) > 0);
+        PumpLoopback(network, server, {&client}, 5000);
+
+        REQUIRE(client.IsConnected());
+        REQUIRE(network.GetTime() > 5000.0 / TICK_RATE);
+        REQUIRE(network.GetPacketsDelivered() > 0);
+        REQUIRE(network.GetPacketsDropped() == 0);
+    }
+
+    SECTION("Latency delays delivery by whole ticks of virtual time")
+    {
+        LoopbackConfig config;
+        config.latency = 0.1;
+        LoopbackNetwork network(config);
+        LoopbackServer server(network);
+        GameClient client(network);
+
+        int ticks = TicksUntilSpawned(network, server, client, 100);
+        REQUIRE(ticks >= static_cast<int>(config.latency * TICK_RATE));
+        REQUIRE(network.GetPacketsInFlight() > 0);
+    }
+
+    SECTION("Loss and jitter are repeatable for a seed")
+    {
+        LoopbackConfig config;
+        config.latency = 0.05;
+        config.jitter = 0.02;
+        config.packetLoss = 0.25f;
+        config.seed = 1234;
+
+        const int maxTicks = 300;
+        int ticks[2];
+        uint64_t dropped[2];
+        uint64_t delivered[2];
+        for (int run = 0; run < 2; ++run)
+        {
+            // Spawn positions come from rand(), and they change snapshot sizes
+            srand(config.seed);
+            LoopbackNetwork network(config);
+            LoopbackServer server(network);
+            GameClient client(network);
+
+            ticks[run] = TicksUntilSpawned(network, server, client, maxTicks);
+            dropped[run] = network.GetPacketsDropped();
+            delivered[run] = network.GetPacketsDelivered();
+        }
+
+        REQUIRE(ticks[0] > 0);
+        REQUIRE(ticks[0] < maxTicks);
+        REQUIRE(ticks[0] == ticks[1]);
+        REQUIRE(dropped[0] > 0);
+        REQUIRE(dropped[0] == dropped[1]);
+        REQUIRE(delivered[0] == delivered[1]);
+    }
+
+    SECTION("Other players render between two snapshots at a low snapshot rate")
+    {
+        srand(1);
+        LoopbackNetwork network;
+        LoopbackServer server(network);
+        server.SetInterestManagement(false);
+        server.SetSnapshotRate(5);
+        GameClient mover(network);
+        GameClient observer(network);
+
+        for (int i = 0; i < 2 * TICK_RATE && observer.GetOtherPlayerCount() == 0; ++i)
+            PumpLoopback(network, server, {&mover, &observer});
+        REQUIRE(observer.GetOtherPlayerCount() == 1);
+
+        // Toward the middle of the world, so no wall stops it
+        const float direction = observer.GetOtherPlayers().begin()->second.position.x < WORLD_WIDTH / 2 ? 1.0f : -1.0f;
+        mover.SetScriptedInput(direction, 0.0f);
+        PumpLoopback(network, server, {&mover, &observer}, 2 * TICK_RATE);
+
+        const double interval = static_cast<double>(GetSnapshotInterval(5)) / TICK_RATE;
+        REQUIRE(observer.GetInterpolationDelay() == Approx(INTERPOLATION_INTERVALS * interval));
+
+        // Snapshots land every 200 ms; a position held between frames would
+        // mean rendering ran past the newest one and clamped to it
+        float previous = observer.GetOtherPlayers().begin()->second.position.x;
+        for (int i = 0; i < TICK_RATE; ++i)
+        {
+            PumpLoopback(network, server, {&mover, &observer});
+            REQUIRE(observer.GetOtherPlayerCount() == 1);
+            const float x = observer.GetOtherPlayers().begin()->second.position.x;
+            REQUIRE((x - previous) * direction > 0.0f);
+            previous = x;
+        }
+    }
+
+    SECTION("Clients beyond the server's capacity are refused")
+    {
+        LoopbackNetwork network;
+        LoopbackServer server(network, 1);
+
+        GameClient first(network);
+        GameClient second(network);
+        REQUIRE(first.IsConnected());
+        REQUIRE_FALSE(second.IsConnected());
+        REQUIRE(server.GetConnectedClientCount() == 1);
+    }
+
+    SECTION("A destroyed server leaves its clients disconnected")
+    {
+        LoopbackNetwork network;
+        auto server = std::make_unique<LoopbackServer>(network);
+        GameClient client(network);
+        REQUIRE(client.IsConnected());
+
+        server.reset();
+        REQUIRE_FALSE(client.IsConnected());
+        network.Update(1.0 / TICK_RATE);
+    }
+
+    ShutdownYojimbo();
+}
@@ -0,0 +1,147 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../common/memory_budget.hpp"
+#include "loopback_server.hpp"
+#include "../server/game_server.hpp"
+#include "../client/game_client.hpp"
+#include <yojimbo.h>
+#include <cstdlib>
+#include <memory>
+
+TEST_CASE("Connection memory budget tests", "[memory]")
+{
+    SECTION("Live bytes and the peak follow allocations and frees")
+    {
+        const size_t blockBytes = 256 * 1024;
+        void *memory = malloc(blockBytes);
+        ConnectionMemoryStats stats;
+        {
+            BudgetedAllocator allocator(memory, blockBytes, stats);
+            REQUIRE(stats.budget == blockBytes);
+
+            void *a = YOJIMBO_ALLOCATE(allocator, 1000);
+            void *b = YOJIMBO_ALLOCATE(allocator, 3000);
+            REQUIRE(stats.inUse == 4000 + 2 * BudgetedAllocator::HEADER_BYTES);
+            REQUIRE(stats.allocations == 2);
+
+            YOJIMBO_FREE(allocator, a);
+            YOJIMBO_FREE(allocator, b);
+            REQUIRE(stats.inUse == 0);
+            REQUIRE(stats.highWater == 4000 + 2 * BudgetedAllocator::HEADER_BYTES);
+        }
+        free(memory);
+    }
+
+    SECTION("An exhausted block counts the failure and raises the error yojimbo checks")
+    {
+        const size_t blockBytes = 64 * 1024;
+        void *memory = malloc(blockBytes);
+        ConnectionMemoryStats stats;
+        {
+            BudgetedAllocator allocator(memory, blockBytes, stats);
+            void *p = YOJIMBO_ALLOCATE(allocator, 2 * blockBytes);
+            REQUIRE(p == nullptr);
+            REQUIRE(stats.failures == 1);
+            REQUIRE(allocator.GetErrorLevel() != yojimbo::ALLOCATOR_ERROR_NONE);
+        }
+        free(memory);
+    }
+
+    SECTION("Recommendations add headroom and round up")
+    {
+        REQUIRE(RecommendConnectionMemory(0) == (int)CONNECTION_MEMORY_MINIMUM);
+        const int recommended = RecommendConnectionMemory(1000000);
+        REQUIRE(recommended >= 1500000);
+        REQUIRE(recommended % CONNECTION_MEMORY_GRANULARITY == 0);
+        REQUIRE(RecommendConnectionMemory(1000000, 0.0f) < recommended);
+    }
+
+    SECTION("A measured budget replaces the server's estimate only")
+    {
+        GameConnectionConfig estimated(DEFAULT_MAX_PLAYERS);
+        GameConnectionConfig measured(DEFAULT_MAX_PLAYERS, 512 * 1024);
+        REQUIRE(measured.serverPerClientMemory == 512 * 1024);
+        REQUIRE(measured.clientMemory == estimated.clientMemory);
+    }
+
+    SECTION("Slots are found by the memory their allocator wraps, whatever the creation order")
+    {
+        yojimbo::DefaultAllocator backing;
+        const size_t blockBytes = 64 * 1024;
+        void *memory[3] = {malloc(blockBytes), malloc(blockBytes), malloc(blockBytes)};
+        {
+            GameAdapter adapter(nullptr);
+            yojimbo::Allocator *allocators[3];
+            for (int i = 0; i < 3; ++i)
+                allocators[i] = adapter.CreateAllocator(backing, memory[i], blockBytes);
+
+            // Slot 0 is the last block, slot 1 the middle one; the first is left global
+            adapter.BeginClientMemoryBinding();
+            void *probe0 = YOJIMBO_ALLOCATE(*allocators[2], 1);
+            void *probe1 = YOJIMBO_ALLOCATE(*allocators[1], 1);
+            REQUIRE(adapter.BindClientMemory(0, probe0));
+            REQUIRE(adapter.BindClientMemory(1, probe1));
+            YOJIMBO_FREE(*allocators[2], probe0);
+            YOJIMBO_FREE(*allocators[1], probe1);
+            adapter.EndClientMemoryBinding();
+            REQUIRE(adapter.GetClientMemoryStats(0).allocations == 0);
+
+            void *p = YOJIMBO_ALLOCATE(*allocators[2], 1000);
+            REQUIRE(adapter.GetClientMemoryStats(0).inUse == 1000 + BudgetedAllocator::HEADER_BYTES);
+            REQUIRE(adapter.GetClientMemoryStats(1).inUse == 0);
+            void *global = YOJIMBO_ALLOCATE(*allocators[0], 100);
+            REQUIRE(adapter.GetGlobalMemoryStats().allocations == 1);
+            YOJIMBO_FREE(*allocators[0], global);
+
+            // A failed allocation no longer outlives the client that hit it
+            REQUIRE(YOJIMBO_ALLOCATE(*allocators[2], 2 * blockBytes) == nullptr);
+            REQUIRE(allocators[2]->GetErrorLevel() != yojimbo::ALLOCATOR_ERROR_NONE);
+            adapter.OnServerClientDisconnected(0);
+            REQUIRE(allocators[2]->GetErrorLevel() == yojimbo::ALLOCATOR_ERROR_NONE);
+            REQUIRE(adapter.GetClientMemoryStats(0).failures == 1);
+
+            YOJIMBO_FREE(*allocators[2], p);
+            for (yojimbo::Allocator *allocator : allocators)
+                YOJIMBO_DELETE(backing, Allocator, allocator);
+        }
+        for (void *block : memory)
+            free(block);
+    }
+
+    SECTION("A room run on its recommended budget fits without failures")
+    {
+        REQUIRE(InitializeYojimbo());
+        int recommended = 0;
+        {
+            LoopbackNetwork network;
+            LoopbackServer server(network);
+            eastl::vector<std::unique_ptr<GameClient>> clients;
+            for (int i = 0; i < 4; ++i)
+                clients.push_back(std::make_unique<GameClient>(network));
+            PumpLoopback(network, server, clients, 3 * TICK_RATE);
+
+            for (int i = 0; i < 4; ++i)
+            {
+                const ConnectionMemoryStats &stats = server.GetClientMemoryStats(i);
+                REQUIRE(stats.highWater > 0);
+                REQUIRE(stats.highWater <= stats.budget);
+                REQUIRE(stats.failures == 0);
+            }
+            recommended = server.GetRecommendedClientMemory();
+            REQUIRE(recommended < GameConnectionConfig().serverPerClientMemory);
+        }
+        {
+            LoopbackNetwork network;
+            LoopbackServer server(network, DEFAULT_MAX_PLAYERS, recommended);
+            eastl::vector<std::unique_ptr<GameClient>> clients;
+            for (int i = 0; i < 4; ++i)
+                clients.push_back(std::make_unique<GameClient>(network));
+            PumpLoopback(network, server, clients, 3 * TICK_RATE);
+
+            REQUIRE(server.GetConnectedClientCount() == 4);
+            for (int i = 0; i < 4; ++i)
+                REQUIRE(server.GetClientMemoryStats(i).failures == 0);
+        }
+        ShutdownYojimbo();
+    }
+}
@@ -0,0 +1,148 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../common/message_pool.hpp"
+#include "../common/memory_budget.hpp"
+#include <yojimbo.h>
+#include <EASTL/vector.h>
+#include <cstdint>
+#include <cstdlib>
+
+TEST_CASE("Message pool tests", "[pool]")
+{
+    yojimbo::DefaultAllocator allocator;
+
+    SECTION("Snapshots are created and released without touching the backing allocator")
+    {
+        GameMessageFactory factory(allocator);
+        for (int tick = 0; tick < 100; ++tick)
+        {
+            WorldStateMessage *message =
+                static_cast<WorldStateMessage *>(factory.CreateMessage((int)GameMessageType::WORLD_STATE));
+            REQUIRE(message != nullptr);
+            REQUIRE(message->AllocatePlayers(MAX_PLAYER_CAPACITY));
+            message->playerIds[MAX_PLAYER_CAPACITY - 1] = 7;
+            factory.ReleaseMessage(message);
+        }
+
+        const MessagePoolStats &stats = factory.GetPoolStats();
+        REQUIRE(stats.hits == 200);
+        REQUIRE(stats.misses == 0);
+        REQUIRE(stats.inUse == 0);
+        REQUIRE(stats.highWater == 2);
+    }
+
+    SECTION("Player counts up to the allocated room are set without allocating")
+    {
+        GameMessageFactory factory(allocator);
+        WorldStateMessage *message =
+            static_cast<WorldStateMessage *>(factory.CreateMessage((int)GameMessageType::WORLD_STATE));
+        REQUIRE(message->AllocatePlayers(8));
+        const uint64_t hits = factory.GetPoolStats().hits;
+        const uint64_t misses = factory.GetPoolStats().misses;
+
+        REQUIRE(message->SetPlayerCount(3));
+        REQUIRE(message->numPlayers == 3);
+        REQUIRE(message->SetPlayerCount(8));
+        REQUIRE_FALSE(message->SetPlayerCount(9));
+        REQUIRE(message->numPlayers == 8);
+        REQUIRE(factory.GetPoolStats().hits == hits);
+        REQUIRE(factory.GetPoolStats().misses == misses);
+        factory.ReleaseMessage(message);
+    }
+
+    SECTION("Released slots are handed out again")
+    {
+        GameMessageFactory factory(allocator);
+        yojimbo::Message *first = factory.CreateMessage((int)GameMessageType::SNAPSHOT_ACK);
+        factory.ReleaseMessage(first);
+        yojimbo::Message *second = factory.CreateMessage((int)GameMessageType::PLAYER_INPUT_BATCH);
+        REQUIRE(second == first);
+        factory.ReleaseMessage(second);
+    }
+
+    SECTION("An empty size class falls back to the backing allocator")
+    {
+        GameMessageFactory factory(allocator);
+        eastl::vector<yojimbo::Message *> messages;
+        for (int i = 0; i < MESSAGE_POOL_SMALL_SLOTS + 1; ++i)
+        {
+            messages.push_back(factory.CreateMessage((int)GameMessageType::PLAYER_INPUT));
+            REQUIRE(messages.back() != nullptr);
+        }
+        REQUIRE(factory.GetPoolStats().misses == 1);
+        REQUIRE(factory.GetPoolStats().highWater == MESSAGE_POOL_SMALL_SLOTS);
+
+        for (yojimbo::Message *message : messages)
+            factory.ReleaseMessage(message);
+        REQUIRE(factory.GetPoolStats().inUse == 0);
+    }
+
+    SECTION("Allocations larger than every slot go straight to the backing allocator")
+    {
+        MessagePoolAllocator pool(allocator, 64, 4, 256, 2);
+        REQUIRE(pool.GetPool(0).GetSlotBytes() == 64);
+        REQUIRE(pool.GetPool(1).GetCount() == 2);
+
+        void *small = YOJIMBO_ALLOCATE(pool, 40);
+        void *large = YOJIMBO_ALLOCATE(pool, 200);
+        void *huge = YOJIMBO_ALLOCATE(pool, 4096);
+        REQUIRE(pool.GetPool(0).Owns(small));
+        REQUIRE(pool.GetPool(1).Owns(large));
+        REQUIRE_FALSE(pool.GetPool(0).Owns(huge));
+        REQUIRE_FALSE(pool.GetPool(1).Owns(huge));
+        REQUIRE(pool.GetStats().hits == 2);
+        REQUIRE(pool.GetStats().misses == 1);
+
+        YOJIMBO_FREE(pool, small);
+        YOJIMBO_FREE(pool, large);
+        YOJIMBO_FREE(pool, huge);
+        REQUIRE(pool.GetStats().inUse == 0);
+    }
+
+    SECTION("Shared counters total several factories")
+    {
+        MessagePoolStats total;
+        GameMessageFactory first(allocator, &total);
+        GameMessageFactory second(allocator, &total);
+
+        yojimbo::Message *a = first.CreateMessage((int)GameMessageType::SNAPSHOT_ACK);
+        yojimbo::Message *b = second.CreateMessage((int)GameMessageType::SNAPSHOT_ACK);
+        REQUIRE(total.hits == 2);
+        REQUIRE(total.highWater == 2);
+        REQUIRE(first.GetPoolStats().highWater == 1);
+
+        first.ReleaseMessage(a);
+        second.ReleaseMessage(b);
+        REQUIRE(total.inUse == 0);
+    }
+
+    SECTION("Slots stay aligned over a budgeted connection allocator")
+    {
+        // TLSF only guarantees 8 bytes; starting the block at both offsets
+        // makes one of the runs hand the pool a slab that is not 16-aligned
+        const size_t blockBytes = 64 * 1024;
+        uint8_t *memory = static_cast<uint8_t *>(malloc(blockBytes + 8));
+        for (size_t offset : {0, 8})
+        {
+            ConnectionMemoryStats stats;
+            {
+                BudgetedAllocator budgeted(memory + offset, blockBytes, stats);
+                MessagePoolAllocator pool(budgeted, 40, 8, 200, 4);
+                eastl::vector<void *> slots;
+                for (int i = 0; i < 12; ++i)
+                    slots.push_back(YOJIMBO_ALLOCATE(pool, i < 8 ? 40 : 200));
+                REQUIRE(pool.GetStats().hits == 12);
+
+                bool aligned = true;
+                for (void *slot : slots)
+                    aligned = aligned && (reinterpret_cast<uintptr_t>(slot) % MESSAGE_POOL_ALIGNMENT) == 0;
+                REQUIRE(aligned);
+
+                for (void *slot : slots)
+                    YOJIMBO_FREE(pool, slot);
+            }
+            REQUIRE(stats.inUse == 0);
+        }
+        free(memory);
+    }
+}
@@ -0,0 +1,151 @@
+#include "catch.hpp"
+#include "../server/spsc_ring.hpp"
+#include "../server/network_thread.hpp"
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#if CIRC_BATCHED_TRANSPORT
+#include <cstring>
+#include <arpa/inet.h>
+#endif
+
+TEST_CASE("Network thread tests", "[iothread]")
+{
+    SECTION("The ring hands slots back in order and reports full and empty")
+    {
+        SpscRing<int> ring(3);
+        REQUIRE(ring.GetCapacity() == 4);
+        REQUIRE(ring.Front() == nullptr);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            int *slot = ring.BeginPush();
+            REQUIRE(slot != nullptr);
+            *slot = i;
+            ring.EndPush();
+        }
+        REQUIRE(ring.BeginPush() == nullptr);
+        REQUIRE(ring.GetSize() == 4);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            int *slot = ring.Front();
+            REQUIRE(slot != nullptr);
+            REQUIRE(*slot == i);
+            ring.Pop();
+        }
+        REQUIRE(ring.Front() == nullptr);
+    }
+
+    SECTION("Values cross between two threads intact and in order")
+    {
+        const uint32_t COUNT = 200000;
+        SpscRing<uint32_t> ring(64);
+
+        std::thread producer([&ring, COUNT]() {
+            for (uint32_t i = 0; i < COUNT; ++i)
+            {
+                uint32_t *slot;
+                while ((slot = ring.BeginPush()) == nullptr)
+                    std::this_thread::yield();
+                *slot = i;
+                ring.EndPush();
+            }
+        });
+
+        uint32_t expected = 0;
+        bool ordered = true;
+        while (expected < COUNT)
+        {
+            uint32_t *slot = ring.Front();
+            if (!slot)
+                continue;
+            ordered = ordered && *slot == expected;
+            ring.Pop();
+            expected++;
+        }
+        producer.join();
+
+        REQUIRE(ordered);
+        REQUIRE(ring.Front() == nullptr);
+    }
+
+#if CIRC_BATCHED_TRANSPORT
+    SECTION("Datagrams go out and come in through the I/O thread")
+    {
+        sockaddr_storage bind;
+        memset(&bind, 0, sizeof(bind));
+        sockaddr_in &ipv4 = reinterpret_cast<sockaddr_in &>(bind);
+        ipv4.sin_family = AF_INET;
+        ipv4.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        NetworkThread network;
+        BatchedSocket peer;
+        REQUIRE(network.Start(bind));
+        REQUIRE(network.IsRunning());
+        REQUIRE(peer.Open(bind));
+
+        sockaddr_storage toPeer = bind;
+        reinterpret_cast<sockaddr_in &>(toPeer).sin_port = htons(peer.GetPort());
+        sockaddr_storage toNetwork = bind;
+        reinterpret_cast<sockaddr_in &>(toNetwork).sin_port = htons(network.GetPort());
+
+        uint8_t packet[TRANSPORT_MAX_PACKET_BYTES];
+        sockaddr_storage from;
+        const int COUNT = 10;
+
+        for (int i = 0; i < COUNT; ++i)
+        {
+            memset(packet, i, 100);
+            network.Send(toPeer, packet, 100);
+        }
+        network.Flush();
+
+        int received = 0;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (received < COUNT && std::chrono::steady_clock::now() < deadline)
+        {
+            int bytes = peer.Receive(from, packet, sizeof(packet));
+            if (bytes == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            REQUIRE(bytes == 100);
+            REQUIRE(packet[0] == received);
+            received++;
+        }
+        REQUIRE(received == COUNT);
+
+        for (int i = 0; i < COUNT; ++i)
+        {
+            memset(packet, i, 50);
+            peer.Send(toNetwork, packet, 50);
+        }
+        peer.Flush();
+
+        received = 0;
+        deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (received < COUNT && std::chrono::steady_clock::now() < deadline)
+        {
+            int bytes = network.Receive(from, packet, sizeof(packet));
+            if (bytes == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            REQUIRE(bytes == 50);
+            REQUIRE(packet[0] == received);
+            REQUIRE(ntohs(reinterpret_cast<sockaddr_in &>(from).sin_port) == peer.GetPort());
+            received++;
+        }
+        REQUIRE(received == COUNT);
+
+        network.Stop();
+        REQUIRE_FALSE(network.IsRunning());
+        REQUIRE(network.GetTransportStats().packetsSent == COUNT);
+        REQUIRE(network.GetTransportStats().packetsReceived == COUNT);
+        REQUIRE(network.GetStats().outboundDropped == 0);
+    }
+#endif
+}
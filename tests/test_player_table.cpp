@@ -0,0 +1,89 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+
+static Player MakePlayer(uint32_t id, float x, float y, float size)
+{
+    Player player;
+    player.id = id;
+    player.position = Position(x, y);
+    player.velocity = {1.0f, -1.0f};
+    player.size = size;
+    player.color = 0xFF0000FF;
+    return player;
+}
+
+TEST_CASE("Player table tests", "[players]")
+{
+    PlayerTable table;
+
+    SECTION("Add assigns dense slots and Find maps client index to slot")
+    {
+        int slot3 = table.Add(3);
+        int slot0 = table.Add(0);
+
+        REQUIRE(table.Count() == 2);
+        REQUIRE(slot3 == 0);
+        REQUIRE(slot0 == 1);
+        REQUIRE(table.Find(3) == 0);
+        REQUIRE(table.Find(0) == 1);
+        REQUIRE(table.Find(1) == -1);
+        REQUIRE(table.Find(100) == -1);
+    }
+
+    SECTION("Adding an existing client returns its slot")
+    {
+        int slot = table.Add(5);
+        REQUIRE(table.Add(5) == slot);
+        REQUIRE(table.Count() == 1);
+    }
+
+    SECTION("Set and Get round trip every field")
+    {
+        int slot = table.Add(2);
+        table.Set(slot, MakePlayer(2, 10.0f, 20.0f, 15.0f));
+
+        Player player = table.Get(slot);
+        REQUIRE(player.id == 2);
+        REQUIRE(player.position.x == 10.0f);
+        REQUIRE(player.position.y == 20.0f);
+        REQUIRE(player.velocity.x == 1.0f);
+        REQUIRE(player.velocity.y == -1.0f);
+        REQUIRE(player.size == 15.0f);
+        REQUIRE(player.color == 0xFF0000FF);
+    }
+
+    SECTION("Remove swaps the last player into the hole")
+    {
+        for (uint32_t clientIndex = 0; clientIndex < 4; ++clientIndex)
+        {
+            int slot = table.Add(clientIndex);
+            table.Set(slot, MakePlayer(clientIndex, clientIndex * 100.0f, 0.0f, 10.0f + clientIndex));
+        }
+
+        REQUIRE(table.Remove(1));
+        REQUIRE_FALSE(table.Remove(1));
+
+        REQUIRE(table.Count() == 3);
+        REQUIRE(table.Find(1) == -1);
+
+        // Client 3 was last and now fills slot 1
+        REQUIRE(table.Find(3) == 1);
+        REQUIRE(table.ids[1] == 3);
+        REQUIRE(table.x[1] == 300.0f);
+        REQUIRE(table.size[1] == 13.0f);
+
+        REQUIRE(table.Find(0) == 0);
+        REQUIRE(table.Find(2) == 2);
+    }
+
+    SECTION("Removing the last slot leaves the others untouched")
+    {
+        table.Add(0);
+        table.Add(1);
+
+        REQUIRE(table.Remove(1));
+        REQUIRE(table.Count() == 1);
+        REQUIRE(table.Find(0) == 0);
+        REQUIRE(table.ids[0] == 0);
+    }
+}
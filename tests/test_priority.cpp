@@ -0,0 +1,122 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../common/snapshot.hpp"
+#include "../server/priority.hpp"
+#include <yojimbo.h>
+
+static void FillCrowd(SnapshotState& state, uint32_t tick, int numPlayers, float step)
+{
+    state.serverTick = tick;
+    state.timestamp = tick / 60.0;
+    state.players.Clear();
+    for (int i = 0; i < numPlayers; ++i)
+    {
+        int slot = state.players.Add(i);
+        state.players.x[slot] = POSITION_X_QUANTIZATION.Snap(1000.0f + step * i + tick);
+        state.players.y[slot] = POSITION_Y_QUANTIZATION.Snap(1000.0f + tick);
+        state.players.velX[slot] = 200.0f;
+        state.players.velY[slot] = 0.0f;
+        state.players.size[slot] = 10.0f;
+        state.players.color[slot] = 0xFF0000FF;
+    }
+}
+
+// Serialized size of the message WriteSnapshot builds from `state`
+static int SnapshotBytes(GameMessageFactory& factory, const SnapshotState& state, const SnapshotState* baseline)
+{
+    WorldStateMessage* message = static_cast<WorldStateMessage*>(factory.CreateMessage((int)GameMessageType::WORLD_STATE));
+    REQUIRE(message != nullptr);
+    REQUIRE(message->AllocatePlayers(state.players.Count()));
+    WriteSnapshot(*message, state, baseline);
+    message->quantized = true;
+
+    static uint8_t buffer[64 * 1024];
+    yojimbo::WriteStream stream(buffer, sizeof(buffer));
+    REQUIRE(message->SerializeInternal(stream));
+    stream.Flush();
+    int bytes = stream.GetBytesProcessed();
+    factory.ReleaseMessage(message);
+    return bytes;
+}
+
+TEST_CASE("Priority accumulator tests", "[priority]")
+{
+    yojimbo::DefaultAllocator allocator;
+    GameMessageFactory factory(allocator);
+    PriorityAccumulator accumulator(MAX_PLAYER_CAPACITY);
+    const int BUDGET = 200;
+    const float ELAPSED = 3.0f / TICK_RATE;
+
+    SECTION("Entry cost estimates match the serializer")
+    {
+        SnapshotState state;
+        FillCrowd(state, 10, 5, 50.0f);
+        int bits = GetSnapshotHeaderBits(false) + 5 * GetPlayerEntryBits(PLAYER_CHANGED_ALL, false, true);
+        REQUIRE(SnapshotBytes(factory, state, nullptr) == (bits + 7) / 8);
+    }
+
+    SECTION("A full snapshot is cut to the budget, the viewer and nearest first")
+    {
+        SnapshotState state;
+        FillCrowd(state, 10, MAX_PLAYER_CAPACITY, 20.0f);
+
+        int deferred = accumulator.Apply(0, state, nullptr, true, BUDGET, ELAPSED);
+        REQUIRE(deferred > 0);
+        REQUIRE(state.players.Count() == MAX_PLAYER_CAPACITY - deferred);
+        REQUIRE(SnapshotBytes(factory, state, nullptr) <= BUDGET);
+        REQUIRE(state.players.Find(0) >= 0);
+        REQUIRE(state.players.Find(1) >= 0);
+        REQUIRE(state.players.Find(MAX_PLAYER_CAPACITY - 1) == -1);
+
+        // Sent players start over, deferred ones keep what they accrued
+        REQUIRE(accumulator.GetPriority(0, 1) == 0.0f);
+        REQUIRE(accumulator.GetPriority(0, MAX_PLAYER_CAPACITY - 1) > 0.0f);
+    }
+
+    SECTION("Deferred players keep their baseline values and everyone is sent eventually")
+    {
+        SnapshotState baseline;
+        FillCrowd(baseline, 10, MAX_PLAYER_CAPACITY, 20.0f);
+
+        int sent[MAX_PLAYER_CAPACITY] = {};
+        for (uint32_t tick = 13; tick < 13 + 3 * 40; tick += 3)
+        {
+            SnapshotState state;
+            FillCrowd(state, tick, MAX_PLAYER_CAPACITY, 20.0f);
+            accumulator.Apply(0, state, &baseline, true, BUDGET, ELAPSED);
+
+            REQUIRE(state.players.Count() == MAX_PLAYER_CAPACITY);
+            REQUIRE(SnapshotBytes(factory, state, &baseline) <= BUDGET);
+            for (int slot = 0; slot < state.players.Count(); ++slot)
+            {
+                int old = baseline.players.Find(state.players.ids[slot]);
+                if (GetPlayerChanges(state.players, slot, baseline.players, old) != 0)
+                    sent[state.players.ids[slot]]++;
+            }
+        }
+
+        for (int count : sent)
+            REQUIRE(count > 0);
+        // Nearby players are refreshed more often than distant ones
+        REQUIRE(sent[1] > sent[MAX_PLAYER_CAPACITY - 1]);
+    }
+
+    SECTION("Everything fits under a generous budget")
+    {
+        SnapshotState state;
+        FillCrowd(state, 10, 8, 20.0f);
+        REQUIRE(accumulator.Apply(0, state, nullptr, true, 64 * 1024, ELAPSED) == 0);
+        REQUIRE(state.players.Count() == 8);
+    }
+
+    SECTION("Reset clears what a reused client slot accrued")
+    {
+        SnapshotState state;
+        FillCrowd(state, 10, MAX_PLAYER_CAPACITY, 20.0f);
+        accumulator.Apply(0, state, nullptr, true, BUDGET, ELAPSED);
+        REQUIRE(accumulator.GetPriority(0, MAX_PLAYER_CAPACITY - 1) > 0.0f);
+
+        accumulator.Reset(0);
+        REQUIRE(accumulator.GetPriority(0, MAX_PLAYER_CAPACITY - 1) == 0.0f);
+    }
+}
@@ -0,0 +1,504 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../common/snapshot.hpp"
+#include <yojimbo.h>
+#include <limits>
+
+// Writes a message into a bit stream and reads it back into another instance
+static bool RoundTrip(yojimbo::Message& in, yojimbo::Message& out)
+{
+    static uint8_t buffer[64 * 1024];
+    yojimbo::WriteStream writeStream(buffer, sizeof(buffer));
+    if (!in.SerializeInternal(writeStream))
+        return false;
+    writeStream.Flush();
+
+    yojimbo::ReadStream readStream(buffer, writeStream.GetBytesProcessed());
+    return out.SerializeInternal(readStream);
+}
+
+static int SerializedBytes(yojimbo::Message& message)
+{
+    static uint8_t buffer[64 * 1024];
+    yojimbo::WriteStream writeStream(buffer, sizeof(buffer));
+    REQUIRE(message.SerializeInternal(writeStream));
+    writeStream.Flush();
+    return writeStream.GetBytesProcessed();
+}
+
+template <typename T>
+static T* CreateMessage(GameMessageFactory& factory, GameMessageType type)
+{
+    T* message = static_cast<T*>(factory.CreateMessage((int)type));
+    REQUIRE(message != nullptr);
+    return message;
+}
+
+static void FillPlayers(WorldStateMessage& message, int count)
+{
+    REQUIRE(message.AllocatePlayers(count));
+    for (int i = 0; i < count; ++i)
+    {
+        message.playerIds[i] = i;
+        message.playerX[i] = 10.0f * i;
+        message.playerY[i] = 5.0f * i;
+        message.playerVelX[i] = -200.0f;
+        message.playerVelY[i] = 200.0f;
+        message.playerSize[i] = 10.0f + i;
+        message.playerColor[i] = 0x11223300 | i;
+    }
+}
+
+static void FillSnapshot(SnapshotState& state, uint32_t tick, int numPlayers)
+{
+    state.serverTick = tick;
+    state.timestamp = tick / 60.0;
+    state.players.Clear();
+    for (int i = 0; i < numPlayers; ++i)
+    {
+        int slot = state.players.Add(i);
+        state.players.x[slot] = 100.0f * i;
+        state.players.y[slot] = 50.0f * i;
+        state.players.velX[slot] = 200.0f;
+        state.players.velY[slot] = 0.0f;
+        state.players.size[slot] = 10.0f;
+        state.players.color[slot] = 0xFF0000FF;
+    }
+
+}
+
+static void RequireSameSnapshot(const SnapshotState& a, const SnapshotState& b)
+{
+    REQUIRE(a.serverTick == b.serverTick);
+    REQUIRE(a.players.Count() == b.players.Count());
+    for (int slot = 0; slot < a.players.Count(); ++slot)
+    {
+        int other = b.players.Find(a.players.ids[slot]);
+        REQUIRE(other >= 0);
+        REQUIRE(a.players.x[slot] == b.players.x[other]);
+        REQUIRE(a.players.y[slot] == b.players.y[other]);
+        REQUIRE(a.players.velX[slot] == b.players.velX[other]);
+        REQUIRE(a.players.size[slot] == b.players.size[other]);
+        REQUIRE(a.players.color[slot] == b.players.color[other]);
+    }
+}
+
+// Server-side encode, wire round trip, client-side decode
+static bool SendSnapshot(GameMessageFactory& factory, const SnapshotState& current, const SnapshotState* serverBaseline,
+                         const SnapshotState* clientBaseline, SnapshotState& decoded, int* bytes = nullptr,
+                         bool quantized = false)
+{
+    WorldStateMessage* in = CreateMessage<WorldStateMessage>(factory, GameMessageType::WORLD_STATE);
+    WorldStateMessage* out = CreateMessage<WorldStateMessage>(factory, GameMessageType::WORLD_STATE);
+    REQUIRE(in->AllocatePlayers(current.players.Count()));
+    WriteSnapshot(*in, current, serverBaseline);
+    in->quantized = quantized;
+    if (bytes)
+        *bytes = SerializedBytes(*in);
+
+    REQUIRE(RoundTrip(*in, *out));
+    bool ok = ReadSnapshot(*out, clientBaseline, decoded);
+
+    factory.ReleaseMessage(in);
+    factory.ReleaseMessage(out);
+    return ok;
+}
+
+TEST_CASE("Message serialization tests", "[serialization]")
+{
+    yojimbo::DefaultAllocator allocator;
+    GameMessageFactory factory(allocator);
+
+    SECTION("WorldStateMessage round trips a variable player section")
+    {
+        const int counts[] = {0, 1, DEFAULT_MAX_PLAYERS, MAX_PLAYER_CAPACITY};
+
+        for (int count : counts)
+        {
+            WorldStateMessage* in = CreateMessage<WorldStateMessage>(factory, GameMessageType::WORLD_STATE);
+            WorldStateMessage* out = CreateMessage<WorldStateMessage>(factory, GameMessageType::WORLD_STATE);
+            in->serverTick = 42;
+            in->lastProcessedInputSeq = 7;
+            FillPlayers(*in, count);
+
+            REQUIRE(RoundTrip(*in, *out));
+            REQUIRE(out->serverTick == 42);
+            REQUIRE(out->lastProcessedInputSeq == 7);
+            REQUIRE(out->numPlayers == count);
+            for (int i = 0; i < count; ++i)
+            {
+                REQUIRE(out->playerIds[i] == in->playerIds[i]);
+                REQUIRE(out->playerX[i] == in->playerX[i]);
+                REQUIRE(out->playerY[i] == in->playerY[i]);
+                REQUIRE(out->playerVelX[i] == in->playerVelX[i]);
+                REQUIRE(out->playerVelY[i] == in->playerVelY[i]);
+                REQUIRE(out->playerSize[i] == in->playerSize[i]);
+                REQUIRE(out->playerColor[i] == in->playerColor[i]);
+            }
+
+            factory.ReleaseMessage(in);
+            factory.ReleaseMessage(out);
+        }
+    }
+
+    SECTION("Reallocating the player section replaces the previous block")
+    {
+        WorldStateMessage* message = CreateMessage<WorldStateMessage>(factory, GameMessageType::WORLD_STATE);
+        FillPlayers(*message, 4);
+        FillPlayers(*message, 2);
+
+        REQUIRE(message->numPlayers == 2);
+        REQUIRE(message->playerColor[1] == (0x11223300 | 1));
+
+        factory.ReleaseMessage(message);
+    }
+
+    SECTION("Packet size grows with player capacity")
+    {
+        GameConnectionConfig small(DEFAULT_MAX_PLAYERS);
+        GameConnectionConfig large(MAX_PLAYER_CAPACITY);
+
+        REQUIRE(small.maxPacketSize >= EstimateWorldStateBytes(DEFAULT_MAX_PLAYERS));
+        REQUIRE(large.maxPacketSize >= EstimateWorldStateBytes(MAX_PLAYER_CAPACITY));
+        REQUIRE(large.serverPerClientMemory >= small.serverPerClientMemory);
+    }
+
+    SECTION("Delta snapshots rebuild the current state from the baseline")
+    {
+        SnapshotState baseline;
+        SnapshotState current;
+        FillSnapshot(baseline, 10, 8);
+        FillSnapshot(current, 12, 8);
+
+        // Two players moved, one grew
+        current.players.x[1] += 3.3f;
+        current.players.y[4] -= 1.0f;
+        current.players.size[2] += 0.3f;
+
+        SnapshotState full;
+        SnapshotState delta;
+        int fullBytes = 0;
+        int deltaBytes = 0;
+        REQUIRE(SendSnapshot(factory, current, nullptr, nullptr, full, &fullBytes));
+        REQUIRE(SendSnapshot(factory, current, &baseline, &baseline, delta, &deltaBytes));
+
+        RequireSameSnapshot(current, full);
+        RequireSameSnapshot(current, delta);
+        REQUIRE(deltaBytes * 4 < fullBytes);
+    }
+
+    SECTION("Players missing from the baseline are sent in full, removed ones drop out")
+    {
+        SnapshotState baseline;
+        SnapshotState current;
+        FillSnapshot(baseline, 20, 3);
+        FillSnapshot(current, 21, 3);
+        current.players.Remove(0);
+        int slot = current.players.Add(7);
+        current.players.x[slot] = 1.0f;
+        current.players.y[slot] = 2.0f;
+        current.players.size[slot] = 10.0f;
+        current.players.color[slot] = 0x00FF00FF;
+
+        SnapshotState decoded;
+        REQUIRE(SendSnapshot(factory, current, &baseline, &baseline, decoded));
+        RequireSameSnapshot(current, decoded);
+        REQUIRE(decoded.players.Find(0) == -1);
+    }
+
+    SECTION("Food sync and events rebuild the server's food table")
+    {
+        FoodSyncMessage* sync = CreateMessage<FoodSyncMessage>(factory, GameMessageType::FOOD_SYNC);
+        FoodSyncMessage* syncOut = CreateMessage<FoodSyncMessage>(factory, GameMessageType::FOOD_SYNC);
+        sync->numFoodItems = MAX_FOOD;
+        for (int i = 0; i < MAX_FOOD; ++i)
+        {
+            sync->foodX[i] = static_cast<float>(i * 25);
+            sync->foodY[i] = static_cast<float>(WORLD_HEIGHT - i);
+            sync->foodTier[i] = static_cast<uint8_t>(i % 3);
+        }
+        REQUIRE(RoundTrip(*sync, *syncOut));
+        REQUIRE(SerializedBytes(*sync) < MAX_FOOD * 5);
+
+        FoodTable table;
+        for (int i = 0; i < syncOut->numFoodItems; ++i)
+        {
+            table.Spawn(i, CreateFoodItemFromTier(syncOut->foodX[i], syncOut->foodY[i],
+                                                  static_cast<FoodTier>(syncOut->foodTier[i])));
+        }
+        REQUIRE(table.Has(MAX_FOOD - 1));
+        REQUIRE(table.items[77].position.x == 77 * 25.0f);
+        REQUIRE(table.items[77].position.y == static_cast<float>(WORLD_HEIGHT - 77));
+        REQUIRE(table.items[77].tier == FoodTier::LARGE);
+
+        FoodEatenMessage* eaten = CreateMessage<FoodEatenMessage>(factory, GameMessageType::FOOD_EATEN);
+        FoodEatenMessage* eatenOut = CreateMessage<FoodEatenMessage>(factory, GameMessageType::FOOD_EATEN);
+        eaten->foodId = 77;
+        eaten->playerId = MAX_PLAYER_CAPACITY - 1;
+        REQUIRE(RoundTrip(*eaten, *eatenOut));
+        REQUIRE(eatenOut->foodId == 77);
+        REQUIRE(eatenOut->playerId == static_cast<uint32_t>(MAX_PLAYER_CAPACITY - 1));
+        table.Remove(eatenOut->foodId);
+        REQUIRE_FALSE(table.Has(77));
+
+        FoodSpawnedMessage* spawned = CreateMessage<FoodSpawnedMessage>(factory, GameMessageType::FOOD_SPAWNED);
+        FoodSpawnedMessage* spawnedOut = CreateMessage<FoodSpawnedMessage>(factory, GameMessageType::FOOD_SPAWNED);
+        spawned->foodId = 77;
+        spawned->x = 3199.0f;
+        spawned->y = 0.0f;
+        spawned->tier = 1;
+        REQUIRE(RoundTrip(*spawned, *spawnedOut));
+        REQUIRE(SerializedBytes(*spawned) <= 6);
+        table.Spawn(spawnedOut->foodId, CreateFoodItemFromTier(spawnedOut->x, spawnedOut->y,
+                                                               static_cast<FoodTier>(spawnedOut->tier)));
+        REQUIRE(table.Has(77));
+        REQUIRE(table.items[77].position.x == 3199.0f);
+        REQUIRE(table.items[77].tier == FoodTier::MEDIUM);
+
+        factory.ReleaseMessage(sync);
+        factory.ReleaseMessage(syncOut);
+        factory.ReleaseMessage(eaten);
+        factory.ReleaseMessage(eatenOut);
+        factory.ReleaseMessage(spawned);
+        factory.ReleaseMessage(spawnedOut);
+    }
+
+    SECTION("A shared snapshot body decodes with each client's header")
+    {
+        SnapshotState current;
+        FillSnapshot(current, 60, 12);
+
+        WorldStateMessage* body = CreateMessage<WorldStateMessage>(factory, GameMessageType::WORLD_STATE);
+        REQUIRE(body->AllocatePlayers(current.players.Count()));
+        WriteSnapshot(*body, current, nullptr);
+
+        static uint8_t buffer[4096];
+        int bytes = WriteMessageBytes(*body, buffer, sizeof(buffer));
+        REQUIRE(bytes > 0);
+        REQUIRE(bytes % 4 == 0);
+
+        // Two clients get the same bytes and their own input ack
+        for (uint32_t ack : {7u, 1234u})
+        {
+            SharedSnapshotMessage* header = CreateMessage<SharedSnapshotMessage>(factory, GameMessageType::SHARED_SNAPSHOT);
+            uint8_t* block = (uint8_t*)YOJIMBO_ALLOCATE(allocator, bytes);
+            memcpy(block, buffer, bytes);
+            header->AttachBlock(allocator, block, bytes);
+            header->serverTick = 60;
+            header->lastProcessedInputSeq = ack;
+
+            WorldStateMessage* decodedBody = CreateMessage<WorldStateMessage>(factory, GameMessageType::WORLD_STATE);
+            REQUIRE(ReadSharedSnapshot(*header, *decodedBody));
+            REQUIRE(decodedBody->lastProcessedInputSeq == ack);
+
+            SnapshotState decoded;
+            REQUIRE(ReadSnapshot(*decodedBody, nullptr, decoded));
+            RequireSameSnapshot(current, decoded);
+
+            // A header for another tick must not pick up this body
+            header->serverTick = 61;
+            REQUIRE_FALSE(ReadSharedSnapshot(*header, *decodedBody));
+
+            factory.ReleaseMessage(header);
+            factory.ReleaseMessage(decodedBody);
+        }
+        factory.ReleaseMessage(body);
+    }
+
+    SECTION("Input batches carry the newest inputs with delta-coded sequences")
+    {
+        eastl::deque<StoredInput> history;
+        for (uint32_t sequence = 100; sequence < 120; ++sequence)
+        {
+            float moveX = MOVE_AXIS_QUANTIZATION.Snap(static_cast<float>(std::cos(sequence * 0.1)));
+            float moveY = MOVE_AXIS_QUANTIZATION.Snap(static_cast<float>(std::sin(sequence * 0.1)));
+            history.push_back(StoredInput(sequence, sequence / 60.0, moveX, moveY));
+        }
+
+        PlayerInputBatchMessage* in = CreateMessage<PlayerInputBatchMessage>(factory, GameMessageType::PLAYER_INPUT_BATCH);
+        PlayerInputBatchMessage* out = CreateMessage<PlayerInputBatchMessage>(factory, GameMessageType::PLAYER_INPUT_BATCH);
+        FillInputBatch(*in, history, DEFAULT_INPUT_BATCH);
+        REQUIRE(in->numInputs == DEFAULT_INPUT_BATCH);
+        REQUIRE(in->sequence[0] == 120 - DEFAULT_INPUT_BATCH);
+
+        REQUIRE(RoundTrip(*in, *out));
+        REQUIRE(out->numInputs == in->numInputs);
+        for (int i = 0; i < in->numInputs; ++i)
+        {
+            REQUIRE(out->sequence[i] == in->sequence[i]);
+            REQUIRE(out->moveX[i] == in->moveX[i]);
+            REQUIRE(out->moveY[i] == in->moveY[i]);
+        }
+
+        // Eight inputs cost less than two single input messages
+        PlayerInputMessage* single = CreateMessage<PlayerInputMessage>(factory, GameMessageType::PLAYER_INPUT);
+        REQUIRE(SerializedBytes(*in) < 2 * SerializedBytes(*single));
+
+        // A short history sends what there is
+        history.erase(history.begin(), history.end() - 3);
+        FillInputBatch(*in, history, DEFAULT_INPUT_BATCH);
+        REQUIRE(in->numInputs == 3);
+        REQUIRE(in->sequence[2] == 119);
+
+        factory.ReleaseMessage(in);
+        factory.ReleaseMessage(out);
+        factory.ReleaseMessage(single);
+    }
+
+    SECTION("A delta cannot be decoded without its baseline")
+    {
+        SnapshotState baseline;
+        SnapshotState current;
+        FillSnapshot(baseline, 30, 2);
+        FillSnapshot(current, 31, 2);
+
+        SnapshotState decoded;
+        REQUIRE_FALSE(SendSnapshot(factory, current, &baseline, nullptr, decoded));
+    }
+
+    SECTION("Snapshot history only finds ticks still in the ring")
+    {
+        SnapshotHistory history;
+        history.Insert(5).timestamp = 1.0;
+        REQUIRE(history.Find(5) != nullptr);
+        REQUIRE(history.Find(6) == nullptr);
+
+        history.Insert(5 + SNAPSHOT_HISTORY_SIZE);
+        REQUIRE(history.Find(5) == nullptr);
+        REQUIRE(history.Find(0) == nullptr);
+    }
+
+    SECTION("Staggered snapshot ticks give every client one snapshot per interval")
+    {
+        REQUIRE(GetSnapshotInterval(TICK_RATE) == 1);
+        REQUIRE(GetSnapshotInterval(0) == 1);
+        REQUIRE(GetSnapshotInterval(30) == 2);
+        REQUIRE(GetSnapshotInterval(20) == 3);
+
+        const int interval = GetSnapshotInterval(20);
+        const int numClients = 12;
+        int perClient[numClients] = {};
+        for (uint32_t tick = 1; tick <= 60; ++tick)
+        {
+            int sentThisTick = 0;
+            for (int clientIndex = 0; clientIndex < numClients; ++clientIndex)
+            {
+                if (IsSnapshotTick(tick, clientIndex, interval))
+                {
+                    perClient[clientIndex]++;
+                    sentThisTick++;
+                }
+            }
+            // The load is spread evenly instead of landing on one tick
+            REQUIRE(sentThisTick == numClients / interval);
+        }
+        for (int count : perClient)
+            REQUIRE(count == 20);
+    }
+
+    SECTION("The server clock estimate smooths jitter and resyncs after a jump")
+    {
+        ServerClock clock;
+        REQUIRE_FALSE(clock.IsSynced());
+
+        // The server runs 100 s ahead; samples arrive with +-10 ms of jitter
+        clock.AddSample(100.0, 0.0);
+        REQUIRE(clock.IsSynced());
+        for (int i = 1; i <= 100; ++i)
+        {
+            double jitter = (i % 2 == 0) ? 0.01 : -0.01;
+            clock.AddSample(100.0 + i * 0.05, i * 0.05 + jitter);
+        }
+        REQUIRE(clock.GetServerTime(10.0) == Approx(110.0).margin(0.01));
+
+        clock.AddSample(200.0, 10.0);
+        REQUIRE(clock.GetServerTime(10.0) == Approx(200.0));
+    }
+
+    SECTION("Quantization ranges fit their documented widths and snap idempotently")
+    {
+        REQUIRE(POSITION_X_QUANTIZATION.MaxIndex() < (1 << 15));
+        REQUIRE(POSITION_Y_QUANTIZATION.MaxIndex() < (1 << 15));
+        REQUIRE(VELOCITY_QUANTIZATION.MaxIndex() < (1 << 13));
+
+        const float values[] = {0.0f, 0.06f, 1234.5678f, 3199.99f, 5000.0f, -3.0f};
+        for (float value : values)
+        {
+            float snapped = POSITION_X_QUANTIZATION.Snap(value);
+            REQUIRE(POSITION_X_QUANTIZATION.Snap(snapped) == snapped);
+            REQUIRE(snapped >= 0.0f);
+            REQUIRE(snapped <= static_cast<float>(WORLD_WIDTH));
+        }
+        REQUIRE(POSITION_X_QUANTIZATION.Snap(1234.5678f) == Approx(1234.5678f).margin(1.0f / 16.0f));
+    }
+
+    SECTION("Non-finite values quantize to the ends of the range")
+    {
+        const float infinity = std::numeric_limits<float>::infinity();
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        REQUIRE(SIZE_QUANTIZATION.Quantize(nan) == 0);
+        REQUIRE(SIZE_QUANTIZATION.Quantize(infinity) == SIZE_QUANTIZATION.MaxIndex());
+        REQUIRE(SIZE_QUANTIZATION.Quantize(-infinity) == 0);
+        REQUIRE(VELOCITY_QUANTIZATION.Snap(nan) == VELOCITY_QUANTIZATION.min);
+        REQUIRE(SIZE_QUANTIZATION.Quantize(1e30f) == SIZE_QUANTIZATION.MaxIndex());
+    }
+
+    SECTION("Quantized snapshots of snapped state decode exactly and are smaller")
+    {
+        SnapshotState current;
+        FillSnapshot(current, 40, 16);
+        for (int slot = 0; slot < current.players.Count(); ++slot)
+        {
+            current.players.x[slot] = POSITION_X_QUANTIZATION.Snap(current.players.x[slot] + 0.3f);
+            current.players.size[slot] = SIZE_QUANTIZATION.Snap(10.3f);
+        }
+
+        SnapshotState raw;
+        SnapshotState quantized;
+        int rawBytes = 0;
+        int quantizedBytes = 0;
+        REQUIRE(SendSnapshot(factory, current, nullptr, nullptr, raw, &rawBytes, false));
+        REQUIRE(SendSnapshot(factory, current, nullptr, nullptr, quantized, &quantizedBytes, true));
+
+        RequireSameSnapshot(current, quantized);
+        REQUIRE(quantizedBytes < rawBytes * 2 / 3);
+    }
+
+    SECTION("Client prediction from a quantized snapshot matches the server")
+    {
+        const float moves[][2] = {{1, 0}, {1, 1}, {0, -1}, {-1, 1}, {0.3f, 0.7f}};
+
+        Player server;
+        server.position = Position(POSITION_X_QUANTIZATION.Snap(1000.0f), POSITION_Y_QUANTIZATION.Snap(800.0f));
+        for (const auto& move : moves)
+        {
+            StepPlayerMovement(server.position.x, server.position.y, server.velocity.x, server.velocity.y,
+                               move[0], move[1], INPUT_STEP_DT, true);
+        }
+
+        // The client only sees what the wire carries, then both apply the same inputs
+        SnapshotState state;
+        FillSnapshot(state, 50, 1);
+        state.players.x[0] = server.position.x;
+        state.players.y[0] = server.position.y;
+        state.players.velX[0] = server.velocity.x;
+        state.players.velY[0] = server.velocity.y;
+
+        SnapshotState decoded;
+        REQUIRE(SendSnapshot(factory, state, nullptr, nullptr, decoded, nullptr, true));
+        Player client = decoded.players.Get(0);
+
+        for (const auto& move : moves)
+        {
+            StepPlayerMovement(server.position.x, server.position.y, server.velocity.x, server.velocity.y,
+                               move[0], move[1], INPUT_STEP_DT, true);
+            StepPlayerMovement(client.position.x, client.position.y, client.velocity.x, client.velocity.y,
+                               move[0], move[1], INPUT_STEP_DT, true);
+        }
+
+        REQUIRE(client.position.x == server.position.x);
+        REQUIRE(client.position.y == server.position.y);
+        REQUIRE(client.velocity.x == server.velocity.x);
+        REQUIRE(client.velocity.y == server.velocity.y);
+    }
+}
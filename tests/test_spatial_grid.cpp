@@ -0,0 +1,101 @@
+#include "catch.hpp"
+#include "../common/protocol.hpp"
+#include "../server/spatial_grid.hpp"
+#include <algorithm>
+
+static bool QueryContains(const eastl::vector<uint32_t>& ids, uint32_t id)
+{
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+TEST_CASE("Spatial grid tests", "[spatial]")
+{
+    SpatialGrid grid(static_cast<float>(WORLD_WIDTH), static_cast<float>(WORLD_HEIGHT), SPATIAL_CELL_SIZE, MAX_FOOD);
+    eastl::vector<uint32_t> result;
+
+    SECTION("Grid covers the whole world")
+    {
+        REQUIRE(grid.GetColumns() * SPATIAL_CELL_SIZE >= WORLD_WIDTH);
+        REQUIRE(grid.GetRows() * SPATIAL_CELL_SIZE >= WORLD_HEIGHT);
+        REQUIRE(grid.GetItemCount() == 0);
+    }
+
+    SECTION("Query returns items in overlapping cells only")
+    {
+        grid.Insert(0, 150.0f, 150.0f);
+        grid.Insert(1, 3000.0f, 2000.0f);
+
+        grid.QueryRadius(160.0f, 140.0f, 20.0f, result);
+
+        REQUIRE(QueryContains(result, 0));
+        REQUIRE_FALSE(QueryContains(result, 1));
+    }
+
+    SECTION("Query spanning a cell border sees both sides")
+    {
+        grid.Insert(0, 99.0f, 50.0f);
+        grid.Insert(1, 101.0f, 50.0f);
+
+        grid.QueryRadius(100.0f, 50.0f, 5.0f, result);
+
+        REQUIRE(QueryContains(result, 0));
+        REQUIRE(QueryContains(result, 1));
+    }
+
+    SECTION("Move relocates an item incrementally")
+    {
+        grid.Insert(7, 50.0f, 50.0f);
+        grid.Move(7, 2500.0f, 1800.0f);
+
+        grid.QueryRadius(50.0f, 50.0f, 10.0f, result);
+        REQUIRE_FALSE(QueryContains(result, 7));
+
+        result.clear();
+        grid.QueryRadius(2500.0f, 1800.0f, 10.0f, result);
+        REQUIRE(QueryContains(result, 7));
+        REQUIRE(grid.GetItemCount() == 1);
+    }
+
+    SECTION("Remove keeps the remaining cell members queryable")
+    {
+        grid.Insert(0, 10.0f, 10.0f);
+        grid.Insert(1, 20.0f, 20.0f);
+        grid.Insert(2, 30.0f, 30.0f);
+
+        grid.Remove(0);
+
+        grid.QueryRadius(20.0f, 20.0f, 10.0f, result);
+        REQUIRE_FALSE(QueryContains(result, 0));
+        REQUIRE(QueryContains(result, 1));
+        REQUIRE(QueryContains(result, 2));
+        REQUIRE(grid.GetItemCount() == 2);
+    }
+
+    SECTION("Positions on or outside the world edge are clamped into border cells")
+    {
+        grid.Insert(0, static_cast<float>(WORLD_WIDTH), static_cast<float>(WORLD_HEIGHT));
+        grid.Insert(1, -5.0f, -5.0f);
+
+        grid.QueryRadius(static_cast<float>(WORLD_WIDTH), static_cast<float>(WORLD_HEIGHT), 1.0f, result);
+        REQUIRE(QueryContains(result, 0));
+
+        result.clear();
+        grid.QueryRadius(0.0f, 0.0f, 1.0f, result);
+        REQUIRE(QueryContains(result, 1));
+    }
+
+    SECTION("Clear empties every cell")
+    {
+        for (uint32_t i = 0; i < MAX_FOOD; ++i)
+        {
+            grid.Insert(i, static_cast<float>(i * 20 % WORLD_WIDTH), static_cast<float>(i * 15 % WORLD_HEIGHT));
+        }
+        REQUIRE(grid.GetItemCount() == MAX_FOOD);
+
+        grid.Clear();
+
+        grid.QueryRect(0.0f, 0.0f, static_cast<float>(WORLD_WIDTH), static_cast<float>(WORLD_HEIGHT), result);
+        REQUIRE(result.empty());
+        REQUIRE(grid.GetItemCount() == 0);
+    }
+}
@@ -0,0 +1,63 @@
+#include "catch.hpp"
+#include "../server/tick_profiler.hpp"
+#include <sstream>
+
+TEST_CASE("Tick profiler tests", "[profiler]")
+{
+    SECTION("Bucket bounds stay within the histogram precision")
+    {
+        const uint64_t values[] = {0, 1, 31, 32, 33, 1000, 16667, 1000000, 123456789};
+        for (uint64_t value : values)
+        {
+            uint64_t bound = LatencyHistogram::BucketUpperBound(LatencyHistogram::BucketOf(value));
+            REQUIRE(bound >= value);
+            REQUIRE(bound - value <= value / LatencyHistogram::SUB_BUCKETS);
+        }
+        REQUIRE(LatencyHistogram::BucketOf(uint64_t(1) << 62) == LatencyHistogram::BUCKET_COUNT - 1);
+    }
+
+    SECTION("Percentiles and max follow the recorded values")
+    {
+        LatencyHistogram histogram;
+        for (uint64_t value = 1; value <= 1000; ++value)
+        {
+            histogram.Record(value * 1000);
+        }
+
+        REQUIRE(histogram.GetCount() == 1000);
+        REQUIRE(histogram.GetMax() == 1000000);
+        REQUIRE(histogram.GetPercentile(50.0) == Approx(500000).epsilon(0.07));
+        REQUIRE(histogram.GetPercentile(99.0) == Approx(990000).epsilon(0.07));
+        REQUIRE(histogram.GetPercentile(100.0) == 1000000);
+
+        histogram.Reset();
+        REQUIRE(histogram.GetCount() == 0);
+        REQUIRE(histogram.GetPercentile(50.0) == 0);
+    }
+
+    SECTION("Profiler dumps on its interval and starts a new window")
+    {
+        TickProfiler profiler(1.0);
+        std::ostringstream out;
+
+        profiler.Update(0.0, out);
+        profiler.Record(TickPhase::TICK, 2000);
+        profiler.Record(TickPhase::HANDLE_GAME_FOOD, 500);
+
+        profiler.Update(0.5, out);
+        REQUIRE(out.str().empty());
+
+        profiler.Update(1.0, out);
+        REQUIRE(out.str().find("HandleGameFood") != std::string::npos);
+        REQUIRE(profiler.GetHistogram(TickPhase::TICK).GetCount() == 0);
+    }
+
+    SECTION("A profile scope records into its phase")
+    {
+        TickProfiler profiler;
+        {
+            ProfileScope scope(profiler, TickPhase::SEND_PACKETS);
+        }
+        REQUIRE(profiler.GetHistogram(TickPhase::SEND_PACKETS).GetCount() == 1);
+    }
+}